@@ -0,0 +1,50 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Runs the benchmarks with the ER event collection enabled, if the first
+// script argument is "enabled". The instrumentation itself is controlled
+// by the --instrument and --instrument-lazily flags, see er-overhead.json
+// and tools/er-overhead.py.
+
+var er_enabled = typeof arguments !== 'undefined' && arguments[0] === 'enabled';
+if (er_enabled) ER_enable();
+
+load('base.js');
+load('richards.js');
+load('deltablue.js');
+load('crypto.js');
+load('raytrace.js');
+load('earley-boyer.js');
+load('regexp.js');
+load('splay.js');
+load('navier-stokes.js');
+
+var success = true;
+var start = Date.now();
+
+function PrintResult(name, result) {
+  print(name + ': ' + result);
+}
+
+
+function PrintError(name, error) {
+  PrintResult(name, error);
+  success = false;
+}
+
+
+function PrintScore(score) {
+  if (success) {
+    print('----');
+    print('Score (version ' + BenchmarkSuite.version + '): ' + score);
+    print('Elapsed (ms): ' + (Date.now() - start));
+  }
+}
+
+
+BenchmarkSuite.RunSuites({ NotifyResult: PrintResult,
+                           NotifyError: PrintError,
+                           NotifyScore: PrintScore });
+
+if (er_enabled) ER_disable();
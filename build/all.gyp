@@ -10,6 +10,7 @@
       'dependencies': [
         '../samples/samples.gyp:*',
         '../src/d8.gyp:d8',
+        '../src/d8.gyp:er_analyze',
         '../test/cctest/cctest.gyp:*',
         '../test/unittests/unittests.gyp:*',
       ],
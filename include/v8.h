@@ -4289,6 +4289,31 @@ typedef void (*MessageCallback)(Handle<Message> message, Handle<Value> error);
 
 typedef void (*LogEventCallback)(const char* name, int event);
 
+/**
+ * A data race, found by the EventRacer race detector: two accesses to the
+ * same location from event actions, which are not ordered by
+ * happens-before, at least one of which is a write.
+ */
+struct EventRacerRace {
+  enum AccessType { kRead, kWrite };
+
+  // The event action of the earlier access and the access type.
+  int first_event;
+  AccessType first_access;
+  // The event action of the current access and the access type.
+  int second_event;
+  AccessType second_access;
+  // Identifier of the accessed object, zero for variables.
+  int object_id;
+  // Name of the accessed property or variable, empty for the accesses of
+  // a whole array, e.g. by the array builtins. Valid only during the
+  // callback.
+  const char* name;
+};
+
+typedef void (*EventRacerRaceCallback)(Isolate* isolate,
+                                       const EventRacerRace* race);
+
 /**
  * Create new error objects by calling the corresponding error object
  * constructor with the message.
@@ -5007,6 +5032,29 @@ class V8_EXPORT Isolate {
    */
   void SetEventLogger(LogEventCallback that);
 
+  /**
+   * Starts the EventRacer happens-before race detection and sets the
+   * callback, which receives the races as they are found. The accesses are
+   * checked while the EventRacer log is enabled, see ER_enable(). The
+   * happens-before order is declared with the functions below.
+   */
+  void SetEventRacerRaceCallback(EventRacerRaceCallback callback);
+
+  /**
+   * Marks the start and the end of the event action |event_id|, e.g. the
+   * run of an event handler. Event identifiers are non-negative. The
+   * accesses outside of event actions are not checked for races. Repeated
+   * reads are recorded once per event action, see --er-dedup-reads.
+   */
+  void EventRacerBeginEvent(int event_id);
+  void EventRacerEndEvent();
+
+  /**
+   * Orders the event action |from_event| before the event action
+   * |to_event|, which has not begun yet.
+   */
+  void EventRacerAddArc(int from_event, int to_event);
+
   /**
    * Adds a callback to notify the host application when a script finished
    * running.  If a script re-enters the runtime during executing, the
@@ -5932,6 +5980,16 @@ class V8_EXPORT Context {
    */
   void SetErrorMessageForCodeGenerationFromStrings(Handle<String> message);
 
+  /**
+   * Restricts the EventRacer instrumentation of the code, compiled in this
+   * context, to the scripts and the functions, whose names pass the given
+   * filters. The filters have the syntax of the --er-script-filter and
+   * --er-function-filter flags, which apply to the contexts, where no
+   * filter is set. Affects only the code compiled afterwards.
+   */
+  void SetEventRacerFilter(Handle<String> script_filter,
+                           Handle<String> function_filter);
+
   /**
    * Stack-allocated class which sets the execution context for all
    * operations executed within a local scope.
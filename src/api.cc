@@ -26,6 +26,7 @@
 #include "src/cpu-profiler.h"
 #include "src/debug.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/execution.h"
 #include "src/global-handles.h"
 #include "src/heap-profiler.h"
@@ -5187,6 +5188,18 @@ void Context::SetErrorMessageForCodeGenerationFromStrings(
 }
 
 
+void Context::SetEventRacerFilter(Handle<String> script_filter,
+                                  Handle<String> function_filter) {
+  i::Handle<i::Context> context = Utils::OpenHandle(this);
+  i::Isolate* isolate = context->GetIsolate();
+  ENTER_V8(isolate);
+  i::Handle<i::FixedArray> filter = isolate->factory()->NewFixedArray(2);
+  filter->set(0, *Utils::OpenHandle(*script_filter));
+  filter->set(1, *Utils::OpenHandle(*function_filter));
+  context->set_event_racer_filter(*filter);
+}
+
+
 Local<v8::Object> ObjectTemplate::NewInstance() {
   i::Handle<i::ObjectTemplateInfo> info = Utils::OpenHandle(this);
   i::Isolate* isolate = info->GetIsolate();
@@ -6596,6 +6609,30 @@ int Isolate::ContextDisposedNotification(bool dependant_context) {
 }
 
 
+void Isolate::SetEventRacerRaceCallback(EventRacerRaceCallback callback) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->event_racer_log()->SetRaceCallback(callback);
+}
+
+
+void Isolate::EventRacerBeginEvent(int event_id) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->event_racer_log()->BeginEvent(event_id);
+}
+
+
+void Isolate::EventRacerEndEvent() {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->event_racer_log()->EndEvent();
+}
+
+
+void Isolate::EventRacerAddArc(int from_event, int to_event) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->event_racer_log()->AddArc(from_event, to_event);
+}
+
+
 void Isolate::SetJitCodeEventHandler(JitCodeEventOptions options,
                                      JitCodeEventHandler event_handler) {
   i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
@@ -46,6 +46,7 @@
 #include "src/cpu-profiler.h"
 #include "src/debug.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/execution.h"
 #include "src/ic/ic.h"
 #include "src/ic/stub-cache.h"
@@ -1265,6 +1266,13 @@ ExternalReference ExternalReference::is_profiling_address(Isolate* isolate) {
 }
 
 
+ExternalReference ExternalReference::event_racer_log_enable_count_address(
+    Isolate* isolate) {
+  return ExternalReference(
+      isolate->event_racer_log()->enable_count_address());
+}
+
+
 ExternalReference ExternalReference::invoke_function_callback(
     Isolate* isolate) {
   Address thunk_address = FUNCTION_ADDR(&InvokeFunctionCallback);
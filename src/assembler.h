@@ -946,6 +946,8 @@ class ExternalReference BASE_EMBEDDED {
       Isolate* isolate);
 
   static ExternalReference is_profiling_address(Isolate* isolate);
+  static ExternalReference event_racer_log_enable_count_address(
+      Isolate* isolate);
   static ExternalReference invoke_function_callback(Isolate* isolate);
   static ExternalReference invoke_accessor_getter_callback(Isolate* isolate);
 
@@ -15,9 +15,11 @@ namespace internal {
 
 class AstNumberingVisitor FINAL : public AstVisitor {
  public:
-  explicit AstNumberingVisitor(Zone* zone)
+  AstNumberingVisitor(Zone* zone, bool renumber_literals)
       : AstVisitor(),
         next_id_(BailoutId::FirstUsable().ToInt()),
+        renumber_literals_(renumber_literals),
+        next_literal_index_(JSFunction::kLiteralsPrefixSize),
         dont_crankshaft_reason_(kNoReason),
         dont_turbofan_reason_(kNoReason) {
     InitializeAstVisitor(zone);
@@ -44,6 +46,13 @@ class AstNumberingVisitor FINAL : public AstVisitor {
     return tmp;
   }
 
+  // The ER rewriter moves literals into newly created functions, so the
+  // parser assigned literal indices of instrumented functions are not
+  // dense. Reassign them in visitation order.
+  void RenumberLiteral(MaterializedLiteral* node) {
+    if (renumber_literals_) node->set_literal_index(next_literal_index_++);
+  }
+
   void IncrementNodeCount() { properties_.add_node_count(1); }
   void DisableCrankshaft(BailoutReason reason) {
     dont_crankshaft_reason_ = reason;
@@ -92,6 +101,8 @@ class AstNumberingVisitor FINAL : public AstVisitor {
   }
 
   int next_id_;
+  bool renumber_literals_;
+  int next_literal_index_;
   AstProperties properties_;
   BailoutReason dont_crankshaft_reason_;
   BailoutReason dont_turbofan_reason_;
@@ -158,6 +169,7 @@ void AstNumberingVisitor::VisitLiteral(Literal* node) {
 
 void AstNumberingVisitor::VisitRegExpLiteral(RegExpLiteral* node) {
   IncrementNodeCount();
+  RenumberLiteral(node);
   node->set_base_id(ReserveIdRange(RegExpLiteral::num_ids()));
 }
 
@@ -467,6 +479,7 @@ void AstNumberingVisitor::VisitClassLiteral(ClassLiteral* node) {
 
 void AstNumberingVisitor::VisitObjectLiteral(ObjectLiteral* node) {
   IncrementNodeCount();
+  RenumberLiteral(node);
   node->set_base_id(ReserveIdRange(ObjectLiteral::num_ids()));
   for (int i = 0; i < node->properties()->length(); i++) {
     VisitObjectLiteralProperty(node->properties()->at(i));
@@ -483,6 +496,7 @@ void AstNumberingVisitor::VisitObjectLiteralProperty(
 
 void AstNumberingVisitor::VisitArrayLiteral(ArrayLiteral* node) {
   IncrementNodeCount();
+  RenumberLiteral(node);
   node->set_base_id(ReserveIdRange(node->num_ids()));
   for (int i = 0; i < node->values()->length(); i++) {
     Visit(node->values()->at(i));
@@ -542,6 +556,10 @@ void AstNumberingVisitor::VisitFunctionLiteral(FunctionLiteral* node) {
 bool AstNumberingVisitor::Finish(FunctionLiteral* node) {
   node->set_ast_properties(&properties_);
   node->set_dont_optimize_reason(dont_optimize_reason());
+  if (renumber_literals_) {
+    node->set_materialized_literal_count(next_literal_index_ -
+                                         JSFunction::kLiteralsPrefixSize);
+  }
   return !HasStackOverflow();
 }
 
@@ -570,8 +588,9 @@ bool AstNumberingVisitor::Renumber(FunctionLiteral* node) {
 }
 
 
-bool AstNumbering::Renumber(FunctionLiteral* function, Zone* zone) {
-  AstNumberingVisitor visitor(zone);
+bool AstNumbering::Renumber(FunctionLiteral* function, Zone* zone,
+                            bool renumber_literals) {
+  AstNumberingVisitor visitor(zone, renumber_literals);
   return visitor.Renumber(function);
 }
 }
@@ -9,9 +9,12 @@ namespace v8 {
 namespace internal {
 
 namespace AstNumbering {
-// Assign type feedback IDs and bailout IDs to an AST node tree.
+// Assign type feedback IDs and bailout IDs to an AST node tree. With
+// |renumber_literals|, also assign dense materialized literal indices and
+// update the literal count of |function|.
 //
-bool Renumber(FunctionLiteral* function, Zone* zone);
+bool Renumber(FunctionLiteral* function, Zone* zone,
+              bool renumber_literals = false);
 }
 }
 }  // namespace v8::internal
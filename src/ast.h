@@ -311,9 +311,7 @@ class AstNode: public ZoneObject {
   }
 
   static int GetNextFnId(Zone* zone) {
-    int tmp = zone->isolate()->function_id();
-    zone->isolate()->set_function_id(tmp + 1);
-    return tmp;
+    return zone->isolate()->NextFunctionId();
   }
 
  private:
@@ -3310,20 +3308,30 @@ class AstVisitor BASE_EMBEDDED {
                                                             \
   bool CheckStackOverflow() {                               \
     if (stack_overflow_) return true;                       \
+    if (stack_limit_ != 0) {                                \
+      if (GetCurrentStackPosition() >= stack_limit_)        \
+        return false;                                       \
+      return (stack_overflow_ = true);                      \
+    }                                                       \
     StackLimitCheck check(zone_->isolate());                \
     if (!check.HasOverflowed()) return false;               \
     return (stack_overflow_ = true);                        \
   }                                                         \
                                                             \
  private:                                                   \
-  void InitializeAstVisitor(Zone* zone) {                   \
+  /* A non-zero |stack_limit| is checked instead of the */  \
+  /* isolate's one, off the main thread. */                 \
+  void InitializeAstVisitor(Zone* zone,                     \
+                            uintptr_t stack_limit = 0) {    \
     zone_ = zone;                                           \
+    stack_limit_ = stack_limit;                             \
     stack_overflow_ = false;                                \
   }                                                         \
   Zone* zone() { return zone_; }                            \
   Isolate* isolate() { return zone_->isolate(); }           \
                                                             \
   Zone* zone_;                                              \
+  uintptr_t stack_limit_;                                   \
   bool stack_overflow_
 
 
@@ -3398,20 +3406,29 @@ class AstRewriter BASE_EMBEDDED {
 
   bool CheckStackOverflow() {
     if (stack_overflow_) return true;
+    if (stack_limit_ != 0) {
+      if (GetCurrentStackPosition() >= stack_limit_) return false;
+      return (stack_overflow_ = true);
+    }
     StackLimitCheck check(zone_->isolate());
     if (!check.HasOverflowed()) return false;
     return (stack_overflow_ = true);
   }
 
 protected:
-  void InitializeAstRewriter(Zone* zone) {
+  // A non-zero |stack_limit| is checked instead of the isolate's one, off
+  // the main thread.
+  void InitializeAstRewriter(Zone* zone, uintptr_t stack_limit = 0) {
     zone_ = zone;
+    stack_limit_ = stack_limit;
     stack_overflow_ = false;
   }
   Zone* zone() const { return zone_; }
   Isolate* isolate() const { return zone_->isolate(); }
+  uintptr_t stack_limit() const { return stack_limit_; }
 
   Zone* zone_;
+  uintptr_t stack_limit_;
   bool stack_overflow_;
 };
 
@@ -26,6 +26,7 @@ BackgroundParsingTask::BackgroundParsingTask(
   source->allow_lazy =
       !i::Compiler::DebuggerWantsEagerCompilation(source->info.get());
   source->hash_seed = isolate->heap()->HashSeed();
+  source->instrument = i::Compiler::ShouldInstrumentStreamedScript(isolate);
 }
 
 
@@ -49,6 +50,9 @@ void BackgroundParsingTask::Run() {
   source_->parser.Reset(new Parser(source_->info.get(), &parse_info));
   source_->parser->set_allow_lazy(source_->allow_lazy);
   source_->parser->ParseOnBackground();
+  // The AST rewrites, including the ER instrumentation, do not need the
+  // heap, so they run here too, off the main thread.
+  source_->parser->AnalyzeOnBackground(source_->instrument);
 
   if (script_data != NULL) {
     source_->cached_data.Reset(new ScriptCompiler::CachedData(
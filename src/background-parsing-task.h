@@ -25,7 +25,8 @@ struct StreamedSource {
       : source_stream(source_stream),
         encoding(encoding),
         hash_seed(0),
-        allow_lazy(false) {}
+        allow_lazy(false),
+        instrument(false) {}
 
   // Internal implementation of v8::ScriptCompiler::StreamedSource.
   SmartPointer<ScriptCompiler::ExternalSourceStream> source_stream;
@@ -39,6 +40,9 @@ struct StreamedSource {
   SmartPointer<CompilationInfo> info;
   uint32_t hash_seed;
   bool allow_lazy;
+  // Whether the ER instrumentation is added in the background, see
+  // Compiler::ShouldInstrumentStreamedScript.
+  bool instrument;
   SmartPointer<Parser> parser;
 
  private:
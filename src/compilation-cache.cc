@@ -6,6 +6,7 @@
 
 #include "src/assembler.h"
 #include "src/compilation-cache.h"
+#include "src/event-racer-log.h"
 #include "src/serialize.h"
 
 namespace v8 {
@@ -147,7 +148,8 @@ Handle<SharedFunctionInfo> CompilationCacheScript::Lookup(
     int line_offset,
     int column_offset,
     bool is_shared_cross_origin,
-    Handle<Context> context) {
+    Handle<Context> context,
+    bool instrumented) {
   Object* result = NULL;
   int generation;
 
@@ -156,7 +158,7 @@ Handle<SharedFunctionInfo> CompilationCacheScript::Lookup(
   { HandleScope scope(isolate());
     for (generation = 0; generation < generations(); generation++) {
       Handle<CompilationCacheTable> table = GetTable(generation);
-      Handle<Object> probe = table->Lookup(source, context);
+      Handle<Object> probe = table->Lookup(source, context, instrumented);
       if (probe->IsSharedFunctionInfo()) {
         Handle<SharedFunctionInfo> function_info =
             Handle<SharedFunctionInfo>::cast(probe);
@@ -187,7 +189,7 @@ Handle<SharedFunctionInfo> CompilationCacheScript::Lookup(
                      is_shared_cross_origin));
     // If the script was found in a later generation, we promote it to
     // the first generation to let it survive longer in the cache.
-    if (generation != 0) Put(source, context, shared);
+    if (generation != 0) Put(source, context, shared, instrumented);
     isolate()->counters()->compilation_cache_hits()->Increment();
     return shared;
   } else {
@@ -199,17 +201,18 @@ Handle<SharedFunctionInfo> CompilationCacheScript::Lookup(
 
 void CompilationCacheScript::Put(Handle<String> source,
                                  Handle<Context> context,
-                                 Handle<SharedFunctionInfo> function_info) {
+                                 Handle<SharedFunctionInfo> function_info,
+                                 bool instrumented) {
   HandleScope scope(isolate());
   Handle<CompilationCacheTable> table = GetFirstTable();
-  SetFirstTable(
-      CompilationCacheTable::Put(table, source, context, function_info));
+  SetFirstTable(CompilationCacheTable::Put(table, source, context,
+                                           function_info, instrumented));
 }
 
 
 MaybeHandle<SharedFunctionInfo> CompilationCacheEval::Lookup(
     Handle<String> source, Handle<SharedFunctionInfo> outer_info,
-    StrictMode strict_mode, int scope_position) {
+    StrictMode strict_mode, int scope_position, bool instrumented) {
   HandleScope scope(isolate());
   // Make sure not to leak the table into the surrounding handle
   // scope. Otherwise, we risk keeping old tables around even after
@@ -218,14 +221,15 @@ MaybeHandle<SharedFunctionInfo> CompilationCacheEval::Lookup(
   int generation;
   for (generation = 0; generation < generations(); generation++) {
     Handle<CompilationCacheTable> table = GetTable(generation);
-    result = table->LookupEval(source, outer_info, strict_mode, scope_position);
+    result = table->LookupEval(source, outer_info, strict_mode, scope_position,
+                               instrumented);
     if (result->IsSharedFunctionInfo()) break;
   }
   if (result->IsSharedFunctionInfo()) {
     Handle<SharedFunctionInfo> function_info =
         Handle<SharedFunctionInfo>::cast(result);
     if (generation != 0) {
-      Put(source, outer_info, function_info, scope_position);
+      Put(source, outer_info, function_info, scope_position, instrumented);
     }
     isolate()->counters()->compilation_cache_hits()->Increment();
     return scope.CloseAndEscape(function_info);
@@ -239,11 +243,12 @@ MaybeHandle<SharedFunctionInfo> CompilationCacheEval::Lookup(
 void CompilationCacheEval::Put(Handle<String> source,
                                Handle<SharedFunctionInfo> outer_info,
                                Handle<SharedFunctionInfo> function_info,
-                               int scope_position) {
+                               int scope_position, bool instrumented) {
   HandleScope scope(isolate());
   Handle<CompilationCacheTable> table = GetFirstTable();
   table = CompilationCacheTable::PutEval(table, source, outer_info,
-                                         function_info, scope_position);
+                                         function_info, scope_position,
+                                         instrumented);
   SetFirstTable(table);
 }
 
@@ -304,7 +309,8 @@ MaybeHandle<SharedFunctionInfo> CompilationCache::LookupScript(
   if (!IsEnabled()) return MaybeHandle<SharedFunctionInfo>();
 
   return script_.Lookup(source, name, line_offset, column_offset,
-                        is_shared_cross_origin, context);
+                        is_shared_cross_origin, context,
+                        isolate()->event_racer_log()->InstrumentsNewCode());
 }
 
 
@@ -313,14 +319,15 @@ MaybeHandle<SharedFunctionInfo> CompilationCache::LookupEval(
     Handle<Context> context, StrictMode strict_mode, int scope_position) {
   if (!IsEnabled()) return MaybeHandle<SharedFunctionInfo>();
 
+  bool instrumented = isolate()->event_racer_log()->InstrumentsNewCode();
   MaybeHandle<SharedFunctionInfo> result;
   if (context->IsNativeContext()) {
-    result =
-        eval_global_.Lookup(source, outer_info, strict_mode, scope_position);
+    result = eval_global_.Lookup(source, outer_info, strict_mode,
+                                 scope_position, instrumented);
   } else {
     DCHECK(scope_position != RelocInfo::kNoPosition);
     result = eval_contextual_.Lookup(source, outer_info, strict_mode,
-                                     scope_position);
+                                     scope_position, instrumented);
   }
   return result;
 }
@@ -339,7 +346,8 @@ void CompilationCache::PutScript(Handle<String> source,
                                  Handle<SharedFunctionInfo> function_info) {
   if (!IsEnabled()) return;
 
-  script_.Put(source, context, function_info);
+  script_.Put(source, context, function_info,
+              isolate()->event_racer_log()->InstrumentsNewCode());
 }
 
 
@@ -351,11 +359,14 @@ void CompilationCache::PutEval(Handle<String> source,
   if (!IsEnabled()) return;
 
   HandleScope scope(isolate());
+  bool instrumented = isolate()->event_racer_log()->InstrumentsNewCode();
   if (context->IsNativeContext()) {
-    eval_global_.Put(source, outer_info, function_info, scope_position);
+    eval_global_.Put(source, outer_info, function_info, scope_position,
+                     instrumented);
   } else {
     DCHECK(scope_position != RelocInfo::kNoPosition);
-    eval_contextual_.Put(source, outer_info, function_info, scope_position);
+    eval_contextual_.Put(source, outer_info, function_info, scope_position,
+                         instrumented);
   }
 }
 
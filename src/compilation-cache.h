@@ -77,10 +77,12 @@ class CompilationCacheScript : public CompilationSubCache {
                                     int line_offset,
                                     int column_offset,
                                     bool is_shared_cross_origin,
-                                    Handle<Context> context);
+                                    Handle<Context> context,
+                                    bool instrumented);
   void Put(Handle<String> source,
            Handle<Context> context,
-           Handle<SharedFunctionInfo> function_info);
+           Handle<SharedFunctionInfo> function_info,
+           bool instrumented);
 
  private:
   bool HasOrigin(Handle<SharedFunctionInfo> function_info,
@@ -105,6 +107,7 @@ class CompilationCacheScript : public CompilationSubCache {
 //    More specifically these are the CompileString, DebugEvaluate and
 //    DebugEvaluateGlobal runtime functions.
 // 4. The start position of the calling scope.
+// 5. Whether the code is compiled with the ER instrumentation.
 class CompilationCacheEval: public CompilationSubCache {
  public:
   CompilationCacheEval(Isolate* isolate, int generations)
@@ -113,10 +116,12 @@ class CompilationCacheEval: public CompilationSubCache {
   MaybeHandle<SharedFunctionInfo> Lookup(Handle<String> source,
                                          Handle<SharedFunctionInfo> outer_info,
                                          StrictMode strict_mode,
-                                         int scope_position);
+                                         int scope_position,
+                                         bool instrumented);
 
   void Put(Handle<String> source, Handle<SharedFunctionInfo> outer_info,
-           Handle<SharedFunctionInfo> function_info, int scope_position);
+           Handle<SharedFunctionInfo> function_info, int scope_position,
+           bool instrumented);
 
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(CompilationCacheEval);
@@ -142,7 +147,10 @@ class CompilationCacheRegExp: public CompilationSubCache {
 // The compilation cache keeps shared function infos for compiled
 // scripts and evals. The shared function infos are looked up using
 // the source string as the key. For regular expressions the
-// compilation data is cached.
+// compilation data is cached. Scripts and evals are cached separately
+// for each state of the ER instrumentation, see
+// EventRacerLog::InstrumentsNewCode(), so the instrumented and the
+// uninstrumented code can be cached at the same time.
 class CompilationCache {
  public:
   // Finds the script shared function info for a source
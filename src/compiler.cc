@@ -15,6 +15,7 @@
 #include "src/cpu-profiler.h"
 #include "src/debug.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/event-racer-rewriter.h"
 #include "src/full-codegen.h"
 #include "src/gdb-jit.h"
@@ -152,6 +153,7 @@ void CompilationInfo::Initialize(Isolate* isolate,
   cached_data_ = NULL;
   compile_options_ = ScriptCompiler::kNoCompileOptions;
   zone_ = zone;
+  event_racer_sites_ = NULL;
   deferred_handles_ = NULL;
   code_stub_ = NULL;
   prologue_offset_ = Code::kPrologueOffsetNotSet;
@@ -762,7 +764,10 @@ static void InsertCodeIntoOptimizedCodeMap(CompilationInfo* info) {
 
 
 static bool Renumber(CompilationInfo* info) {
-  if (!AstNumbering::Renumber(info->function(), info->zone())) return false;
+  if (!AstNumbering::Renumber(info->function(), info->zone(),
+                              info->is_instrumented())) {
+    return false;
+  }
   if (!info->shared_info().is_null()) {
     FunctionLiteral* lit = info->function();
     info->shared_info()->set_ast_node_count(lit->ast_node_count());
@@ -843,17 +848,191 @@ static bool CheckSuperConstructorCall(CompilationInfo* info) {
 }
 
 
-bool Compiler::Analyze(CompilationInfo* info) {
+static bool MatchesFilterPattern(Vector<const char> pattern, String* name) {
+  int n = pattern.length();
+  if (n > 0 && pattern[n - 1] == '*') {
+    return name->IsUtf8EqualTo(pattern.SubVector(0, n - 1), true);
+  }
+  return name->IsUtf8EqualTo(pattern);
+}
+
+
+// The ER filters are comma separated lists of patterns with the syntax of
+// --turbo-filter: "name", "name*" and "*" match the name, names starting
+// with "name" and all names, a leading "-" excludes the matching names.
+// A name passes if it matches none of the excluding patterns and either
+// matches one of the other patterns, or there are no other patterns.
+static bool PassesEventRacerFilter(const char* filter, String* name) {
+  bool has_positive = false;
+  bool matched = false;
+  for (;;) {
+    const char* end = strchr(filter, ',');
+    int length =
+        end != NULL ? static_cast<int>(end - filter) : StrLength(filter);
+    Vector<const char> pattern(filter, length);
+    bool negative = length > 0 && pattern[0] == '-';
+    if (negative) {
+      pattern = pattern.SubVector(1, length);
+    } else {
+      has_positive = true;
+    }
+    if (MatchesFilterPattern(pattern, name)) {
+      if (negative) return false;
+      matched = true;
+    }
+    if (end == NULL) break;
+    filter = end + 1;
+  }
+  return matched || !has_positive;
+}
+
+
+// Returns true if the script and the function, compiled by |info|, pass
+// the ER filters of the context, or the --er-*-filter flags.
+static bool PassesEventRacerFilters(CompilationInfo* info) {
+  Isolate* isolate = info->isolate();
+  SmartArrayPointer<char> script_filter, function_filter;
+  if (!info->context().is_null()) {
+    Object* filter = info->context()->native_context()->event_racer_filter();
+    if (filter->IsFixedArray()) {
+      FixedArray* filters = FixedArray::cast(filter);
+      script_filter = String::cast(filters->get(0))->ToCString();
+      function_filter = String::cast(filters->get(1))->ToCString();
+    }
+  }
+  const char* script_pattern =
+      script_filter.is_empty() ? FLAG_er_script_filter : script_filter.get();
+  const char* function_pattern = function_filter.is_empty()
+                                     ? FLAG_er_function_filter
+                                     : function_filter.get();
+
+  String* script_name = isolate->heap()->empty_string();
+  Handle<Script> script = info->script();
+  if (!script.is_null() && script->name()->IsString()) {
+    script_name = String::cast(script->name());
+  }
+  if (!PassesEventRacerFilter(script_pattern, script_name)) return false;
+
+  // Top-level and eval code has no shared function info yet and has an
+  // empty name.
+  String* function_name = isolate->heap()->empty_string();
+  Handle<SharedFunctionInfo> shared = info->shared_info();
+  if (!shared.is_null()) function_name = shared->DebugName();
+  return PassesEventRacerFilter(function_pattern, function_name);
+}
+
+
+static bool ShouldInstrument(CompilationInfo* info) {
+  if (info->is_native() || !FLAG_instrument) return false;
+  // The AST used for optimization, deoptimization support or debugging
+  // must match the one the existing unoptimized code was compiled from.
+  Handle<SharedFunctionInfo> shared = info->shared_info();
+  if (!shared.is_null() && shared->code()->kind() == Code::FUNCTION) {
+    return shared->code()->is_instrumented();
+  }
+  if (FLAG_instrument_lazily &&
+      !info->isolate()->event_racer_log()->enabled()) {
+    return false;
+  }
+  return PassesEventRacerFilters(info);
+}
+
+
+// The instrumentation may run on a background thread, so the sites are
+// registered with the log here, on the main thread, after the names have
+// been internalized.
+static void RegisterEventRacerSites(CompilationInfo* info) {
+  ZoneList<EventRacerSite>* sites = info->event_racer_sites();
+  if (sites == NULL) return;
+  DCHECK(info->ast_value_factory()->IsInternalized());
+  EventRacerLog* log = info->isolate()->event_racer_log();
+  int script_id = info->script().is_null() ? -1 : info->script()->id()->value();
+  for (int i = 0; i < sites->length(); ++i) {
+    const EventRacerSite& site = sites->at(i);
+    log->RegisterSite(site.id, static_cast<EventRacerLog::Op>(site.kind),
+                      site.name->string(), script_id, site.function_id,
+                      site.position);
+  }
+  sites->Rewind(0);
+}
+
+
+// Returns true if |filter| passes every name.
+static bool PassesAllNames(const char* filter) {
+  bool matches_all = false;
+  for (;;) {
+    const char* end = strchr(filter, ',');
+    int length =
+        end != NULL ? static_cast<int>(end - filter) : StrLength(filter);
+    if (length > 0 && filter[0] == '-') return false;
+    if (length == 1 && filter[0] == '*') matches_all = true;
+    if (end == NULL) break;
+    filter = end + 1;
+  }
+  return matches_all;
+}
+
+
+bool Compiler::ShouldInstrumentStreamedScript(Isolate* isolate) {
+  if (!isolate->event_racer_log()->InstrumentsNewCode()) return false;
+  // The script name is not known until the script is compiled, so only the
+  // filters, which pass any script, allow the background instrumentation.
+  // Scripts are top-level code, with an empty function name.
+  SmartArrayPointer<char> script_filter, function_filter;
+  if (isolate->context() != NULL) {
+    Object* filter = isolate->native_context()->event_racer_filter();
+    if (filter->IsFixedArray()) {
+      FixedArray* filters = FixedArray::cast(filter);
+      script_filter = String::cast(filters->get(0))->ToCString();
+      function_filter = String::cast(filters->get(1))->ToCString();
+    }
+  }
+  const char* script_pattern =
+      script_filter.is_empty() ? FLAG_er_script_filter : script_filter.get();
+  const char* function_pattern = function_filter.is_empty()
+                                     ? FLAG_er_function_filter
+                                     : function_filter.get();
+  return PassesAllNames(script_pattern) &&
+         PassesEventRacerFilter(function_pattern,
+                                isolate->heap()->empty_string());
+}
+
+
+bool Compiler::AnalyzeOnBackground(CompilationInfo* info, bool instrument,
+                                   uintptr_t stack_limit) {
   DCHECK(info->function() != NULL);
-  if (!Rewriter::Rewrite(info)) return false;
+  DCHECK(info->is_global() && !info->is_native());
+  // The module type errors of the scope analysis are thrown as exceptions.
+  if (FLAG_harmony_modules) return true;
+  if (!Rewriter::Rewrite(info, stack_limit)) return false;
   if (!Scope::Analyze(info)) return false;
-  if (!info->is_native() && FLAG_instrument) {
-    EventRacerRewriter rw(info);
+  if (instrument) {
+    info->MarkAsInstrumented();
+    EventRacerRewriter rw(info, stack_limit);
     info->function()->Accept(&rw);
+  }
+  info->MarkAsAnalyzed();
+  return true;
+}
+
 
-    AstSlotCounter cnt;
-    info->function()->Accept(&cnt);
+bool Compiler::Analyze(CompilationInfo* info) {
+  DCHECK(info->function() != NULL);
+  if (!info->is_analyzed()) {
+    if (!Rewriter::Rewrite(info)) return false;
+    if (!Scope::Analyze(info)) return false;
+  }
+  // A streamed script may have got the instrumentation in the background
+  // already. Should the filters or the log state have changed since, the
+  // instrumentation is kept, it records nothing while the log is disabled.
+  if (!info->is_instrumented() && ShouldInstrument(info)) {
+    HistogramTimerScope timer(
+        info->isolate()->counters()->compile_instrument());
+    info->MarkAsInstrumented();
+    EventRacerRewriter rw(info);
+    info->function()->Accept(&rw);
   }
+  RegisterEventRacerSites(info);
   info->PrepareForCompilation(info->function()->scope());
   if (!Renumber(info)) return false;
   DCHECK(info->scope() != NULL);
@@ -1032,6 +1211,7 @@ bool Compiler::EnsureDeoptimizationSupport(CompilationInfo* info) {
     unoptimized.PrepareForCompilation(info->scope());
     unoptimized.SetContext(info->context());
     unoptimized.EnableDeoptimizationSupport();
+    if (info->is_instrumented()) unoptimized.MarkAsInstrumented();
     // If the current code has reloc info for serialization, also include
     // reloc info for serialization for the new code, so that deopt support
     // can be added without losing IC state.
@@ -1348,8 +1528,11 @@ Handle<SharedFunctionInfo> Compiler::CompileScript(
     result = CompileToplevel(&info);
     if (extension == NULL && !result.is_null() && !result->dont_cache()) {
       compilation_cache->PutScript(source, context, result);
+      // The instrumented code refers to the ER sites of this isolate, which
+      // the consuming isolate does not have, so it is not serialized.
       if (FLAG_serialize_toplevel &&
-          compile_options == ScriptCompiler::kProduceCodeCache) {
+          compile_options == ScriptCompiler::kProduceCodeCache &&
+          !result->code()->is_instrumented()) {
         HistogramTimerScope histogram_timer(
             isolate->counters()->compile_serialize());
         *cached_data = CodeSerializer::Serialize(isolate, result, source);
@@ -1390,6 +1573,8 @@ Handle<SharedFunctionInfo> Compiler::BuildFunctionInfo(
   info.PrepareForCompilation(literal->scope());
   info.SetStrictMode(literal->scope()->strict_mode());
   if (outer_info->will_serialize()) info.PrepareForSerializing();
+  // The literal was instrumented, or not, along with the outer function.
+  if (outer_info->is_instrumented()) info.MarkAsInstrumented();
 
   Isolate* isolate = info.isolate();
   Factory* factory = isolate->factory();
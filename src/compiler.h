@@ -29,6 +29,16 @@ struct OffsetRange {
   int to;
 };
 
+// A global variable access, instrumented by the EventRacer rewriter, see
+// EventRacerLog::RegisterSite.
+struct EventRacerSite {
+  int id;
+  int kind;
+  const AstRawString* name;
+  int function_id;
+  int position;
+};
+
 
 class ScriptData {
  public:
@@ -89,7 +99,9 @@ class CompilationInfo {
     kInliningEnabled = 1 << 17,
     kTypingEnabled = 1 << 18,
     kDisableFutureOptimization = 1 << 19,
-    kToplevel = 1 << 20
+    kToplevel = 1 << 20,
+    kInstrumented = 1 << 21,
+    kAnalyzed = 1 << 22
   };
 
   CompilationInfo(Handle<JSFunction> closure, Zone* zone);
@@ -214,6 +226,16 @@ class CompilationInfo {
 
   bool is_toplevel() const { return GetFlag(kToplevel); }
 
+  void MarkAsInstrumented() { SetFlag(kInstrumented); }
+
+  bool is_instrumented() const { return GetFlag(kInstrumented); }
+
+  // Set once the AST rewrites and the scope analysis have run off the main
+  // thread, see Compiler::AnalyzeOnBackground.
+  void MarkAsAnalyzed() { SetFlag(kAnalyzed); }
+
+  bool is_analyzed() const { return GetFlag(kAnalyzed); }
+
   bool IsCodePreAgingActive() const {
     return FLAG_optimize_for_size && FLAG_age_code && !will_serialize() &&
            !is_debug();
@@ -394,6 +416,18 @@ class CompilationInfo {
     ast_value_factory_owned_ = owned;
   }
 
+  // The sites of the EventRacer instrumentation, to be registered with the
+  // log once the names are internalized.
+  void AddEventRacerSite(const EventRacerSite& site) {
+    if (event_racer_sites_ == NULL) {
+      event_racer_sites_ = new (zone_) ZoneList<EventRacerSite>(4, zone_);
+    }
+    event_racer_sites_->Add(site, zone_);
+  }
+  ZoneList<EventRacerSite>* event_racer_sites() const {
+    return event_racer_sites_;
+  }
+
  protected:
   CompilationInfo(Handle<Script> script,
                   Zone* zone);
@@ -514,6 +548,8 @@ class CompilationInfo {
   AstValueFactory* ast_value_factory_;
   bool ast_value_factory_owned_;
 
+  ZoneList<EventRacerSite>* event_racer_sites_;
+
   // This flag is used by the main thread to track whether this compilation
   // should be abandoned due to dependency change.
   bool aborted_due_to_dependency_change_;
@@ -682,6 +718,16 @@ class Compiler : public AllStatic {
   static bool ParseAndAnalyze(CompilationInfo* info);
   // Rewrite, analyze scopes, and renumber.
   static bool Analyze(CompilationInfo* info);
+  // The part of Analyze, which does not touch the heap, run by the
+  // background parsing task on a streamed script: rewrite, analyze scopes
+  // and, if |instrument|, add the ER instrumentation. The stack is checked
+  // against |stack_limit|. Compiler::Analyze does the rest on the main
+  // thread.
+  static bool AnalyzeOnBackground(CompilationInfo* info, bool instrument,
+                                  uintptr_t stack_limit);
+  // Returns true if a streamed script, about to be parsed in the
+  // background, is to be instrumented by the background parsing task.
+  static bool ShouldInstrumentStreamedScript(Isolate* isolate);
   // Adds deoptimization support, requires ParseAndAnalyze.
   static bool EnsureDeoptimizationSupport(CompilationInfo* info);
 
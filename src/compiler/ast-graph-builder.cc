@@ -11,6 +11,7 @@
 #include "src/compiler/node-matchers.h"
 #include "src/compiler/node-properties-inl.h"
 #include "src/compiler/node-properties.h"
+#include "src/event-racer-log.h"
 #include "src/full-codegen.h"
 #include "src/parser.h"
 #include "src/scopes.h"
@@ -1398,6 +1399,13 @@ void AstGraphBuilder::VisitCallRuntime(CallRuntime* expr) {
     return VisitCallJSRuntime(expr);
   }
 
+  // Handle calls to the ER event recording intrinsics separately as the
+  // runtime call is guarded by a test of the event log enable counter.
+  int result_index;
+  if (IsEventRacerIntrinsic(function->function_id, &result_index)) {
+    return VisitCallEventRacerRuntime(expr, result_index);
+  }
+
   // Evaluate all arguments to the runtime call.
   ZoneList<Expression*>* args = expr->arguments();
   VisitForValues(args);
@@ -1411,6 +1419,53 @@ void AstGraphBuilder::VisitCallRuntime(CallRuntime* expr) {
 }
 
 
+bool AstGraphBuilder::IsEventRacerIntrinsic(Runtime::FunctionId id,
+                                            int* result_index) {
+  switch (id) {
+#define EVENT_RACER_INTRINSIC_CASE(Name, index) \
+  case Runtime::kInlineOptimized##Name:         \
+    *result_index = index;                      \
+    return true;
+    EVENT_RACER_INTRINSIC_LIST(EVENT_RACER_INTRINSIC_CASE)
+#undef EVENT_RACER_INTRINSIC_CASE
+    default:
+      return false;
+  }
+}
+
+
+void AstGraphBuilder::VisitCallEventRacerRuntime(CallRuntime* expr,
+                                                 int result_index) {
+  ZoneList<Expression*>* args = expr->arguments();
+  VisitForValues(args);
+  Node* result =
+      result_index < 0 ? jsgraph()->UndefinedConstant()
+                       : environment()->Peek(args->length() - 1 - result_index);
+
+  // Recording an event is left to the runtime, the disabled log costs just
+  // a load and a branch.
+  IfBuilder log_enabled(this);
+  Node* count =
+      NewNode(jsgraph()->machine()->Load(kMachInt32),
+              jsgraph()->ExternalConstant(
+                  ExternalReference::event_racer_log_enable_count_address(
+                      isolate())),
+              jsgraph()->ZeroConstant());
+  Node* check = NewNode(jsgraph()->machine()->Word32Equal(), count,
+                        jsgraph()->Int32Constant(0));
+  log_enabled.If(check, BranchHint::kTrue);
+  log_enabled.Then();
+  environment()->Drop(args->length());
+  log_enabled.Else();
+  const Operator* call =
+      javascript()->CallRuntime(expr->function()->function_id, args->length());
+  Node* value = ProcessArguments(call, args->length());
+  PrepareFrameState(value, expr->id(), ast_context()->GetStateCombine());
+  log_enabled.End();
+  ast_context()->ProduceValue(result);
+}
+
+
 void AstGraphBuilder::VisitUnaryOperation(UnaryOperation* expr) {
   switch (expr->op()) {
     case Token::DELETE:
@@ -175,6 +175,9 @@ class AstGraphBuilder : public StructuredGraphBuilder, public AstVisitor {
 
   // Dispatched from VisitCallRuntime.
   void VisitCallJSRuntime(CallRuntime* expr);
+  void VisitCallEventRacerRuntime(CallRuntime* expr, int result_index);
+  static bool IsEventRacerIntrinsic(Runtime::FunctionId id,
+                                    int* result_index);
 
   // Dispatched from VisitUnaryOperation.
   void VisitDelete(UnaryOperation* expr);
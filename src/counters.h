@@ -314,7 +314,9 @@ class HistogramTimerScope BASE_EMBEDDED {
   HT(compile_eval, V8.CompileEval)                           \
   /* Serialization as part of compilation (code caching) */  \
   HT(compile_serialize, V8.CompileSerialize)                 \
-  HT(compile_deserialize, V8.CompileDeserialize)
+  HT(compile_deserialize, V8.CompileDeserialize)             \
+  /* ER instrumentation as part of compilation */            \
+  HT(compile_instrument, V8.CompileInstrument)
 
 
 #define HISTOGRAM_PERCENTAGE_LIST(HP)                                 \
@@ -98,6 +98,28 @@
         }],
       ],
     },
+    {
+      # Offline analyzer of the ER traces, see event-racer-analyze.cc.
+      'target_name': 'er_analyze',
+      'type': 'executable',
+      'dependencies': [
+        '../tools/gyp/v8.gyp:v8_libbase',
+        '../tools/gyp/v8.gyp:v8_libplatform',
+      ],
+      'include_dirs+': [
+        '..',
+      ],
+      'sources': [
+        'event-racer-analyze.cc',
+        'event-racer-analyzer.cc',
+        'event-racer-analyzer.h',
+      ],
+      'conditions': [
+        [ 'want_separate_host_toolset==1', {
+          'toolsets': [ '<(v8_toolset_for_d8)', ],
+        }],
+      ],
+    },
     {
       'target_name': 'd8_js2c',
       'type': 'none',
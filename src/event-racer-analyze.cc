@@ -0,0 +1,141 @@
+// er_analyze: offline analysis of the binary ER traces, written with
+// |--er-trace|, see event-racer-analyzer.h.
+//
+//   er_analyze [--threads=N] [--shards=N] [--top=N] trace-file
+//
+// The trace is memory-mapped read-only and analyzed on the libplatform
+// worker threads.
+
+#include "src/v8.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <limits>
+
+#include "include/libplatform/libplatform.h"
+#include "src/base/sys-info.h"
+#include "src/event-racer-analyzer.h"
+
+namespace v8 {
+namespace internal {
+
+namespace {
+
+// A read-only mapping of a whole file.
+class MappedFile {
+public:
+  MappedFile() : memory_(NULL), size_(0) {}
+  ~MappedFile() {
+    if (memory_ != NULL)
+      munmap(memory_, size_);
+  }
+
+  // Returns false and prints the reason on failure.
+  bool Map(const char *file_name) {
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+      fprintf(stderr, "Cannot open %s: %s\n", file_name, strerror(errno));
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      fprintf(stderr, "Cannot stat %s: %s\n", file_name, strerror(errno));
+      close(fd);
+      return false;
+    }
+    if (static_cast<uint64_t>(st.st_size) >
+        std::numeric_limits<size_t>::max()) {
+      fprintf(stderr, "%s is too large to map\n", file_name);
+      close(fd);
+      return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    // An empty file cannot be mapped, it is not a trace either.
+    if (size_ > 0) {
+      void *memory = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (memory == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", file_name, strerror(errno));
+        close(fd);
+        return false;
+      }
+      memory_ = memory;
+    }
+    close(fd);
+    return true;
+  }
+
+  const byte *data() const { return static_cast<const byte*>(memory_); }
+  size_t size() const { return size_; }
+
+private:
+  void *memory_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+bool ParseIntOption(const char *arg, const char *name, int *value) {
+  size_t n = strlen(name);
+  if (strncmp(arg, name, n) != 0 || arg[n] != '=')
+    return false;
+  *value = atoi(arg + n + 1);
+  return true;
+}
+
+int Main(int argc, char **argv) {
+  int threads = 0;
+  int shards = 0;
+  int top = 20;
+  const char *file_name = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (ParseIntOption(argv[i], "--threads", &threads) ||
+        ParseIntOption(argv[i], "--shards", &shards) ||
+        ParseIntOption(argv[i], "--top", &top))
+      continue;
+    if (argv[i][0] == '-' || file_name != NULL) {
+      file_name = NULL;
+      break;
+    }
+    file_name = argv[i];
+  }
+  if (file_name == NULL) {
+    fprintf(stderr,
+            "Usage: %s [--threads=N] [--shards=N] [--top=N] trace-file\n",
+            argv[0]);
+    return 1;
+  }
+  if (threads <= 0)
+    threads = base::SysInfo::NumberOfProcessors();
+  if (shards <= 0)
+    shards = 4 * threads;
+
+  MappedFile file;
+  if (!file.Map(file_name))
+    return 1;
+
+  v8::Platform *platform = v8::platform::CreateDefaultPlatform(threads);
+  EventRacerTraceSummary summary;
+  bool ok = AnalyzeEventRacerTrace(platform, threads, shards, top,
+                                   file.data(), file.size(), &summary);
+  if (ok)
+    PrintEventRacerTraceSummary(stdout, file_name, summary);
+  else
+    fprintf(stderr, "%s is not an ER trace\n", file_name);
+  delete platform;
+  return ok ? 0 : 1;
+}
+
+}  // namespace
+
+} }  // namespace v8::internal
+
+int main(int argc, char **argv) {
+  return v8::internal::Main(argc, argv);
+}
@@ -0,0 +1,985 @@
+// Offline analysis of the binary ER traces, written with |--er-trace|, see
+// event-racer-trace.h for the format.
+//
+// The trace is analyzed in three parallel phases on the worker threads of
+// the platform:
+//
+//   1. The chunks are scanned for the number of event records, the resets
+//      and the effect on the function call depth. A prefix pass over the
+//      scan results gives the state at the start of each chunk.
+//   2. The chunks are decoded. The accesses are sharded by object id and
+//      the name records are collected.
+//   3. Each shard is sorted by location, the access history of each
+//      location is replayed to find the conflicting access pairs and the
+//      per-location and per-object summaries are computed.
+//
+// The trace does not record the happens-before relation, so the accesses
+// are attributed to segments instead: a segment runs from one entry of a
+// top-level function to the next. Two accesses of the same location
+// conflict if they come from different segments and at least one of them
+// is a write. As in |EventRacerDetector|, each access is checked against
+// the last write and, for a write, against the reads since the last write,
+// one per segment. Element accesses of range records are expanded and
+// match the single element accesses with the same index. The accesses of a
+// whole array, which have no name, touch every location of the object, so
+// they are replayed along with the accesses of each of them.
+//
+// The analyzer is also built into the offline tool, which does not link
+// the V8 library, so it uses only the headers of the rest of V8.
+
+#include "src/v8.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/v8-platform.h"
+#include "src/base/platform/semaphore.h"
+#include "src/event-racer-analyzer.h"
+#include "src/event-racer-log.h"
+#include "src/event-racer-trace.h"
+
+namespace v8 {
+namespace internal {
+
+namespace {
+
+// Same as |EventRacerTrace::kMagic|, which lives in the V8 library. The
+// last byte is the format version, the version 1 traces, which lack the
+// |kSeq| records, are read, too.
+const char kTraceMagic[8] = { 'V', '8', 'E', 'R', 'T', 'R', 'C', 2 };
+STATIC_ASSERT(sizeof(kTraceMagic) == sizeof(EventRacerTrace::kMagic));
+
+const int kOpCount = EventRacerLog::kWriteRange + 1;
+
+const char *const kOpNames[kOpCount] = {
+  "none",
+#define OP(name, code) #name,
+  EVENT_RACER_OP_LIST(OP)
+#undef OP
+};
+
+// Larger than any depth change a trace can have, but far from overflow.
+const int64_t kResetDepth = -(static_cast<int64_t>(1) << 62);
+
+// Name keys of the element indices, which do not collide with the indices
+// into the global name table.
+const int64_t kIndexKeyBase = static_cast<int64_t>(1) << 32;
+
+int64_t IndexKey(int32_t index) {
+  return kIndexKeyBase + static_cast<uint32_t>(index);
+}
+
+bool IsIndexKey(int64_t key) { return key >= kIndexKeyBase; }
+
+// Key of a name, which is referred to, but not defined in the trace.
+const int64_t kUnknownKey = -1;
+
+// Key of the empty name of the whole-array accesses. The smallest key, so
+// these come first among the accesses of an object.
+const int64_t kArrayKey = kUnknownKey - 1;
+
+bool IsRead(int op) {
+  return op == EventRacerLog::kRead || op == EventRacerLog::kReadProp ||
+         op == EventRacerLog::kReadArray || op == EventRacerLog::kReadRange;
+}
+
+struct Chunk {
+  const byte *data;
+  size_t size;
+};
+
+// Bounds checked decoding of the records of a chunk.
+class RecordReader {
+public:
+  explicit RecordReader(const Chunk &chunk)
+    : pos_(chunk.data), end_(chunk.data + chunk.size), malformed_(false) {}
+
+  bool done() const { return pos_ >= end_ || malformed_; }
+  bool malformed() const { return malformed_; }
+
+  byte ReadByte() { return pos_ < end_ ? *pos_++ : Fail(); }
+
+  uint32_t ReadVarint() {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      byte b = ReadByte();
+      value |= static_cast<uint32_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0)
+        return value;
+    }
+    return Fail();
+  }
+
+  int32_t ReadSigned() {
+    uint32_t v = ReadVarint();
+    return static_cast<int32_t>((v >> 1) ^ (0u - (v & 1)));
+  }
+
+  const char *ReadBytes(uint32_t length) {
+    if (static_cast<size_t>(end_ - pos_) < length) {
+      Fail();
+      return NULL;
+    }
+    const char *p = reinterpret_cast<const char*>(pos_);
+    pos_ += length;
+    return p;
+  }
+
+private:
+  byte Fail() {
+    malformed_ = true;
+    pos_ = end_;
+    return 0;
+  }
+
+  const byte *pos_;
+  const byte *end_;
+  bool malformed_;
+};
+
+// A decoded record. |name| and |fn| hold the first and the last index of a
+// range record.
+struct Record {
+  int tag;
+  int32_t obj;
+  int32_t name;
+  int32_t fn;
+  int32_t stride;
+  const char *str;
+  uint32_t length;
+};
+
+// Returns false on a malformed record.
+bool ReadRecord(RecordReader *in, Record *r) {
+  r->tag = in->ReadByte();
+  switch (r->tag) {
+    case EventRacerTrace::kName:
+      r->name = static_cast<int32_t>(in->ReadVarint());
+      r->length = in->ReadVarint();
+      r->str = in->ReadBytes(r->length);
+      break;
+    case EventRacerTrace::kFunc:
+      in->ReadVarint();
+      in->ReadSigned();
+      in->ReadSigned();
+      in->ReadSigned();
+      break;
+    case EventRacerTrace::kReset:
+      break;
+    case EventRacerTrace::kSeq:
+      // The analysis does not need the sequence numbers.
+      in->ReadVarint();
+      break;
+    case EventRacerLog::kReadRange:
+    case EventRacerLog::kWriteRange:
+      r->obj = static_cast<int32_t>(in->ReadVarint());
+      r->name = in->ReadSigned();
+      r->fn = in->ReadSigned();
+      r->stride = in->ReadSigned();
+      break;
+    default:
+      if (r->tag <= 0 || r->tag >= kOpCount)
+        return false;
+      r->obj = static_cast<int32_t>(in->ReadVarint());
+      r->name = static_cast<int32_t>(in->ReadVarint());
+      r->fn = static_cast<int32_t>(in->ReadVarint());
+      break;
+  }
+  return !in->malformed();
+}
+
+bool IsEvent(int tag) { return tag > 0 && tag < kOpCount; }
+
+// The effect of a sequence of records on the call depth |d|, which is
+// |max(d + add, floor)|. Exits at depth zero are ignored and resets bring
+// the depth to zero.
+struct DepthChange {
+  int64_t add;
+  int64_t floor;
+
+  void Enter() {
+    ++add;
+    ++floor;
+  }
+  void Exit() {
+    --add;
+    floor = std::max<int64_t>(floor - 1, 0);
+  }
+  void Reset() {
+    add = kResetDepth;
+    floor = 0;
+  }
+  int64_t Apply(int64_t depth) const { return std::max(depth + add, floor); }
+};
+
+// Result of the first phase for a chunk.
+struct ChunkScan {
+  int64_t events;
+  int resets;
+  DepthChange depth;
+  bool malformed;
+};
+
+// State at the start of a chunk.
+struct ChunkStart {
+  int64_t seq;
+  int64_t depth;
+  int epoch;
+};
+
+struct Access {
+  int32_t obj;
+  // Index into the name table of |epoch|, or an element index if |epoch|
+  // is negative.
+  int32_t name;
+  int32_t epoch;
+  bool write;
+  // Sequence number of the event record.
+  int64_t seq;
+  // Sequence number of the top-level function entry, which begins the
+  // segment, or -1 if the segment begins in an earlier chunk.
+  int64_t segment;
+};
+
+struct NameDef {
+  int epoch;
+  int32_t index;
+  const char *str;
+  uint32_t length;
+};
+
+// Result of the second phase for a chunk.
+struct ChunkData {
+  std::vector<NameDef> names;
+  std::vector<std::vector<Access> > shards;
+  int64_t op_counts[kOpCount];
+  // The segment in progress at the end of the chunk, or -1 if it began in
+  // an earlier chunk.
+  int64_t last_segment;
+  int64_t segments;
+};
+
+struct LocationSummary {
+  int32_t obj;
+  int64_t key;
+  int64_t reads;
+  int64_t writes;
+  int64_t conflicts;
+  // The first conflicting pair.
+  int64_t first_seq;
+  bool first_write;
+  int64_t second_seq;
+  bool second_write;
+};
+
+struct ObjectSummary {
+  int32_t obj;
+  int64_t locations;
+  int64_t reads;
+  int64_t writes;
+  int64_t conflicts;
+};
+
+bool MoreConflicts(const LocationSummary &a, const LocationSummary &b) {
+  if (a.conflicts != b.conflicts)
+    return a.conflicts > b.conflicts;
+  if (a.obj != b.obj)
+    return a.obj < b.obj;
+  return a.key < b.key;
+}
+
+bool MoreObjectConflicts(const ObjectSummary &a, const ObjectSummary &b) {
+  if (a.conflicts != b.conflicts)
+    return a.conflicts > b.conflicts;
+  return a.obj < b.obj;
+}
+
+// Work, which runs on a worker thread.
+class Job {
+public:
+  virtual ~Job() {}
+  virtual void Run() = 0;
+};
+
+class JobTask : public v8::Task {
+public:
+  JobTask(Job *job, base::Semaphore *done) : job_(job), done_(done) {}
+
+  void Run() OVERRIDE {
+    job_->Run();
+    done_->Signal();
+  }
+
+private:
+  Job *job_;
+  base::Semaphore *done_;
+};
+
+// Runs the jobs on the worker threads of |platform| and waits for them.
+void RunJobs(v8::Platform *platform, const std::vector<Job*> &jobs) {
+  base::Semaphore done(0);
+  for (size_t i = 0; i < jobs.size(); ++i)
+    platform->CallOnBackgroundThread(new JobTask(jobs[i], &done),
+                                     v8::Platform::kShortRunningTask);
+  for (size_t i = 0; i < jobs.size(); ++i)
+    done.Wait();
+}
+
+class Analyzer {
+public:
+  Analyzer(v8::Platform *platform, int threads, int shards, int top)
+    : platform_(platform), threads_(threads), shard_count_(shards),
+      top_(top), malformed_chunks_(0), resets_(0), events_(0),
+      segments_(0) {
+    for (int i = 0; i < kOpCount; ++i)
+      op_counts_[i] = 0;
+  }
+
+  // Returns false if the trace is not a valid ER trace.
+  bool Analyze(const byte *data, size_t size);
+
+  void Summarize(EventRacerTraceSummary *summary) const;
+
+private:
+  class ScanJob;
+  class DecodeJob;
+  class ShardJob;
+
+  bool SplitChunks(const byte *data, size_t size);
+  void Scan();
+  void Decode();
+  void BuildNameTable();
+  void AnalyzeShards();
+
+  int64_t NameKey(const Access &a) const;
+  std::string PrintName(int64_t key) const;
+
+  // Splits |count| items into contiguous batches, a few per thread, so the
+  // load balances.
+  int BatchCount(size_t count) const {
+    return static_cast<int>(std::min<size_t>(count, 4 * threads_));
+  }
+  static size_t BatchBegin(size_t count, int batches, int i) {
+    return count * i / batches;
+  }
+
+  v8::Platform *platform_;
+  int threads_;
+  int shard_count_;
+  int top_;
+
+  std::vector<Chunk> chunks_;
+  std::vector<ChunkScan> scans_;
+  std::vector<ChunkStart> starts_;
+  std::vector<ChunkData*> data_;
+  // The segment in progress at the start of each chunk.
+  std::vector<int64_t> inherited_segments_;
+
+  // Name keys by epoch and name index, and the names by key.
+  std::vector<std::vector<int64_t> > name_keys_;
+  std::vector<std::string> names_;
+
+  int malformed_chunks_;
+  int resets_;
+  int64_t events_;
+  int64_t segments_;
+  int64_t op_counts_[kOpCount];
+
+  std::vector<std::vector<LocationSummary> > shard_locations_;
+  std::vector<std::vector<ObjectSummary> > shard_objects_;
+  std::vector<LocationSummary> top_locations_;
+  std::vector<ObjectSummary> top_objects_;
+  int64_t accesses_;
+  int64_t locations_;
+  int64_t conflict_locations_;
+  int64_t objects_;
+  int64_t conflicts_;
+};
+
+class Analyzer::ScanJob : public Job {
+public:
+  ScanJob(Analyzer *a, size_t begin, size_t end)
+    : a_(a), begin_(begin), end_(end) {}
+
+  void Run() OVERRIDE {
+    for (size_t i = begin_; i < end_; ++i)
+      Scan(a_->chunks_[i], &a_->scans_[i]);
+  }
+
+private:
+  static void Scan(const Chunk &chunk, ChunkScan *scan) {
+    scan->events = 0;
+    scan->resets = 0;
+    scan->depth.add = 0;
+    scan->depth.floor = 0;
+    scan->malformed = false;
+    RecordReader in(chunk);
+    Record r;
+    while (!in.done()) {
+      if (!ReadRecord(&in, &r)) {
+        scan->malformed = true;
+        break;
+      }
+      if (r.tag == EventRacerTrace::kReset) {
+        ++scan->resets;
+        scan->depth.Reset();
+      } else if (IsEvent(r.tag)) {
+        ++scan->events;
+        if (r.tag == EventRacerLog::kEnterFunc)
+          scan->depth.Enter();
+        else if (r.tag == EventRacerLog::kExitFunc)
+          scan->depth.Exit();
+      }
+    }
+  }
+
+  Analyzer *a_;
+  size_t begin_;
+  size_t end_;
+};
+
+class Analyzer::DecodeJob : public Job {
+public:
+  DecodeJob(Analyzer *a, size_t begin, size_t end)
+    : a_(a), begin_(begin), end_(end) {}
+
+  void Run() OVERRIDE {
+    for (size_t i = begin_; i < end_; ++i) {
+      ChunkData *data = new ChunkData;
+      Decode(a_->chunks_[i], a_->starts_[i], a_->shard_count_, data);
+      a_->data_[i] = data;
+    }
+  }
+
+private:
+  static void Decode(const Chunk &chunk, const ChunkStart &start, int shards,
+                     ChunkData *data) {
+    data->shards.resize(shards);
+    for (int i = 0; i < kOpCount; ++i)
+      data->op_counts[i] = 0;
+    data->last_segment = -1;
+    data->segments = 0;
+
+    int64_t seq = start.seq;
+    int64_t depth = start.depth;
+    int epoch = start.epoch;
+    RecordReader in(chunk);
+    Record r;
+    while (!in.done() && ReadRecord(&in, &r)) {
+      if (r.tag == EventRacerTrace::kName) {
+        NameDef def = { epoch, r.name, r.str, r.length };
+        data->names.push_back(def);
+        continue;
+      }
+      if (r.tag == EventRacerTrace::kReset) {
+        ++epoch;
+        depth = 0;
+        continue;
+      }
+      if (!IsEvent(r.tag))
+        continue;
+
+      ++data->op_counts[r.tag];
+      if (r.tag == EventRacerLog::kEnterFunc) {
+        if (depth == 0) {
+          data->last_segment = seq;
+          ++data->segments;
+        }
+        ++depth;
+      } else if (r.tag == EventRacerLog::kExitFunc) {
+        depth = std::max<int64_t>(depth - 1, 0);
+      } else {
+        Access a;
+        a.obj = r.obj;
+        a.write = !IsRead(r.tag);
+        a.seq = seq;
+        a.segment = data->last_segment;
+        std::vector<Access> &shard =
+            data->shards[static_cast<uint32_t>(r.obj) % shards];
+        if (r.tag == EventRacerLog::kReadRange ||
+            r.tag == EventRacerLog::kWriteRange) {
+          a.epoch = -1;
+          int64_t step = r.stride != 0 ? r.stride : 1;
+          for (int64_t i = r.name; step > 0 ? i <= r.fn : i >= r.fn;
+               i += step) {
+            a.name = static_cast<int32_t>(i);
+            shard.push_back(a);
+          }
+        } else {
+          a.epoch = epoch;
+          a.name = r.name;
+          shard.push_back(a);
+        }
+      }
+      ++seq;
+    }
+  }
+
+  Analyzer *a_;
+  size_t begin_;
+  size_t end_;
+};
+
+class Analyzer::ShardJob : public Job {
+public:
+  ShardJob(Analyzer *a, int shard) : a_(a), shard_(shard) {}
+
+  void Run() OVERRIDE {
+    std::vector<Access> accesses;
+    size_t total = 0;
+    for (size_t i = 0; i < a_->data_.size(); ++i)
+      total += a_->data_[i]->shards[shard_].size();
+    accesses.reserve(total);
+    // Resolve the segments, which begin in earlier chunks, and release the
+    // per-chunk buffers.
+    for (size_t i = 0; i < a_->data_.size(); ++i) {
+      std::vector<Access> &part = a_->data_[i]->shards[shard_];
+      for (size_t j = 0; j < part.size(); ++j) {
+        Access access = part[j];
+        if (access.segment < 0)
+          access.segment = a_->inherited_segments_[i];
+        accesses.push_back(access);
+      }
+      std::vector<Access>().swap(part);
+    }
+
+    // Replace the names with the keys, which are the same for the same
+    // name in all epochs, and order the accesses by location.
+    std::vector<Keyed> keyed(accesses.size());
+    for (size_t i = 0; i < accesses.size(); ++i) {
+      keyed[i].key = a_->NameKey(accesses[i]);
+      keyed[i].access = &accesses[i];
+    }
+    std::sort(keyed.begin(), keyed.end(), ByLocation);
+
+    std::vector<LocationSummary> &locations = a_->shard_locations_[shard_];
+    std::vector<ObjectSummary> &objects = a_->shard_objects_[shard_];
+    // The whole-array accesses of the current object, if any.
+    size_t array_begin = 0;
+    size_t array_end = 0;
+    size_t i = 0;
+    while (i < keyed.size()) {
+      size_t end = i + 1;
+      int32_t obj_id = keyed[i].access->obj;
+      while (end < keyed.size() && keyed[end].access->obj == obj_id &&
+             keyed[end].key == keyed[i].key)
+        ++end;
+      // Variables have no whole-array accesses.
+      LocationSummary loc;
+      if (keyed[i].key == kArrayKey && obj_id != 0) {
+        array_begin = i;
+        array_end = end;
+        loc = Replay(keyed, i, end, end, end);
+      } else {
+        if (array_begin == array_end ||
+            keyed[array_begin].access->obj != obj_id)
+          array_begin = array_end = 0;
+        loc = Replay(keyed, i, end, array_begin, array_end);
+      }
+      if (objects.empty() || objects.back().obj != loc.obj) {
+        ObjectSummary obj = { loc.obj, 0, 0, 0, 0 };
+        objects.push_back(obj);
+      }
+      ObjectSummary &obj = objects.back();
+      ++obj.locations;
+      obj.reads += loc.reads;
+      obj.writes += loc.writes;
+      obj.conflicts += loc.conflicts;
+      locations.push_back(loc);
+      i = end;
+    }
+  }
+
+private:
+  struct Keyed {
+    int64_t key;
+    const Access *access;
+  };
+
+  static bool ByLocation(const Keyed &a, const Keyed &b) {
+    if (a.access->obj != b.access->obj)
+      return a.access->obj < b.access->obj;
+    if (a.key != b.key)
+      return a.key < b.key;
+    return a.access->seq < b.access->seq;
+  }
+
+  // Replays the accesses of a location, in trace order, merged with the
+  // whole-array accesses of the object from |array_begin| to |array_end|.
+  // Only the conflicts with an access of the location itself are counted,
+  // the ones between two whole-array accesses are counted once, at the
+  // whole-array location.
+  static LocationSummary Replay(const std::vector<Keyed> &keyed, size_t begin,
+                                size_t end, size_t array_begin,
+                                size_t array_end) {
+    LocationSummary loc;
+    loc.obj = keyed[begin].access->obj;
+    loc.key = keyed[begin].key;
+    loc.reads = 0;
+    loc.writes = 0;
+    loc.conflicts = 0;
+    loc.first_seq = loc.second_seq = -1;
+    loc.first_write = loc.second_write = false;
+
+    const Keyed *last_write = NULL;
+    // The last read of each segment since the last write.
+    std::vector<const Keyed*> reads;
+    size_t i = begin;
+    size_t k = array_begin;
+    while (i < end || k < array_end) {
+      const Keyed *next;
+      if (k == array_end ||
+          (i < end && keyed[i].access->seq < keyed[k].access->seq))
+        next = &keyed[i++];
+      else
+        next = &keyed[k++];
+      const Access *a = next->access;
+      bool own = next->key == loc.key;
+      if (last_write != NULL && last_write->access->segment != a->segment)
+        Conflict(&loc, last_write, next);
+      if (a->write) {
+        if (own)
+          ++loc.writes;
+        for (size_t j = 0; j < reads.size(); ++j) {
+          if (reads[j]->access->segment != a->segment)
+            Conflict(&loc, reads[j], next);
+        }
+        reads.clear();
+        last_write = next;
+        continue;
+      }
+      if (own)
+        ++loc.reads;
+      size_t j = 0;
+      while (j < reads.size() && reads[j]->access->segment != a->segment)
+        ++j;
+      if (j == reads.size())
+        reads.push_back(next);
+      else
+        reads[j] = next;
+    }
+    return loc;
+  }
+
+  static void Conflict(LocationSummary *loc, const Keyed *prior,
+                       const Keyed *current) {
+    if (prior->key != loc->key && current->key != loc->key)
+      return;
+    const Access *first = prior->access;
+    const Access *second = current->access;
+    if (loc->conflicts++ == 0) {
+      loc->first_seq = first->seq;
+      loc->first_write = first->write;
+      loc->second_seq = second->seq;
+      loc->second_write = second->write;
+    }
+  }
+
+  Analyzer *a_;
+  int shard_;
+};
+
+bool Analyzer::SplitChunks(const byte *data, size_t size) {
+  const size_t version = sizeof(kTraceMagic) - 1;
+  if (size < sizeof(kTraceMagic) ||
+      memcmp(data, kTraceMagic, version) != 0 ||
+      data[version] < 1 || data[version] > kTraceMagic[version])
+    return false;
+  size_t pos = sizeof(kTraceMagic);
+  while (size - pos >= 4) {
+    const byte *h = data + pos;
+    size_t length = h[0] | (h[1] << 8) | (h[2] << 16) |
+                    (static_cast<size_t>(h[3]) << 24);
+    pos += 4;
+    // A truncated last chunk is analyzed as far as it goes.
+    Chunk chunk = { data + pos, std::min(length, size - pos) };
+    chunks_.push_back(chunk);
+    pos += chunk.size;
+  }
+  return true;
+}
+
+void Analyzer::Scan() {
+  scans_.resize(chunks_.size());
+  int batches = BatchCount(chunks_.size());
+  std::vector<Job*> jobs;
+  for (int i = 0; i < batches; ++i)
+    jobs.push_back(new ScanJob(this,
+                               BatchBegin(chunks_.size(), batches, i),
+                               BatchBegin(chunks_.size(), batches, i + 1)));
+  RunJobs(platform_, jobs);
+  for (size_t i = 0; i < jobs.size(); ++i)
+    delete jobs[i];
+
+  // The state at the start of each chunk follows from the earlier ones.
+  ChunkStart start = { 0, 0, 0 };
+  starts_.resize(chunks_.size());
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    starts_[i] = start;
+    const ChunkScan &scan = scans_[i];
+    start.seq += scan.events;
+    start.depth = scan.depth.Apply(start.depth);
+    start.epoch += scan.resets;
+    malformed_chunks_ += scan.malformed;
+  }
+  resets_ = start.epoch;
+  events_ = start.seq;
+}
+
+void Analyzer::Decode() {
+  data_.resize(chunks_.size());
+  int batches = BatchCount(chunks_.size());
+  std::vector<Job*> jobs;
+  for (int i = 0; i < batches; ++i)
+    jobs.push_back(new DecodeJob(this,
+                                 BatchBegin(chunks_.size(), batches, i),
+                                 BatchBegin(chunks_.size(), batches, i + 1)));
+  RunJobs(platform_, jobs);
+  for (size_t i = 0; i < jobs.size(); ++i)
+    delete jobs[i];
+
+  int64_t segment = -1;
+  inherited_segments_.resize(chunks_.size());
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    inherited_segments_[i] = segment;
+    const ChunkData &data = *data_[i];
+    if (data.last_segment >= 0)
+      segment = data.last_segment;
+    segments_ += data.segments;
+    for (int op = 0; op < kOpCount; ++op)
+      op_counts_[op] += data.op_counts[op];
+  }
+}
+
+// Returns true if |str| is the canonical decimal form of an array index,
+// which fits in an |int32_t|, as the log names the elements.
+static bool ParseIndex(const std::string &str, int32_t *index) {
+  if (str.empty() || str.size() > 10 || (str[0] == '0' && str.size() > 1))
+    return false;
+  int64_t value = 0;
+  for (size_t i = 0; i < str.size(); ++i) {
+    if (str[i] < '0' || str[i] > '9')
+      return false;
+    value = value * 10 + (str[i] - '0');
+  }
+  if (value > 0x7fffffff)
+    return false;
+  *index = static_cast<int32_t>(value);
+  return true;
+}
+
+void Analyzer::BuildNameTable() {
+  std::map<std::string, int64_t> keys;
+  name_keys_.resize(resets_ + 1);
+  for (size_t i = 0; i < data_.size(); ++i) {
+    std::vector<NameDef> &names = data_[i]->names;
+    for (size_t j = 0; j < names.size(); ++j) {
+      const NameDef &def = names[j];
+      if (def.index < 0)
+        continue;
+      std::string str(def.str, def.length);
+      int64_t key;
+      int32_t index;
+      if (ParseIndex(str, &index)) {
+        key = IndexKey(index);
+      } else {
+        std::map<std::string, int64_t>::iterator it = keys.find(str);
+        if (it == keys.end()) {
+          key = static_cast<int64_t>(names_.size());
+          keys[str] = key;
+          names_.push_back(str);
+        } else {
+          key = it->second;
+        }
+      }
+      std::vector<int64_t> &epoch_keys = name_keys_[def.epoch];
+      if (epoch_keys.size() <= static_cast<size_t>(def.index))
+        epoch_keys.resize(def.index + 1, kUnknownKey);
+      epoch_keys[def.index] = key;
+    }
+    std::vector<NameDef>().swap(names);
+  }
+}
+
+int64_t Analyzer::NameKey(const Access &a) const {
+  if (a.epoch < 0)
+    return IndexKey(a.name);
+  // The log defines the empty name at index zero without a record.
+  if (a.name == 0)
+    return kArrayKey;
+  const std::vector<int64_t> &epoch_keys = name_keys_[a.epoch];
+  if (a.name < 0 || static_cast<size_t>(a.name) >= epoch_keys.size())
+    return kUnknownKey;
+  return epoch_keys[a.name];
+}
+
+void Analyzer::AnalyzeShards() {
+  shard_locations_.resize(shard_count_);
+  shard_objects_.resize(shard_count_);
+  std::vector<Job*> jobs;
+  for (int i = 0; i < shard_count_; ++i)
+    jobs.push_back(new ShardJob(this, i));
+  RunJobs(platform_, jobs);
+  for (size_t i = 0; i < jobs.size(); ++i)
+    delete jobs[i];
+  for (size_t i = 0; i < data_.size(); ++i)
+    delete data_[i];
+  data_.clear();
+
+  accesses_ = locations_ = conflict_locations_ = objects_ = conflicts_ = 0;
+  for (int i = 0; i < shard_count_; ++i) {
+    std::vector<LocationSummary> &locations = shard_locations_[i];
+    for (size_t j = 0; j < locations.size(); ++j) {
+      const LocationSummary &loc = locations[j];
+      accesses_ += loc.reads + loc.writes;
+      conflicts_ += loc.conflicts;
+      if (loc.conflicts > 0) {
+        ++conflict_locations_;
+        top_locations_.push_back(loc);
+      }
+    }
+    locations_ += locations.size();
+    std::vector<LocationSummary>().swap(locations);
+
+    std::vector<ObjectSummary> &objects = shard_objects_[i];
+    for (size_t j = 0; j < objects.size(); ++j) {
+      if (objects[j].conflicts > 0)
+        top_objects_.push_back(objects[j]);
+    }
+    objects_ += objects.size();
+    std::vector<ObjectSummary>().swap(objects);
+  }
+
+  size_t n = std::min<size_t>(top_, top_locations_.size());
+  std::partial_sort(top_locations_.begin(), top_locations_.begin() + n,
+                    top_locations_.end(), MoreConflicts);
+  top_locations_.resize(n);
+  n = std::min<size_t>(top_, top_objects_.size());
+  std::partial_sort(top_objects_.begin(), top_objects_.begin() + n,
+                    top_objects_.end(), MoreObjectConflicts);
+  top_objects_.resize(n);
+}
+
+bool Analyzer::Analyze(const byte *data, size_t size) {
+  if (!SplitChunks(data, size))
+    return false;
+  Scan();
+  Decode();
+  BuildNameTable();
+  AnalyzeShards();
+  return true;
+}
+
+std::string Analyzer::PrintName(int64_t key) const {
+  char buffer[16];
+  if (IsIndexKey(key)) {
+    snprintf(buffer, sizeof(buffer), "[%u]",
+             static_cast<uint32_t>(key - kIndexKeyBase));
+    return buffer;
+  }
+  if (key == kUnknownKey)
+    return ".?";
+  if (key == kArrayKey)
+    return "[*]";
+  return "." + names_[key];
+}
+
+void Analyzer::Summarize(EventRacerTraceSummary *summary) const {
+  summary->chunks = static_cast<int>(chunks_.size());
+  summary->malformed_chunks = malformed_chunks_;
+  summary->resets = resets_;
+  summary->events = events_;
+  summary->op_counts.assign(op_counts_, op_counts_ + kOpCount);
+  summary->segments = segments_;
+  summary->accesses = accesses_;
+  summary->locations = locations_;
+  summary->objects = objects_;
+  summary->conflicts = conflicts_;
+  summary->conflict_locations = conflict_locations_;
+
+  summary->top_locations.clear();
+  for (size_t i = 0; i < top_locations_.size(); ++i) {
+    const LocationSummary &loc = top_locations_[i];
+    EventRacerTraceSummary::Location l = {
+      loc.obj, PrintName(loc.key), loc.reads, loc.writes, loc.conflicts,
+      loc.first_seq, loc.first_write, loc.second_seq, loc.second_write
+    };
+    summary->top_locations.push_back(l);
+  }
+  summary->top_objects.clear();
+  for (size_t i = 0; i < top_objects_.size(); ++i) {
+    const ObjectSummary &obj = top_objects_[i];
+    EventRacerTraceSummary::Object o = {
+      obj.obj, obj.locations, obj.reads, obj.writes, obj.conflicts
+    };
+    summary->top_objects.push_back(o);
+  }
+}
+
+}  // namespace
+
+bool AnalyzeEventRacerTrace(v8::Platform *platform, int threads, int shards,
+                            int top, const byte *data, size_t size,
+                            EventRacerTraceSummary *summary) {
+  Analyzer analyzer(platform, Max(threads, 1), Max(shards, 1), Max(top, 0));
+  if (!analyzer.Analyze(data, size))
+    return false;
+  analyzer.Summarize(summary);
+  return true;
+}
+
+static const char *AccessKind(bool write) { return write ? "write" : "read"; }
+
+void PrintEventRacerTraceSummary(FILE *out, const char *file_name,
+                                 const EventRacerTraceSummary &summary) {
+  fprintf(out, "ER trace %s\n", file_name);
+  fprintf(out, "  chunks: %d, malformed: %d, resets: %d\n", summary.chunks,
+          summary.malformed_chunks, summary.resets);
+  fprintf(out, "  events: %lld\n", static_cast<long long>(summary.events));
+  for (int op = 1; op < kOpCount; ++op) {
+    if (summary.op_counts[op] > 0)
+      fprintf(out, "    %-14s %lld\n", kOpNames[op],
+              static_cast<long long>(summary.op_counts[op]));
+  }
+  fprintf(out, "  segments: %lld\n", static_cast<long long>(summary.segments));
+  fprintf(out, "  accesses: %lld to %lld locations of %lld objects\n",
+          static_cast<long long>(summary.accesses),
+          static_cast<long long>(summary.locations),
+          static_cast<long long>(summary.objects));
+  fprintf(out, "  conflicting pairs: %lld at %lld locations\n",
+          static_cast<long long>(summary.conflicts),
+          static_cast<long long>(summary.conflict_locations));
+
+  if (!summary.top_locations.empty())
+    fprintf(out, "\nLocations by conflicts:\n");
+  for (size_t i = 0; i < summary.top_locations.size(); ++i) {
+    const EventRacerTraceSummary::Location &loc = summary.top_locations[i];
+    fprintf(out,
+            "  %d%s: %lld conflicts, %lld reads, %lld writes,"
+            " first %s #%lld vs %s #%lld\n",
+            loc.obj, loc.name.c_str(), static_cast<long long>(loc.conflicts),
+            static_cast<long long>(loc.reads),
+            static_cast<long long>(loc.writes), AccessKind(loc.first_write),
+            static_cast<long long>(loc.first_seq), AccessKind(loc.second_write),
+            static_cast<long long>(loc.second_seq));
+  }
+
+  if (!summary.top_objects.empty())
+    fprintf(out, "\nObjects by conflicts:\n");
+  for (size_t i = 0; i < summary.top_objects.size(); ++i) {
+    const EventRacerTraceSummary::Object &obj = summary.top_objects[i];
+    fprintf(out,
+            "  %d: %lld conflicts, %lld locations, %lld reads, %lld writes\n",
+            obj.obj, static_cast<long long>(obj.conflicts),
+            static_cast<long long>(obj.locations),
+            static_cast<long long>(obj.reads),
+            static_cast<long long>(obj.writes));
+  }
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,71 @@
+#ifndef V8_EVENT_RACER_ANALYZER_H_
+#define V8_EVENT_RACER_ANALYZER_H_
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "include/v8-platform.h"
+#include "src/globals.h"
+
+namespace v8 {
+namespace internal {
+
+// Result of the offline analysis of a binary ER trace, see
+// |AnalyzeEventRacerTrace|.
+struct EventRacerTraceSummary {
+  // A location with conflicting accesses.
+  struct Location {
+    int32_t obj;
+    // The name as printed, ".name" or "[index]".
+    std::string name;
+    int64_t reads;
+    int64_t writes;
+    int64_t conflicts;
+    // The first conflicting pair, by the sequence numbers of the events.
+    int64_t first_seq;
+    bool first_write;
+    int64_t second_seq;
+    bool second_write;
+  };
+
+  // An object with conflicting accesses.
+  struct Object {
+    int32_t obj;
+    int64_t locations;
+    int64_t reads;
+    int64_t writes;
+    int64_t conflicts;
+  };
+
+  int chunks;
+  int malformed_chunks;
+  int resets;
+  int64_t events;
+  // The number of events by |EventRacerLog::Op|.
+  std::vector<int64_t> op_counts;
+  int64_t segments;
+  int64_t accesses;
+  int64_t locations;
+  int64_t objects;
+  int64_t conflicts;
+  int64_t conflict_locations;
+  // At most |top| of each, the ones with the most conflicts first.
+  std::vector<Location> top_locations;
+  std::vector<Object> top_objects;
+};
+
+// Analyzes the trace of |size| bytes at |data| on |threads| worker threads
+// of |platform|, with the accesses split in |shards| shards by object.
+// Returns false if the data is not an ER trace.
+bool AnalyzeEventRacerTrace(v8::Platform *platform, int threads, int shards,
+                            int top, const byte *data, size_t size,
+                            EventRacerTraceSummary *summary);
+
+void PrintEventRacerTraceSummary(FILE *out, const char *file_name,
+                                 const EventRacerTraceSummary &summary);
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_ANALYZER_H_
@@ -0,0 +1,269 @@
+#include "src/v8.h"
+
+#include "src/event-racer-detector.h"
+#include "src/event-racer-log.h"
+
+namespace v8 {
+namespace internal {
+
+static uint32_t EventIdHash(int event_id) {
+  return ComputeIntegerHash(static_cast<uint32_t>(event_id),
+                            v8::internal::kZeroHashSeed);
+}
+
+static void *EventIdKey(int event_id) {
+  return reinterpret_cast<void*>(static_cast<intptr_t>(event_id));
+}
+
+static uint32_t LocationHash(int32_t obj, int32_t name) {
+  return ComputeLongHash((static_cast<uint64_t>(static_cast<uint32_t>(obj))
+                          << 32) | static_cast<uint32_t>(name));
+}
+
+bool EventRacerDetector::LocationsMatch(void *key1, void *key2) {
+  Location *a = reinterpret_cast<Location*>(key1);
+  Location *b = reinterpret_cast<Location*>(key2);
+  return a->obj == b->obj && a->name == b->name;
+}
+
+EventRacerDetector::EventRacerDetector(const EventRacerLog *log)
+  : log_(log),
+    isolate_(NULL),
+    callback_(NULL),
+    event_map_(HashMap::PointersMatch),
+    current_event_(-1),
+    current_clock_(NULL),
+    locations_(LocationsMatch),
+    race_count_(0) {
+  current_.event = -1;
+  current_.chain = -1;
+  current_.position = 0;
+}
+
+EventRacerDetector::~EventRacerDetector() {
+  ClearShadowMemory();
+  for (int i = 0; i < events_.length(); ++i) {
+    delete events_[i].clock;
+    delete events_[i].preds;
+  }
+}
+
+EventRacerDetector::EventState *EventRacerDetector::FindEvent(int event_id) {
+  HashMap::Entry *e =
+      event_map_.Lookup(EventIdKey(event_id), EventIdHash(event_id), false);
+  if (e == NULL)
+    return NULL;
+  return &events_[static_cast<int>(reinterpret_cast<intptr_t>(e->value)) - 1];
+}
+
+// The returned pointer is valid until the next event is added.
+EventRacerDetector::EventState *EventRacerDetector::FindOrAddEvent(
+    int event_id) {
+  HashMap::Entry *e =
+      event_map_.Lookup(EventIdKey(event_id), EventIdHash(event_id), true);
+  if (e->value == NULL) {
+    // The value is the index plus one, as NULL denotes a new entry.
+    EventState state = { -1, -1, NULL, NULL };
+    events_.Add(state);
+    e->value = reinterpret_cast<void*>(static_cast<intptr_t>(events_.length()));
+  }
+  return &events_[static_cast<int>(reinterpret_cast<intptr_t>(e->value)) - 1];
+}
+
+void EventRacerDetector::AddArc(int from, int to) {
+  FindOrAddEvent(from);
+  EventState *state = FindOrAddEvent(to);
+  // An arc into an action, which has already begun, cannot change its
+  // clock.
+  if (state->clock != NULL)
+    return;
+  if (state->preds == NULL)
+    state->preds = new List<int32_t>(2);
+  state->preds->Add(from);
+}
+
+void EventRacerDetector::BeginEvent(int event_id) {
+  EndEvent();
+  EventState *state = FindOrAddEvent(event_id);
+  if (state->clock == NULL) {
+    List<int32_t> *clock = new List<int32_t>(chain_count() + 1);
+    int32_t chain = -1;
+    const int npreds = state->preds == NULL ? 0 : state->preds->length();
+    for (int i = 0; i < npreds; ++i) {
+      EventState *pred = FindEvent(state->preds->at(i));
+      // Predecessors, which have not run, do not order anything.
+      if (pred == NULL || pred->clock == NULL)
+        continue;
+      if (chain < 0 && pred->position == chain_lengths_[pred->chain])
+        chain = pred->chain;
+      for (int j = 0; j < pred->clock->length(); ++j) {
+        if (j == clock->length())
+          clock->Add(0);
+        clock->at(j) = Max(clock->at(j), pred->clock->at(j));
+      }
+    }
+    if (chain < 0) {
+      chain = chain_count();
+      chain_lengths_.Add(0);
+    }
+    while (clock->length() <= chain)
+      clock->Add(0);
+    clock->at(chain) = ++chain_lengths_[chain];
+
+    delete state->preds;
+    state->preds = NULL;
+    state->chain = chain;
+    state->position = clock->at(chain);
+    state->clock = clock;
+  }
+
+  current_event_ = event_id;
+  current_.event = event_id;
+  current_.chain = state->chain;
+  current_.position = state->position;
+  current_clock_ = state->clock;
+}
+
+void EventRacerDetector::EndEvent() {
+  current_event_ = -1;
+  current_.event = -1;
+  current_clock_ = NULL;
+}
+
+EventRacerDetector::Location *EventRacerDetector::FindOrAddLocation(
+    int32_t obj, int32_t name) {
+  Location key;
+  key.obj = obj;
+  key.name = name;
+  HashMap::Entry *e = locations_.Lookup(&key, LocationHash(obj, name), true);
+  if (e->value == NULL) {
+    Location *loc = new Location;
+    loc->obj = obj;
+    loc->name = name;
+    loc->write.event = -1;
+    loc->reported_event = -1;
+    loc->array = NULL;
+    loc->elements = NULL;
+    e->key = loc;
+    e->value = loc;
+    // Variables have no object and no whole-array location.
+    if (obj != 0 && name != 0) {
+      Location *array = FindOrAddLocation(obj, 0);
+      if (array->elements == NULL)
+        array->elements = new List<Location*>(4);
+      array->elements->Add(loc);
+      loc->array = array;
+    }
+    return loc;
+  }
+  return reinterpret_cast<Location*>(e->value);
+}
+
+void EventRacerDetector::ClearShadowMemory() {
+  for (HashMap::Entry *p = locations_.Start(); p != NULL;
+       p = locations_.Next(p)) {
+    Location *loc = reinterpret_cast<Location*>(p->value);
+    delete loc->elements;
+    delete loc;
+  }
+  locations_.Clear();
+}
+
+// Returns true if the access |access| happens before the current one.
+bool EventRacerDetector::HappensBefore(const AccessInfo &access) const {
+  if (access.event == current_event_)
+    return true;
+  return access.chain < current_clock_->length() &&
+         access.position <= current_clock_->at(access.chain);
+}
+
+void EventRacerDetector::Check(Location *loc, const AccessInfo &prior,
+                               bool prior_is_write, bool is_write) {
+  if (prior.event < 0 || HappensBefore(prior) ||
+      loc->reported_event == current_event_)
+    return;
+  loc->reported_event = current_event_;
+  ++race_count_;
+
+  const char *name = log_->name(loc->name);
+  if (callback_ == NULL) {
+    PrintF("ER race on %d.%s between event %d (%s) and event %d (%s)\n",
+           loc->obj, name, prior.event, prior_is_write ? "write" : "read",
+           current_event_, is_write ? "write" : "read");
+    return;
+  }
+  v8::EventRacerRace race;
+  race.first_event = prior.event;
+  race.first_access =
+      prior_is_write ? v8::EventRacerRace::kWrite : v8::EventRacerRace::kRead;
+  race.second_event = current_event_;
+  race.second_access =
+      is_write ? v8::EventRacerRace::kWrite : v8::EventRacerRace::kRead;
+  race.object_id = loc->obj;
+  race.name = name;
+  callback_(isolate_, &race);
+}
+
+// Checks the current access of |loc| against the accesses of the location
+// |prior|, which the current access does not supersede.
+void EventRacerDetector::CheckAll(Location *loc, const Location *prior,
+                                  bool is_write) {
+  Check(loc, prior->write, true, is_write);
+  if (!is_write)
+    return;
+  for (int i = 0; i < prior->reads.length(); ++i)
+    Check(loc, prior->reads[i], false, true);
+}
+
+void EventRacerDetector::Access(int op, int32_t obj, int32_t name) {
+  if (current_event_ < 0)
+    return;
+
+  bool is_write;
+  switch (op) {
+    case EventRacerLog::kRead:
+    case EventRacerLog::kReadProp:
+    case EventRacerLog::kReadArray:
+      is_write = false;
+      break;
+    case EventRacerLog::kWrite:
+    case EventRacerLog::kWriteProp:
+    case EventRacerLog::kWriteFunc:
+    case EventRacerLog::kWritePropFunc:
+    case EventRacerLog::kWriteArray:
+    case EventRacerLog::kDelete:
+    case EventRacerLog::kDeleteProp:
+      is_write = true;
+      break;
+    default:
+      return;
+  }
+
+  Location *loc = FindOrAddLocation(obj, name);
+  CheckAll(loc, loc, is_write);
+  if (loc->array != NULL) {
+    CheckAll(loc, loc->array, is_write);
+  } else if (loc->elements != NULL) {
+    for (int i = 0; i < loc->elements->length() &&
+                    loc->reported_event != current_event_; ++i)
+      CheckAll(loc, loc->elements->at(i), is_write);
+  }
+
+  if (is_write) {
+    loc->write = current_;
+    loc->reads.Clear();
+    return;
+  }
+
+  // A read supersedes the earlier reads in the same chain, as they happen
+  // before it.
+  for (int i = 0; i < loc->reads.length(); ++i) {
+    if (loc->reads[i].chain == current_.chain) {
+      loc->reads[i] = current_;
+      return;
+    }
+  }
+  loc->reads.Add(current_);
+}
+
+} }  // namespace v8::internal
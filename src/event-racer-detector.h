@@ -0,0 +1,144 @@
+#ifndef V8_EVENT_RACER_DETECTOR_H_
+#define V8_EVENT_RACER_DETECTOR_H_
+
+#include "include/v8.h"
+#include "src/allocation.h"
+#include "src/hashmap.h"
+#include "src/list.h"
+
+namespace v8 {
+namespace internal {
+
+class EventRacerLog;
+
+// Online happens-before race detector, fed with the events of the
+// |EventRacerLog|.
+//
+// The embedder runs the JS code in event actions, delimited by
+// |BeginEvent| and |EndEvent|, and declares the happens-before order
+// between them with |AddArc|, e.g. from the action, which sets a timer, to
+// the action, which runs the timer callback. Two accesses to the same
+// location race if they are in different event actions, which are not
+// ordered by happens-before, and at least one of them is a write.
+//
+// The happens-before relation is represented with vector clocks over a
+// chain decomposition of the event actions: an action extends the chain of
+// one of its immediate predecessors, if that predecessor is the last
+// action in its chain, otherwise it starts a new chain. Action |a|
+// happens before action |b| iff the position of |a| in its chain is not
+// greater than the entry of that chain in the clock of |b|.
+//
+// The shadow memory keeps, for each location, i.e. an (object id, name)
+// pair, the last write and the last read in each chain since that write.
+// Races are reported through the callback as they are found, at most once
+// per location and event action.
+//
+// The accesses of a whole array, e.g. by the array builtins, have no name
+// and touch every location of the object, the elements as well as the
+// |length|. They are kept in a location of their own, which is checked
+// against the other locations of the object, and the other way around. A
+// race of a whole-array access is reported on that location.
+class EventRacerDetector {
+public:
+  explicit EventRacerDetector(const EventRacerLog *log);
+  ~EventRacerDetector();
+
+  // Sets the race callback of the embedder. With no callback, the races
+  // are printed on stdout.
+  void set_callback(v8::Isolate *isolate, v8::EventRacerRaceCallback cb) {
+    isolate_ = isolate;
+    callback_ = cb;
+  }
+
+  // Starts the event action |event_id|, ending the current one, if any.
+  // The accesses outside of event actions are not checked.
+  void BeginEvent(int event_id);
+  void EndEvent();
+
+  bool in_event() const { return current_event_ >= 0; }
+
+  // Orders the event action |from| before the event action |to|, which
+  // has not begun yet.
+  void AddArc(int from, int to);
+
+  // Checks the access |op| of the location (|obj|, |name|), see
+  // |EventRacerLog::Op|.
+  void Access(int op, int32_t obj, int32_t name);
+
+  // Forgets the accessed locations. Called when the log is reset, as the
+  // object identifiers and the name indices are reused afterwards.
+  void ClearShadowMemory();
+
+  int race_count() const { return race_count_; }
+  int chain_count() const { return chain_lengths_.length(); }
+
+private:
+  struct EventState {
+    // Chain and 1-based position in it, -1 until the action begins.
+    int32_t chain;
+    int32_t position;
+    // Vector clock, indexed by chain, NULL until the action begins.
+    // Chains past its end have a zero entry.
+    List<int32_t> *clock;
+    // Immediate predecessors, NULL after the action begins.
+    List<int32_t> *preds;
+  };
+
+  struct AccessInfo {
+    int32_t event;
+    int32_t chain;
+    int32_t position;
+  };
+
+  struct Location {
+    int32_t obj;
+    int32_t name;
+    AccessInfo write;
+    // The last read in each chain since the last write.
+    List<AccessInfo> reads;
+    // The event action, in which a race on this location was last reported.
+    int32_t reported_event;
+    // The whole-array location of the object, NULL for the whole-array
+    // location itself and the variables.
+    Location *array;
+    // The other locations of the object, for the whole-array location,
+    // NULL otherwise.
+    List<Location*> *elements;
+  };
+
+  static bool LocationsMatch(void *key1, void *key2);
+
+  EventState *FindEvent(int event_id);
+  EventState *FindOrAddEvent(int event_id);
+  Location *FindOrAddLocation(int32_t obj, int32_t name);
+  bool HappensBefore(const AccessInfo &access) const;
+  void Check(Location *loc, const AccessInfo &prior, bool prior_is_write,
+             bool is_write);
+  void CheckAll(Location *loc, const Location *prior, bool is_write);
+
+  const EventRacerLog *log_;
+  v8::Isolate *isolate_;
+  v8::EventRacerRaceCallback callback_;
+
+  // Event identifier to index into |events_|.
+  HashMap event_map_;
+  List<EventState> events_;
+  // Number of event actions in each chain.
+  List<int32_t> chain_lengths_;
+
+  // The current event action, -1 outside of event actions.
+  int32_t current_event_;
+  AccessInfo current_;
+  List<int32_t> *current_clock_;
+
+  // Location to itself.
+  HashMap locations_;
+
+  int race_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRacerDetector);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_DETECTOR_H_
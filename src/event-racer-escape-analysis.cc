@@ -0,0 +1,309 @@
+#include "src/v8.h"
+
+#include "src/event-racer-escape-analysis.h"
+#include "src/scopes.h"
+
+namespace v8 {
+namespace internal {
+
+typedef EventRacerEscapeAnalysis EREA;  // for brevity.
+
+EREA::EventRacerEscapeAnalysis(Zone *zone, uintptr_t stack_limit)
+  : vars_(ZoneHashMap::PointersMatch, ZoneHashMap::kDefaultHashMapCapacity,
+          ZoneAllocationPolicy(zone)) {
+  InitializeAstVisitor(zone, stack_limit);
+}
+
+void EREA::Analyze(FunctionLiteral *fn) {
+  VisitDeclarations(fn->scope()->declarations());
+  if (fn->body() != NULL)
+    VisitStatements(fn->body());
+}
+
+bool EREA::IsLocalObject(Expression *expr) {
+  // A literal, which is used directly as the object of a property access,
+  // cannot have been seen by anyone else.
+  if (IsFreshLiteral(expr))
+    return true;
+  VariableProxy *vp = expr->AsVariableProxy();
+  if (vp == NULL || !IsTracked(vp->var()))
+    return false;
+  Variable *var = vp->var();
+  ZoneHashMap::Entry *e =
+      vars_.Lookup(var, ComputePointerHash(var), false,
+                   ZoneAllocationPolicy(zone()));
+  return e != NULL && e->value == reinterpret_cast<void*>(kCandidate);
+}
+
+bool EREA::IsFreshLiteral(Expression *expr) {
+  if (expr->IsArrayLiteral())
+    return true;
+  ObjectLiteral *lit = expr->AsObjectLiteral();
+  if (lit == NULL)
+    return false;
+  // Accessors get the object as their receiver, so does the prototype.
+  ZoneList<ObjectLiteralProperty*> *props = lit->properties();
+  for (int i = 0; i < props->length(); ++i) {
+    ObjectLiteralProperty::Kind kind = props->at(i)->kind();
+    if (kind == ObjectLiteralProperty::GETTER ||
+        kind == ObjectLiteralProperty::SETTER ||
+        kind == ObjectLiteralProperty::PROTOTYPE)
+      return false;
+  }
+  return true;
+}
+
+bool EREA::IsTracked(Variable *var) {
+  return var != NULL && var->IsStackLocal();
+}
+
+void EREA::Assign(Variable *var, Expression *value) {
+  if (!IsTracked(var))
+    return;
+  if (value == NULL || !IsFreshLiteral(value)) {
+    Escape(var);
+    return;
+  }
+  ZoneHashMap::Entry *e = vars_.Lookup(var, ComputePointerHash(var), true,
+                                       ZoneAllocationPolicy(zone()));
+  if (e->value == NULL)
+    e->value = reinterpret_cast<void*>(kCandidate);
+}
+
+void EREA::Escape(Variable *var) {
+  if (!IsTracked(var))
+    return;
+  ZoneHashMap::Entry *e = vars_.Lookup(var, ComputePointerHash(var), true,
+                                       ZoneAllocationPolicy(zone()));
+  e->value = reinterpret_cast<void*>(kEscaped);
+}
+
+// Visits a property access, where the object does not escape.
+void EREA::VisitPropertyAccess(Property *p) {
+  if (!p->obj()->IsVariableProxy())
+    Visit(p->obj());
+  Visit(p->key());
+}
+
+// ---------------------------------------------------------------------------
+// -- Uses and definitions ---------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void EREA::VisitVariableProxy(VariableProxy *vp) {
+  // Any reference, not handled by the visitors of the enclosing node, is
+  // an escape.
+  Escape(vp->var());
+}
+
+void EREA::VisitProperty(Property *p) {
+  VisitPropertyAccess(p);
+}
+
+void EREA::VisitCall(Call *c) {
+  // The object of a method call escapes as the receiver.
+  Property *p = c->expression()->AsProperty();
+  if (p != NULL) {
+    Visit(p->obj());
+    Visit(p->key());
+  } else {
+    Visit(c->expression());
+  }
+  VisitExpressions(c->arguments());
+}
+
+void EREA::VisitAssignment(Assignment *op) {
+  VariableProxy *vp = op->target()->AsVariableProxy();
+  if (vp != NULL) {
+    Assign(vp->var(), op->is_compound() ? NULL : op->value());
+  } else {
+    DCHECK(op->target()->IsProperty());
+    VisitPropertyAccess(op->target()->AsProperty());
+  }
+  Visit(op->value());
+}
+
+void EREA::VisitCountOperation(CountOperation *op) {
+  VariableProxy *vp = op->expression()->AsVariableProxy();
+  if (vp != NULL) {
+    Escape(vp->var());
+  } else {
+    DCHECK(op->expression()->IsProperty());
+    VisitPropertyAccess(op->expression()->AsProperty());
+  }
+}
+
+void EREA::VisitUnaryOperation(UnaryOperation *op) {
+  Property *p = op->expression()->AsProperty();
+  if (op->op() == Token::DELETE && p != NULL)
+    VisitPropertyAccess(p);
+  else
+    Visit(op->expression());
+}
+
+void EREA::VisitForInStatement(ForInStatement *st) {
+  Visit(st->each());
+  Visit(st->subject());
+  Visit(st->body());
+}
+
+void EREA::VisitForOfStatement(ForOfStatement *st) {
+  Visit(st->each());
+  Visit(st->subject());
+  Visit(st->body());
+}
+
+void EREA::VisitTryCatchStatement(TryCatchStatement *st) {
+  Visit(st->try_block());
+  Escape(st->variable());
+  Visit(st->catch_block());
+}
+
+void EREA::VisitFunctionDeclaration(FunctionDeclaration *dcl) {
+  Escape(dcl->proxy()->var());
+}
+
+// ---------------------------------------------------------------------------
+// -- Leaf nodes -------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void EREA::VisitVariableDeclaration(VariableDeclaration *dcl) {}
+void EREA::VisitModuleDeclaration(ModuleDeclaration *dcl) {}
+void EREA::VisitImportDeclaration(ImportDeclaration *dcl) {}
+void EREA::VisitExportDeclaration(ExportDeclaration *dcl) {}
+void EREA::VisitModuleVariable(ModuleVariable *leaf) {}
+void EREA::VisitModulePath(ModulePath *leaf) {}
+void EREA::VisitModuleUrl(ModuleUrl *leaf) {}
+void EREA::VisitEmptyStatement(EmptyStatement *leaf) {}
+void EREA::VisitContinueStatement(ContinueStatement *leaf) {}
+void EREA::VisitBreakStatement(BreakStatement *leaf) {}
+void EREA::VisitDebuggerStatement(DebuggerStatement *leaf) {}
+void EREA::VisitFunctionLiteral(FunctionLiteral *leaf) {}
+void EREA::VisitNativeFunctionLiteral(NativeFunctionLiteral *leaf) {}
+void EREA::VisitLiteral(Literal *leaf) {}
+void EREA::VisitRegExpLiteral(RegExpLiteral *leaf) {}
+void EREA::VisitThisFunction(ThisFunction *leaf) {}
+void EREA::VisitSuperReference(SuperReference *leaf) {}
+
+// ---------------------------------------------------------------------------
+// -- Pass-through nodes -----------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void EREA::VisitModuleLiteral(ModuleLiteral *e) {
+  Visit(e->body());
+}
+
+void EREA::VisitModuleStatement(ModuleStatement *st) {
+  Visit(st->body());
+}
+
+void EREA::VisitBlock(Block *st) {
+  VisitStatements(st->statements());
+}
+
+void EREA::VisitExpressionStatement(ExpressionStatement *st) {
+  Visit(st->expression());
+}
+
+void EREA::VisitIfStatement(IfStatement *st) {
+  Visit(st->condition());
+  Visit(st->then_statement());
+  Visit(st->else_statement());
+}
+
+void EREA::VisitReturnStatement(ReturnStatement *st) {
+  Visit(st->expression());
+}
+
+void EREA::VisitWithStatement(WithStatement *st) {
+  Visit(st->expression());
+  Visit(st->statement());
+}
+
+void EREA::VisitSwitchStatement(SwitchStatement *st) {
+  Visit(st->tag());
+  ZoneList<CaseClause*> *clauses = st->cases();
+  for (int i = 0; i < clauses->length(); ++i)
+    Visit(clauses->at(i));
+}
+
+void EREA::VisitCaseClause(CaseClause *cc) {
+  if (!cc->is_default())
+    Visit(cc->label());
+  VisitStatements(cc->statements());
+}
+
+void EREA::VisitDoWhileStatement(DoWhileStatement *st) {
+  Visit(st->body());
+  Visit(st->cond());
+}
+
+void EREA::VisitWhileStatement(WhileStatement *st) {
+  Visit(st->cond());
+  Visit(st->body());
+}
+
+void EREA::VisitForStatement(ForStatement *st) {
+  VisitIfNotNull(st->init());
+  VisitIfNotNull(st->cond());
+  Visit(st->body());
+  VisitIfNotNull(st->next());
+}
+
+void EREA::VisitTryFinallyStatement(TryFinallyStatement *st) {
+  Visit(st->try_block());
+  Visit(st->finally_block());
+}
+
+void EREA::VisitClassLiteral(ClassLiteral *e) {
+  VisitIfNotNull(e->extends());
+  Visit(e->constructor());
+  ZoneList<ObjectLiteralProperty*> *props = e->properties();
+  for (int i = 0; i < props->length(); ++i)
+    Visit(props->at(i)->value());
+}
+
+void EREA::VisitConditional(Conditional *e) {
+  Visit(e->condition());
+  Visit(e->then_expression());
+  Visit(e->else_expression());
+}
+
+void EREA::VisitObjectLiteral(ObjectLiteral *e) {
+  ZoneList<ObjectLiteralProperty*> *props = e->properties();
+  for (int i = 0; i < props->length(); ++i)
+    Visit(props->at(i)->value());
+}
+
+void EREA::VisitArrayLiteral(ArrayLiteral *e) {
+  VisitExpressions(e->values());
+}
+
+void EREA::VisitYield(Yield *e) {
+  Visit(e->generator_object());
+  Visit(e->expression());
+}
+
+void EREA::VisitThrow(Throw *e) {
+  Visit(e->exception());
+}
+
+void EREA::VisitCallNew(CallNew *e) {
+  Visit(e->expression());
+  VisitExpressions(e->arguments());
+}
+
+void EREA::VisitCallRuntime(CallRuntime *e) {
+  VisitExpressions(e->arguments());
+}
+
+void EREA::VisitBinaryOperation(BinaryOperation *e) {
+  Visit(e->left());
+  Visit(e->right());
+}
+
+void EREA::VisitCompareOperation(CompareOperation *e) {
+  Visit(e->left());
+  Visit(e->right());
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,61 @@
+#ifndef V8_EVENT_RACER_ESCAPE_ANALYSIS_H_
+#define V8_EVENT_RACER_ESCAPE_ANALYSIS_H_
+
+#include "src/ast.h"
+#include "src/zone.h"
+
+namespace v8 {
+namespace internal {
+
+// Finds the local variables of a function, which hold objects that are
+// not accessible outside of the function activation, so the ER
+// instrumentation can skip the accesses to their properties.
+//
+// The analysis is flow-insensitive and conservative. A variable holds a
+// thread-local object if it is a stack allocated local (so it is not
+// captured by a closure, an |eval| or a |with| statement), each value
+// assigned to it is a fresh object or array literal without accessors or
+// |__proto__|, and each reference to it is the object of a property
+// access. Any other use, e.g. passing it as an argument, storing it,
+// returning it or calling a method on it, lets the object escape.
+//
+// Must be run after the scope analysis, on the unmodified AST.
+class EventRacerEscapeAnalysis : public AstVisitor {
+public:
+  explicit EventRacerEscapeAnalysis(Zone *zone, uintptr_t stack_limit = 0);
+
+  // Analyzes the body of |fn|. Nested function literals are not entered,
+  // as they cannot refer to stack allocated variables of |fn|.
+  void Analyze(FunctionLiteral *fn);
+
+  // Returns true if |expr| evaluates to an object, which is not reachable
+  // from outside of the analyzed function activation.
+  bool IsLocalObject(Expression *expr);
+
+#define DECLARE_VISIT(type) void Visit##type(type *node) OVERRIDE;
+  AST_NODE_LIST(DECLARE_VISIT)
+#undef DECLARE_VISIT
+
+private:
+  enum State { kCandidate = 1, kEscaped = 2 };
+
+  static bool IsFreshLiteral(Expression *expr);
+  static bool IsTracked(Variable *var);
+
+  void Assign(Variable *var, Expression *value);
+  void Escape(Variable *var);
+  void VisitPropertyAccess(Property *p);
+  void VisitIfNotNull(AstNode *node) {
+    if (node != NULL)
+      Visit(node);
+  }
+
+  ZoneHashMap vars_;
+
+  DEFINE_AST_VISITOR_SUBCLASS_MEMBERS();
+  DISALLOW_COPY_AND_ASSIGN(EventRacerEscapeAnalysis);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_ESCAPE_ANALYSIS_H_
@@ -0,0 +1,829 @@
+#include <cmath>
+#include <sstream>
+
+#include "src/v8.h"
+
+#include "src/base/bits.h"
+#include "src/base/platform/mutex.h"
+#include "src/conversions.h"
+#include "src/deoptimizer.h"
+#include "src/event-racer-detector.h"
+#include "src/event-racer-log.h"
+#include "src/event-racer-trace.h"
+#include "src/frames-inl.h"
+#include "src/log-utils.h"
+#include "src/log.h"
+#include "src/optimizing-compiler-thread.h"
+#include "src/v8threads.h"
+
+namespace v8 {
+namespace internal {
+
+// Names longer than this are truncated when interned.
+static const int kMaxNameSize = 1024;
+
+// The process-wide sequence counter, shared by the logs of all the
+// isolates. The 32-bit hosts lack the 64-bit atomic operations, so the
+// counter is guarded by a mutex there.
+#ifdef V8_HOST_ARCH_64_BIT
+static base::Atomic64 event_sequence = 0;
+
+uint64_t EventRacerLog::NextSequence() {
+  return static_cast<uint64_t>(
+      base::NoBarrier_AtomicIncrement(&event_sequence, 1));
+}
+#else
+static base::LazyMutex event_sequence_mutex = LAZY_MUTEX_INITIALIZER;
+static uint64_t event_sequence = 0;
+
+uint64_t EventRacerLog::NextSequence() {
+  base::LockGuard<base::Mutex> lock(event_sequence_mutex.Pointer());
+  return ++event_sequence;
+}
+#endif
+
+bool EventRacerLog::StringsMatch(void *key1, void *key2) {
+  return strcmp(reinterpret_cast<char*>(key1),
+                reinterpret_cast<char*>(key2)) == 0;
+}
+
+namespace {
+
+// Key of |EventRacerLog::site_ids_|.
+struct SiteKey {
+  int script_id;
+  int kind;
+  int position;
+};
+
+uint32_t SiteKeyHash(const SiteKey &key) {
+  uint32_t hash = ComputeIntegerHash(static_cast<uint32_t>(key.script_id),
+                                     v8::internal::kZeroHashSeed);
+  hash ^= ComputeIntegerHash(static_cast<uint32_t>(key.position),
+                             v8::internal::kZeroHashSeed);
+  return hash + static_cast<uint32_t>(key.kind);
+}
+
+}  // namespace
+
+bool EventRacerLog::SiteKeysMatch(void *key1, void *key2) {
+  SiteKey *a = reinterpret_cast<SiteKey*>(key1);
+  SiteKey *b = reinterpret_cast<SiteKey*>(key2);
+  return a->script_id == b->script_id && a->kind == b->kind &&
+         a->position == b->position;
+}
+
+static uint32_t FunctionIdHash(int fn_id) {
+  return ComputeIntegerHash(static_cast<uint32_t>(fn_id),
+                            v8::internal::kZeroHashSeed);
+}
+
+static void *FunctionIdKey(int fn_id) {
+  return reinterpret_cast<void*>(static_cast<intptr_t>(fn_id));
+}
+
+EventRacerLog::EventRacerLog(Isolate *isolate)
+  : isolate_(isolate),
+    enable_count_(0),
+    buffer_(NULL),
+    capacity_(0),
+    written_(0),
+    name_map_(StringsMatch),
+    index_names_(HashMap::PointersMatch),
+    collection_(0),
+    next_site_id_(0),
+    site_names_(StringsMatch),
+    site_ids_(SiteKeysMatch),
+    function_map_(HashMap::PointersMatch),
+    epoch_(0),
+    trace_(NULL),
+    detector_(NULL) {
+  for (int i = 0; i < kReadCacheSize; ++i)
+    read_cache_[i].site = 0;
+  if (FLAG_er_detect_races)
+    detector_ = new EventRacerDetector(this);
+  Reset();
+}
+
+EventRacerLog::~EventRacerLog() {
+  delete detector_;
+  delete trace_;
+  DeleteArray(buffer_);
+  for (int i = 0; i < names_.length(); ++i)
+    DeleteArray(names_[i]);
+  for (HashMap::Entry *p = site_names_.Start(); p != NULL;
+       p = site_names_.Next(p))
+    DeleteArray(reinterpret_cast<char*>(p->key));
+  for (HashMap::Entry *p = site_ids_.Start(); p != NULL;
+       p = site_ids_.Next(p))
+    delete reinterpret_cast<SiteKey*>(p->key);
+}
+
+void EventRacerLog::Reset() {
+  written_ = 0;
+  ++collection_;
+  name_map_.Clear();
+  for (int i = 0; i < names_.length(); ++i)
+    DeleteArray(names_[i]);
+  names_.Clear();
+  index_names_.Clear();
+  function_map_.Clear();
+  functions_.Clear();
+  activations_.Clear();
+  object_ids_.Clear();
+  sampler_.Reset();
+  NewEpoch();
+  if (detector_ != NULL)
+    detector_->ClearShadowMemory();
+  if (trace_ != NULL)
+    trace_->WriteReset();
+
+  // Reserve the name index zero.
+  char *empty = NewArray<char>(1);
+  empty[0] = '\0';
+  InternName(empty, 0);
+}
+
+void EventRacerLog::Enable() {
+  if (++enable_count_ != 1)
+    return;
+
+  // The buffer is allocated the first time the collection is enabled,
+  // so that isolates, which never record, do not pay for it.
+  if (buffer_ == NULL) {
+    uint32_t size = Max(FLAG_er_log_size, 1);
+    capacity_ = base::bits::RoundUpToPowerOfTwo32(size);
+    buffer_ = NewArray<Event>(static_cast<size_t>(capacity_));
+    OpenTrace();
+  }
+  // The sampling flags may have changed since the last collection.
+  sampler_.ConfigureFromFlags();
+  Reset();
+}
+
+int EventRacerLog::Disable() {
+  // Write out the events of the finished collection, so a trace of
+  // a short recording window does not linger in a partial chunk.
+  if (--enable_count_ == 0 && trace_ != NULL)
+    trace_->Flush();
+  return enable_count_;
+}
+
+void EventRacerLog::OpenTrace() {
+  if (FLAG_er_trace == NULL || FLAG_er_trace[0] == '\0')
+    return;
+  trace_ = new EventRacerTrace();
+  bool ok;
+  if (strcmp(FLAG_er_trace, Log::kLogToTemporaryFile) == 0) {
+    ok = trace_->Open(FLAG_er_trace, FLAG_er_trace_chunk_size);
+  } else {
+    std::ostringstream file_name;
+    Logger::PrepareLogFileName(file_name, isolate_, FLAG_er_trace);
+    ok = trace_->Open(file_name.str().c_str(), FLAG_er_trace_chunk_size);
+  }
+  if (!ok) {
+    base::OS::PrintError("Cannot open the ER trace file %s\n", FLAG_er_trace);
+    delete trace_;
+    trace_ = NULL;
+  }
+}
+
+FILE *EventRacerLog::CloseTrace() {
+  if (trace_ == NULL)
+    return NULL;
+  FILE *result = trace_->Close();
+  delete trace_;
+  trace_ = NULL;
+  return result;
+}
+
+void EventRacerLog::SetRaceCallback(v8::EventRacerRaceCallback callback) {
+  if (detector_ == NULL)
+    detector_ = new EventRacerDetector(this);
+  detector_->set_callback(reinterpret_cast<v8::Isolate*>(isolate_), callback);
+}
+
+int EventRacerLog::length() const {
+  return static_cast<int>(Min(written_, capacity_));
+}
+
+const EventRacerLog::Event &EventRacerLog::at(int i) const {
+  DCHECK(i >= 0 && i < length());
+  uint64_t seq = written_ - length() + i;
+  return buffer_[seq & (capacity_ - 1)];
+}
+
+const EventRacerLog::FunctionInfo *EventRacerLog::function_info(int fn_id) {
+  if (fn_id <= 0)
+    return NULL;
+  HashMap::Entry *e =
+      function_map_.Lookup(FunctionIdKey(fn_id), FunctionIdHash(fn_id), false);
+  if (e == NULL)
+    return NULL;
+  return &functions_[static_cast<int>(reinterpret_cast<intptr_t>(e->value))];
+}
+
+void EventRacerLog::Append(Op op, int32_t obj, int32_t name, int32_t fn) {
+  DCHECK(enabled() && buffer_ != NULL);
+  Event &e = buffer_[written_++ & (capacity_ - 1)];
+  e.seq = NextSequence();
+  e.op = op;
+  e.stride = 0;
+  e.obj = obj;
+  e.name = name;
+  e.fn = fn;
+  if (trace_ != NULL)
+    trace_->WriteEvent(e.seq, op, obj, name, fn);
+  if (detector_ != NULL)
+    detector_->Access(op, obj, name);
+}
+
+void EventRacerLog::AppendRange(Op op, Handle<Object> obj,
+                                Handle<Object> start, Handle<Object> end,
+                                int stride, bool inclusive) {
+  DCHECK(stride != 0 && Abs(stride) <= kMaxRangeStride);
+  int32_t id = ObjectId(obj);
+  if (!start->IsSmi() || !end->IsNumber()) {
+    Append(op == kReadRange ? kReadArray : kWriteArray, id, 0, 0);
+    return;
+  }
+
+  // Find the last index, before |end|, which the counter reaches. Clamp it
+  // to the 32-bit range, so the loop is cut short, rather than wrap
+  // around, should the counter overflow.
+  int32_t first = Smi::cast(*start)->value();
+  double limit = end->Number();
+  double slack = inclusive ? 0 : 1;
+  if (stride > 0)
+    limit = Min(limit, static_cast<double>(kMaxInt) + slack);
+  else
+    limit = Max(limit, static_cast<double>(kMinInt) - slack);
+  double steps = (limit - first) / stride;
+  double count = inclusive ? std::floor(steps) + 1 : std::ceil(steps);
+  // Also catches a NaN |end|.
+  if (!(count > 0))
+    return;
+  int32_t last = static_cast<int32_t>(first + (count - 1) * stride);
+
+  DCHECK(enabled() && buffer_ != NULL);
+  Event &e = buffer_[written_++ & (capacity_ - 1)];
+  e.seq = NextSequence();
+  e.op = op;
+  e.stride = static_cast<int16_t>(stride);
+  e.obj = id;
+  e.name = first;
+  e.fn = last;
+  if (trace_ != NULL)
+    trace_->WriteRange(e.seq, op, id, first, last, stride);
+  if (detector_ != NULL && detector_->in_event()) {
+    // The detector keeps the elements apart, as the per-element events
+    // would. Outside of event actions, it would drop them anyway.
+    Op element_op = op == kReadRange ? kReadProp : kWriteProp;
+    for (int64_t i = first; stride > 0 ? i <= last : i >= last; i += stride)
+      detector_->Access(element_op, id, IndexNameId(static_cast<int32_t>(i)));
+  }
+}
+
+// Returns true if the event, reported from the site |site|, is to be
+// recorded.
+bool EventRacerLog::Sample(EventRacerSampler::Kind kind, int site) {
+  if (!sampler_.is_active())
+    return true;
+  return sampler_.ShouldRecord(kind, site);
+}
+
+// Returns true if the read is to be recorded. A read of the same object
+// and name at the same site in the same epoch is dropped, as it carries no
+// new information about the races of the epoch. The object and the name
+// are compared by address, so a GC invalidates the cache entries. Only
+// the recorded reads enter the cache, so the sampling does not hide the
+// later reads, which would be recorded. The reads of an unknown site, zero,
+// are not deduplicated. The whole array reads share |kArrayReadSite|, which
+// is not backed off.
+bool EventRacerLog::SampleRead(int site, Object *obj, Object *name) {
+  int sampled_site = site == kArrayReadSite ? 0 : site;
+  if (!FLAG_er_dedup_reads || site == 0)
+    return Sample(EventRacerSampler::kRead, sampled_site);
+  uint32_t hash = ComputeIntegerHash(static_cast<uint32_t>(site), 0);
+  ReadCacheEntry &entry = read_cache_[hash & (kReadCacheSize - 1)];
+  int gc_count = isolate_->heap()->gc_count();
+  if (entry.site == site && entry.obj == obj && entry.name == name &&
+      entry.epoch == epoch_ && entry.gc_count == gc_count)
+    return false;
+  if (!Sample(EventRacerSampler::kRead, sampled_site))
+    return false;
+  entry.site = site;
+  entry.obj = obj;
+  entry.name = name;
+  entry.epoch = epoch_;
+  entry.gc_count = gc_count;
+  return true;
+}
+
+void EventRacerLog::NewEpoch() {
+  ++epoch_;
+}
+
+void EventRacerLog::BeginEvent(int event_id) {
+  NewEpoch();
+  if (detector_ != NULL)
+    detector_->BeginEvent(event_id);
+}
+
+void EventRacerLog::EndEvent() {
+  NewEpoch();
+  if (detector_ != NULL)
+    detector_->EndEvent();
+}
+
+void EventRacerLog::AddArc(int from, int to) {
+  if (detector_ != NULL)
+    detector_->AddArc(from, to);
+}
+
+int32_t EventRacerLog::ObjectId(Handle<Object> obj) {
+  // The top-level variables are attributed to the global object. Any
+  // other context holds the variables of a single activation of its
+  // scope and is identified by itself.
+  if (obj->IsContext()) {
+    Context *ctx = Context::cast(*obj);
+    if (!ctx->IsNativeContext() && !ctx->IsScriptContext())
+      return object_ids_.FindOrAddId(ctx);
+    obj = handle(ctx->global_object(), isolate_);
+  }
+  // Primitive values have no identity.
+  if (!obj->IsJSReceiver())
+    return 0;
+  return object_ids_.FindOrAddId(HeapObject::cast(*obj));
+}
+
+int32_t EventRacerLog::InternName(char *str, int len) {
+  uint32_t hash = StringHasher::HashSequentialString(
+      str, len, isolate_->heap()->HashSeed());
+  HashMap::Entry *e = name_map_.Lookup(str, hash, true);
+  // The entry value is the name index plus one, as NULL denotes a new
+  // entry.
+  if (e->value == NULL) {
+    names_.Add(str);
+    e->value = reinterpret_cast<void*>(static_cast<intptr_t>(names_.length()));
+    if (trace_ != NULL)
+      trace_->WriteName(names_.length() - 1, str, len);
+  } else {
+    DeleteArray(str);
+  }
+  return static_cast<int32_t>(reinterpret_cast<intptr_t>(e->value)) - 1;
+}
+
+int32_t EventRacerLog::NameId(Handle<Object> name) {
+  if (name->IsString()) {
+    String *str = String::cast(*name);
+    int length = Min(kMaxNameSize, str->length());
+    int actual_length = 0;
+    SmartArrayPointer<char> data =
+        str->ToCString(DISALLOW_NULLS, ROBUST_STRING_TRAVERSAL, 0, length,
+                       &actual_length);
+    return InternName(data.Detach(), actual_length);
+  }
+  if (name->IsNumber()) {
+    char buf[100];
+    Vector<char> v(buf, arraysize(buf));
+    const char *s = DoubleToCString(name->Number(), v);
+    int len = StrLength(s);
+    char *str = NewArray<char>(len + 1);
+    MemCopy(str, s, len + 1);
+    return InternName(str, len);
+  }
+  if (name->IsSymbol()) {
+    static const char kSymbol[] = "<symbol>";
+    char *str = NewArray<char>(arraysize(kSymbol));
+    MemCopy(str, kSymbol, arraysize(kSymbol));
+    return InternName(str, arraysize(kSymbol) - 1);
+  }
+  return 0;
+}
+
+static void *IndexKey(int32_t index) {
+  return reinterpret_cast<void*>(
+      static_cast<uintptr_t>(static_cast<uint32_t>(index)) + 1);
+}
+
+// The names of the non-negative indices, e.g. of the elements of range
+// accesses, are interned once per collection.
+int32_t EventRacerLog::IndexNameId(int32_t index) {
+  HashMap::Entry *e = NULL;
+  if (index >= 0) {
+    uint32_t hash = ComputeIntegerHash(static_cast<uint32_t>(index),
+                                       v8::internal::kZeroHashSeed);
+    e = index_names_.Lookup(IndexKey(index), hash, true);
+    // Names other than the empty one have a positive index.
+    if (e->value != NULL)
+      return static_cast<int32_t>(reinterpret_cast<intptr_t>(e->value));
+  }
+  char buf[16];
+  Vector<char> v(buf, arraysize(buf));
+  const char *s = IntToCString(index, v);
+  int len = StrLength(s);
+  char *str = NewArray<char>(len + 1);
+  MemCopy(str, s, len + 1);
+  int32_t id = InternName(str, len);
+  if (e != NULL)
+    e->value = reinterpret_cast<void*>(static_cast<intptr_t>(id));
+  return id;
+}
+
+int EventRacerLog::SiteId(int script_id, Op kind, int position) {
+  SiteKey key = { script_id, kind, position };
+  HashMap::Entry *e = site_ids_.Lookup(&key, SiteKeyHash(key), false);
+  if (e != NULL)
+    return static_cast<int>(reinterpret_cast<intptr_t>(e->value));
+  return NewSiteId();
+}
+
+void EventRacerLog::RegisterSite(int site, Op kind, Handle<String> name,
+                                 int script_id, int fn_id, int position) {
+  DCHECK(site > 0);
+  SiteInfo empty = { NULL, 0, kNone, -1, 0, 0, 0, 0 };
+  while (sites_.length() < site)
+    sites_.Add(empty);
+
+  int length = Min(kMaxNameSize, name->length());
+  int actual_length = 0;
+  SmartArrayPointer<char> data =
+      name->ToCString(DISALLOW_NULLS, ROBUST_STRING_TRAVERSAL, 0, length,
+                      &actual_length);
+  uint32_t hash = StringHasher::HashSequentialString(
+      data.get(), actual_length, isolate_->heap()->HashSeed());
+  HashMap::Entry *e = site_names_.Lookup(data.get(), hash, true);
+  if (e->value == NULL) {
+    e->key = data.Detach();
+    e->value = e->key;
+  }
+
+  SiteInfo &info = sites_[site - 1];
+  info.name = reinterpret_cast<const char*>(e->value);
+  info.name_length = actual_length;
+  info.kind = kind;
+  info.script_id = script_id;
+  info.fn = fn_id;
+  info.position = position;
+  // Not interned in any collection yet.
+  info.collection = 0;
+
+  if (script_id >= 0) {
+    SiteKey key = { script_id, kind, position };
+    e = site_ids_.Lookup(&key, SiteKeyHash(key), true);
+    if (e->value == NULL)
+      e->key = new SiteKey(key);
+    e->value = reinterpret_cast<void*>(static_cast<intptr_t>(site));
+  }
+}
+
+const EventRacerLog::SiteInfo *EventRacerLog::site_info(int site) const {
+  if (site <= 0 || site > sites_.length() || sites_[site - 1].name == NULL)
+    return NULL;
+  return &sites_[site - 1];
+}
+
+// The name of a site is interned once per collection.
+int32_t EventRacerLog::SiteNameId(int site) {
+  if (site <= 0 || site > sites_.length())
+    return 0;
+  SiteInfo &info = sites_[site - 1];
+  if (info.name == NULL)
+    return 0;
+  if (info.collection != collection_) {
+    char *str = NewArray<char>(info.name_length + 1);
+    MemCopy(str, info.name, info.name_length + 1);
+    info.name_id = InternName(str, info.name_length);
+    info.collection = collection_;
+  }
+  return info.name_id;
+}
+
+void EventRacerLog::LogReadSite(int site) {
+  if (!SampleRead(site, NULL, NULL))
+    return;
+  Append(kRead, 0, SiteNameId(site), 0);
+}
+
+void EventRacerLog::LogWriteSite(int site) {
+  if (!Sample(EventRacerSampler::kWrite, site))
+    return;
+  Append(kWrite, 0, SiteNameId(site), 0);
+}
+
+void EventRacerLog::LogWriteFuncSite(int site, int fn_id) {
+  if (!Sample(EventRacerSampler::kWrite, site))
+    return;
+  Append(kWriteFunc, 0, SiteNameId(site), fn_id);
+}
+
+void EventRacerLog::LogDeleteSite(int site) {
+  if (!Sample(EventRacerSampler::kWrite, site))
+    return;
+  Append(kDelete, 0, SiteNameId(site), 0);
+}
+
+void EventRacerLog::LogRead(Handle<Object> name) {
+  if (!SampleRead(0, NULL, *name))
+    return;
+  Append(kRead, 0, NameId(name), 0);
+}
+
+void EventRacerLog::LogReadProp(Handle<Object> obj, Handle<Object> name,
+                                int site) {
+  if (!SampleRead(site, *obj, *name))
+    return;
+  Append(kReadProp, ObjectId(obj), NameId(name), 0);
+}
+
+void EventRacerLog::LogReadArray(Handle<Object> obj) {
+  if (!SampleRead(kArrayReadSite, *obj, NULL))
+    return;
+  Append(kReadArray, ObjectId(obj), 0, 0);
+}
+
+void EventRacerLog::LogWrite(Handle<Object> name) {
+  if (!Sample(EventRacerSampler::kWrite, 0))
+    return;
+  Append(kWrite, 0, NameId(name), 0);
+}
+
+void EventRacerLog::LogWriteProp(Handle<Object> obj, Handle<Object> name,
+                                 int site) {
+  if (!Sample(EventRacerSampler::kWrite, site))
+    return;
+  Append(kWriteProp, ObjectId(obj), NameId(name), 0);
+}
+
+void EventRacerLog::LogWriteFunc(Handle<Object> name, int fn_id) {
+  if (!Sample(EventRacerSampler::kWrite, 0))
+    return;
+  Append(kWriteFunc, 0, NameId(name), fn_id);
+}
+
+void EventRacerLog::LogWritePropFunc(Handle<Object> obj, Handle<Object> name,
+                                     int fn_id, int site) {
+  if (!Sample(EventRacerSampler::kWrite, site))
+    return;
+  Append(kWritePropFunc, ObjectId(obj), NameId(name), fn_id);
+}
+
+void EventRacerLog::LogWriteArray(Handle<Object> obj) {
+  if (!Sample(EventRacerSampler::kWrite, 0))
+    return;
+  Append(kWriteArray, ObjectId(obj), 0, 0);
+}
+
+void EventRacerLog::LogReadRange(Handle<Object> obj, Handle<Object> start,
+                                 Handle<Object> end, int stride,
+                                 bool inclusive) {
+  if (!Sample(EventRacerSampler::kRead, 0))
+    return;
+  AppendRange(kReadRange, obj, start, end, stride, inclusive);
+}
+
+void EventRacerLog::LogWriteRange(Handle<Object> obj, Handle<Object> start,
+                                  Handle<Object> end, int stride,
+                                  bool inclusive) {
+  if (!Sample(EventRacerSampler::kWrite, 0))
+    return;
+  AppendRange(kWriteRange, obj, start, end, stride, inclusive);
+}
+
+// Returns the frame pointer of the JS frame, which called into the runtime,
+// or NULL if there is none. That is the caller of the top exit frame, so
+// the stack is not iterated.
+Address EventRacerLog::CallerFrame() {
+  Address fp = Isolate::c_entry_fp(isolate_->thread_local_top());
+  if (fp == NULL)
+    return NULL;
+  return Memory::Address_at(fp + ExitFrameConstants::kCallerFPOffset);
+}
+
+// Returns the activation of the function |fn_id| in the calling frame, or
+// NULL if it is not there. It may be inlined into an optimized frame.
+JSFunction *EventRacerLog::CallerFunction(int fn_id) {
+  JavaScriptFrameIterator it(isolate_);
+  if (it.done())
+    return NULL;
+  List<JSFunction*> functions(FLAG_max_inlining_levels + 1);
+  it.frame()->GetFunctions(&functions);
+  for (int i = functions.length() - 1; i >= 0; --i) {
+    if (functions[i]->shared()->function_id() == fn_id)
+      return functions[i];
+  }
+  return NULL;
+}
+
+// Logs the exits of the activations, which are deeper in the stack than the
+// frame |fp|. If |fn_id| is positive and there is an activation of it in
+// that frame, also logs the exits of the functions, inlined into it.
+void EventRacerLog::PopActivations(Address fp, int fn_id) {
+  int keep = activations_.length();
+  while (keep > 0 && activations_[keep - 1].fp < fp)
+    --keep;
+  if (fn_id > 0) {
+    for (int i = keep; i > 0 && activations_[i - 1].fp == fp; --i) {
+      if (activations_[i - 1].fn == fn_id) {
+        keep = i;
+        break;
+      }
+    }
+  }
+  while (activations_.length() > keep) {
+    if (activations_.last().logged)
+      Append(kExitFunc, 0, 0, activations_.last().fn);
+    activations_.RemoveLast();
+  }
+}
+
+void EventRacerLog::LogEnterFunction(int fn_id) {
+  // The activations, which are not sampled, are still tracked, so their
+  // exits can be matched and skipped.
+  bool logged = Sample(EventRacerSampler::kCall, fn_id);
+  Address fp = CallerFrame();
+  PopActivations(fp, 0);
+  Activation a = { fp, fn_id, logged };
+  activations_.Add(a);
+  if (!logged)
+    return;
+
+  // The name, script and line numbers do not change between invocations,
+  // so keep them in a side table instead of passing them in each call.
+  // Valid function identifiers are positive. The function is looked up
+  // in the stack only at its first entry.
+  int32_t name = 0;
+  if (fn_id > 0) {
+    HashMap::Entry *e = function_map_.Lookup(FunctionIdKey(fn_id),
+                                             FunctionIdHash(fn_id), true);
+    if (e->value == NULL) {
+      FunctionInfo info = { -1, -1, -1, 0 };
+      JSFunction *function = CallerFunction(fn_id);
+      if (function != NULL) {
+        Handle<SharedFunctionInfo> shared(function->shared(), isolate_);
+        info.name = NameId(handle(shared->DebugName(), isolate_));
+        if (shared->script()->IsScript()) {
+          Handle<Script> script(Script::cast(shared->script()), isolate_);
+          int offset = script->line_offset()->value();
+          info.script_id = script->id()->value();
+          info.start_line =
+              Script::GetLineNumber(script, shared->start_position()) - offset;
+          info.end_line =
+              Script::GetLineNumber(script, shared->end_position()) - offset;
+        }
+      }
+      e->value =
+          reinterpret_cast<void*>(static_cast<intptr_t>(functions_.length()));
+      functions_.Add(info);
+      if (trace_ != NULL) {
+        trace_->WriteFunction(fn_id, info.script_id, info.start_line,
+                              info.end_line);
+      }
+    }
+    name = functions_[static_cast<int>(reinterpret_cast<intptr_t>(e->value))]
+               .name;
+  }
+  Append(kEnterFunc, 0, name, fn_id);
+}
+
+void EventRacerLog::LogEnterNative(Handle<Object> name) {
+  bool logged = Sample(EventRacerSampler::kCall, 0);
+  Address fp = CallerFrame();
+  PopActivations(fp, 0);
+  Activation a = { fp, 0, logged };
+  activations_.Add(a);
+  if (logged)
+    Append(kEnterFunc, 0, NameId(name), 0);
+}
+
+void EventRacerLog::LogExitFunction() {
+  Address fp = CallerFrame();
+  PopActivations(fp, 0);
+  // Exits of activations, which were entered before the log was enabled,
+  // are not logged.
+  if (activations_.is_empty() || activations_.last().fp != fp)
+    return;
+  if (activations_.last().logged)
+    Append(kExitFunc, 0, 0, activations_.last().fn);
+  activations_.RemoveLast();
+}
+
+void EventRacerLog::LogUnwind(int fn_id) {
+  if (activations_.is_empty())
+    return;
+  Address fp = CallerFrame();
+  // With no JS frame left, all the activations are gone.
+  PopActivations(fp == NULL ? reinterpret_cast<Address>(~uintptr_t(0)) : fp,
+                 fn_id);
+}
+
+void EventRacerLog::LogDelete(Handle<Object> name) {
+  if (!Sample(EventRacerSampler::kWrite, 0))
+    return;
+  Append(kDelete, 0, NameId(name), 0);
+}
+
+void EventRacerLog::LogDeleteProp(Handle<Object> obj, Handle<Object> name,
+                                  int site) {
+  if (!Sample(EventRacerSampler::kWrite, site))
+    return;
+  Append(kDeleteProp, ObjectId(obj), NameId(name), 0);
+}
+
+static void MarkActiveCode(Isolate *isolate, ThreadLocalTop *top,
+                           Object *active_marker, List<Code*> *marked) {
+  // The unoptimized code of the functions, inlined into optimized frames,
+  // is needed for the lazy deoptimization, so keep it too.
+  for (JavaScriptFrameIterator it(isolate, top); !it.done(); it.Advance()) {
+    List<JSFunction*> functions(FLAG_max_inlining_levels + 1);
+    it.frame()->GetFunctions(&functions);
+    for (int i = 0; i < functions.length(); ++i) {
+      Code *code = functions[i]->shared()->code();
+      if (code->gc_metadata() == active_marker)
+        continue;
+      code->set_gc_metadata(active_marker);
+      marked->Add(code);
+    }
+  }
+}
+
+class ActiveCodeMarker : public ThreadVisitor {
+public:
+  ActiveCodeMarker(Object *active_marker, List<Code*> *marked)
+    : active_marker_(active_marker), marked_(marked) {}
+
+  void VisitThread(Isolate *isolate, ThreadLocalTop *top) {
+    MarkActiveCode(isolate, top, active_marker_, marked_);
+  }
+
+private:
+  Object *active_marker_;
+  List<Code*> *marked_;
+};
+
+static bool CanFlush(SharedFunctionInfo *shared, Object *active_marker) {
+  // Generators may have suspended activations, which resume at an offset
+  // into the existing code. Top-level code cannot be recompiled lazily.
+  return !shared->native() && !shared->is_generator() &&
+         !shared->is_toplevel() && shared->allows_lazy_compilation() &&
+         shared->code()->gc_metadata() != active_marker;
+}
+
+bool EventRacerLog::InstrumentsNewCode() const {
+  return FLAG_instrument && (!FLAG_instrument_lazily || enabled());
+}
+
+bool EventRacerLog::IsMismatched(Code *code) {
+  return code->kind() == Code::FUNCTION && code->is_instrumented() != enabled();
+}
+
+void EventRacerLog::FlushMismatchedCode() {
+  if (!FLAG_instrument || !FLAG_instrument_lazily)
+    return;
+
+  // Optimized code is compiled from the same AST as the unoptimized code
+  // it deoptimizes to, so it has to go as well.
+  if (isolate_->concurrent_recompilation_enabled())
+    isolate_->optimizing_compiler_thread()->Flush();
+  Deoptimizer::DeoptimizeAll(isolate_);
+
+  Heap *heap = isolate_->heap();
+  heap->CollectAllGarbage(Heap::kMakeHeapIterableMask,
+                          "ER instrumentation state change");
+  HeapIterator iterator(heap);
+  DisallowHeapAllocation no_allocation;
+
+  Object *active_marker = heap->the_hole_value();
+  List<Code*> marked;
+  MarkActiveCode(isolate_, isolate_->thread_local_top(), active_marker,
+                 &marked);
+  ActiveCodeMarker marker(active_marker, &marked);
+  isolate_->thread_manager()->IterateArchivedThreads(&marker);
+
+  Code *lazy_compile = isolate_->builtins()->builtin(Builtins::kCompileLazy);
+  for (HeapObject *obj = iterator.next(); obj != NULL; obj = iterator.next()) {
+    if (obj->IsJSFunction()) {
+      JSFunction *function = JSFunction::cast(obj);
+      if (!CanFlush(function->shared(), active_marker))
+        continue;
+      if (IsMismatched(function->code()) ||
+          function->code()->kind() == Code::OPTIMIZED_FUNCTION ||
+          function->IsInOptimizationQueue() ||
+          function->IsMarkedForOptimization() ||
+          function->IsMarkedForConcurrentOptimization())
+        function->ReplaceCode(lazy_compile);
+    } else if (obj->IsSharedFunctionInfo()) {
+      SharedFunctionInfo *shared = SharedFunctionInfo::cast(obj);
+      if (!CanFlush(shared, active_marker) || !IsMismatched(shared->code()))
+        continue;
+      shared->ReplaceCode(lazy_compile);
+      shared->ClearOptimizedCodeMap();
+    }
+  }
+
+  for (int i = 0; i < marked.length(); ++i)
+    marked[i]->set_gc_metadata(Smi::FromInt(0));
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,383 @@
+#ifndef V8_EVENT_RACER_LOG_H_
+#define V8_EVENT_RACER_LOG_H_
+
+#include "include/v8.h"
+#include "src/allocation.h"
+#include "src/base/atomicops.h"
+#include "src/event-racer-object-ids.h"
+#include "src/event-racer-sampler.h"
+#include "src/handles.h"
+#include "src/hashmap.h"
+#include "src/list.h"
+
+namespace v8 {
+namespace internal {
+
+class EventRacerDetector;
+class EventRacerTrace;
+
+// Operations encoding, as documented for |ER_getLog| in eventracer.js.
+#define EVENT_RACER_OP_LIST(V)                  \
+  V(Read, 1)                                    \
+  V(ReadProp, 2)                                \
+  V(ReadArray, 3)                               \
+  V(Write, 4)                                   \
+  V(WriteProp, 5)                               \
+  V(WriteFunc, 6)                               \
+  V(WritePropFunc, 7)                           \
+  V(WriteArray, 8)                              \
+  V(EnterFunc, 9)                               \
+  V(ExitFunc, 10)                               \
+  V(Delete, 11)                                 \
+  V(DeleteProp, 12)                             \
+  V(ReadRange, 13)                              \
+  V(WriteRange, 14)
+
+// Runtime functions, which record events, along with the index of the
+// argument, which the call returns, or -1 if the call returns undefined.
+// These are inlined by the optimizing compilers as a test of the enable
+// counter, guarding the runtime call.
+#define EVENT_RACER_INTRINSIC_LIST(V)           \
+  V(EventRacerRead, 1)                          \
+  V(EventRacerReadProp, 2)                      \
+  V(EventRacerReadPropObject, 0)                \
+  V(EventRacerReadArray, -1)                    \
+  V(EventRacerWrite, 1)                         \
+  V(EventRacerWriteProp, 2)                     \
+  V(EventRacerWriteFunc, 1)                     \
+  V(EventRacerWritePropFunc, 2)                 \
+  V(EventRacerWriteArray, -1)                   \
+  V(EventRacerEnterFunction, -1)                \
+  V(EventRacerExitFunction, 0)                  \
+  V(EventRacerUnwind, -1)                       \
+  V(EventRacerDelete, -1)                       \
+  V(EventRacerDeleteProp, -1)                   \
+  V(EventRacerReadRange, -1)                    \
+  V(EventRacerWriteRange, -1)
+
+// Per-isolate log of the memory accesses and function entries/exits,
+// reported by the ER instrumentation. Events are kept in a preallocated
+// ring buffer of fixed-size records. Property and variable names are
+// interned into a table of C strings and the events refer to them by
+// index, so recording does not allocate on the JS heap.
+//
+// Each isolate records into its own log, on its own thread, without
+// locking. The events of all the isolates in the process are ordered by a
+// process-wide sequence number, taken by an atomic increment, so the
+// embedders, running several isolates at the same time, can merge their
+// logs, or their traces, into a single interleaving.
+//
+// With |--er-trace|, the events are also streamed to a binary trace file,
+// see event-racer-trace.h. With the |--er-sample-*| flags, only a sample of
+// the events is recorded, see event-racer-sampler.h. With
+// |--er-detect-races|, or once the embedder sets a race callback, the
+// events are also checked for races, see event-racer-detector.h.
+class EventRacerLog {
+public:
+#define OP(name, code) k##name = code,
+  enum Op {
+    kNone = 0,
+    EVENT_RACER_OP_LIST(OP)
+  };
+#undef OP
+
+  // The largest stride of a range access, which fits in an |Event|.
+  static const int kMaxRangeStride = 0x7fff;
+
+  // A range access stands for the accesses of the array elements |name|,
+  // |name| + |stride|, ..., |fn|, e.g. by a counted loop. The sequence
+  // number makes an event 24 bytes, up from 16.
+  struct Event {
+    // The process-wide sequence number, see |NextSequence|.
+    uint64_t seq;
+    int16_t op;
+    // Distance between the accessed elements of a range access, zero for
+    // the other events.
+    int16_t stride;
+    // Identifier of the accessed object, zero if not applicable or the
+    // object is a primitive value. See |EventRacerObjectIds|.
+    int32_t obj;
+    // Index into the name table, zero if not applicable. The first index
+    // of a range access.
+    int32_t name;
+    // Function literal identifier, for function entries and exits and
+    // function value writes, zero otherwise. The last index of a range
+    // access.
+    int32_t fn;
+  };
+
+  struct FunctionInfo {
+    int32_t script_id;
+    int32_t start_line;
+    int32_t end_line;
+    // Index into the name table.
+    int32_t name;
+  };
+
+  // Static information about an instrumentation site of a variable or a
+  // property access. The instrumented code passes the site id of a global
+  // variable access instead of the name, and the one of a property access
+  // along with it, see |RegisterSite|.
+  struct SiteInfo {
+    // The variable or the property name, shared by the sites with the same
+    // name, empty if the property name is computed. NULL if the site is not
+    // registered.
+    const char *name;
+    int name_length;
+    // The |Op| of the access.
+    int kind;
+    // The script and the function literal, which contain the site, and the
+    // source position of the access. The script id is -1 if unknown.
+    int32_t script_id;
+    int32_t fn;
+    int32_t position;
+    // Index of |name| into the name table, valid while |collection| is
+    // the current collection.
+    int32_t name_id;
+    uint32_t collection;
+  };
+
+  explicit EventRacerLog(Isolate *isolate);
+  ~EventRacerLog();
+
+  // Increments the collection enable counter, discarding the recorded
+  // events and re-reading the sampling flags when collection starts. The
+  // trace file is opened the first time the collection starts.
+  void Enable();
+
+  // Decrements the collection enable counter and returns the new value.
+  // Events are not recorded while the counter is zero.
+  int Disable();
+
+  bool enabled() const { return enable_count_ > 0; }
+
+  // Address of the enable counter, tested by the optimized code before
+  // calling into the runtime to record an event.
+  int *enable_count_address() { return &enable_count_; }
+
+  // Returns the next process-wide sequence number. The numbers start at
+  // one and are unique across the isolates. An event, which happens
+  // before another one, possibly in another isolate, gets a smaller
+  // number.
+  static uint64_t NextSequence();
+
+  // Returns true if the code, compiled now, gets the ER instrumentation,
+  // unless excluded by the filters. The compilation and the code caches
+  // keep the code for each state separately.
+  bool InstrumentsNewCode() const;
+
+  // With |--instrument-lazily|, functions are compiled with the ER
+  // instrumentation only while the log is enabled. Called after the
+  // enable counter changes between zero and non-zero, this discards the
+  // compiled code, which does not match the new state, so it is lazily
+  // recompiled on the next call. Functions with activations on the stack
+  // and generators keep their code.
+  void FlushMismatchedCode();
+
+  // Returns a new site id. May be called off the main thread, by the ER
+  // rewriter of a streamed script.
+  int NewSiteId() {
+    return base::NoBarrier_AtomicIncrement(&next_site_id_, 1);
+  }
+
+  // Returns the id of the registered site of the access |kind| at
+  // |position| in the script |script_id|, or a new id if there is none, so
+  // the recompiled code keeps the ids of its sites. Only on the main
+  // thread.
+  int SiteId(int script_id, Op kind, int position);
+
+  // Records the static information of the site |site|, once the code,
+  // which contains it, is compiled. Site ids stay valid across the
+  // collections.
+  void RegisterSite(int site, Op kind, Handle<String> name, int script_id,
+                    int fn_id, int position);
+
+  // Returns the information about a site, or NULL if not registered.
+  const SiteInfo *site_info(int site) const;
+  int site_count() const { return sites_.length(); }
+
+  // The accesses of global variables, identified by the site id.
+  void LogReadSite(int site);
+  void LogWriteSite(int site);
+  void LogWriteFuncSite(int site, int fn_id);
+  void LogDeleteSite(int site);
+
+  // The accesses of properties. |site| is the site id of the access, which
+  // keys the sampling and the read deduplication, or zero if unknown.
+  void LogRead(Handle<Object> name);
+  void LogReadProp(Handle<Object> obj, Handle<Object> name, int site = 0);
+  void LogReadArray(Handle<Object> obj);
+  void LogWrite(Handle<Object> name);
+  void LogWriteProp(Handle<Object> obj, Handle<Object> name, int site = 0);
+  void LogWriteFunc(Handle<Object> name, int fn_id);
+  void LogWritePropFunc(Handle<Object> obj, Handle<Object> name, int fn_id,
+                        int site = 0);
+  void LogWriteArray(Handle<Object> obj);
+
+  // Log the accesses of the elements of |obj|, indexed by a loop counter,
+  // which starts at |start| and advances by |stride| while it is before
+  // |end|, or equal to it, if |inclusive|. A non-integer start or a
+  // non-number end is logged as an access of the whole array.
+  void LogReadRange(Handle<Object> obj, Handle<Object> start,
+                    Handle<Object> end, int stride, bool inclusive);
+  void LogWriteRange(Handle<Object> obj, Handle<Object> start,
+                     Handle<Object> end, int stride, bool inclusive);
+
+  // Function entries and exits are matched to the JS stack frame of the
+  // calling function. The log keeps a stack of the activations, so it can
+  // log the exits of the activations, which were unwound by an exception,
+  // when the exception is caught, or the next time a function is entered
+  // or exited in a caller. The name, the script and the line numbers of a
+  // function are taken from the calling frame on the first entry.
+  void LogEnterFunction(int fn_id);
+  void LogExitFunction();
+  // Logs an entry into a native function, which is not instrumented. The
+  // entries of natives have no site, so they are not backed off.
+  void LogEnterNative(Handle<Object> name);
+  // Called when an exception is caught by the function |fn_id|, or by
+  // the C++ code, if |fn_id| is zero.
+  void LogUnwind(int fn_id);
+  void LogDelete(Handle<Object> name);
+  void LogDeleteProp(Handle<Object> obj, Handle<Object> name, int site = 0);
+
+  // Number of events currently held in the buffer.
+  int length() const;
+
+  // Number of events overwritten because the buffer was full.
+  uint64_t dropped() const {
+    return written_ > capacity_ ? written_ - capacity_ : 0;
+  }
+
+  // Returns the |i|-th oldest event in the buffer.
+  const Event &at(int i) const;
+
+  int name_count() const { return names_.length(); }
+  const char *name(int id) const { return names_[id]; }
+
+  // Returns the static information about a function, or NULL if the
+  // function has not been entered since the log was last enabled.
+  // The script id and the line numbers are -1 if unknown.
+  const FunctionInfo *function_info(int fn_id);
+
+  // Called by the GC to update the object identifier map.
+  void ProcessWeakReferences(WeakObjectRetainer *retainer) {
+    object_ids_.ProcessWeakReferences(retainer);
+  }
+
+  // Starts a new epoch of the read deduplication. Called at the start of
+  // each outermost JS invocation.
+  void NewEpoch();
+
+  // Event actions of the embedder, see |EventRacerDetector|. Each one is
+  // a new deduplication epoch.
+  void BeginEvent(int event_id);
+  void EndEvent();
+  void AddArc(int from, int to);
+
+  // The race detector, NULL unless the race detection is on.
+  EventRacerDetector *detector() { return detector_; }
+
+  // Turns on the race detection, reporting the races to |callback|.
+  void SetRaceCallback(v8::EventRacerRaceCallback callback);
+
+  // Writes out the remaining events and closes the trace file. When a
+  // temporary file is used, returns its stream, leaving the file open.
+  FILE *CloseTrace();
+
+private:
+  static bool StringsMatch(void *key1, void *key2);
+  static bool SiteKeysMatch(void *key1, void *key2);
+
+  struct Activation {
+    Address fp;
+    int32_t fn;
+    // False if the entry was not sampled, so neither is the exit.
+    bool logged;
+  };
+
+  void Reset();
+  void OpenTrace();
+  Address CallerFrame();
+  JSFunction *CallerFunction(int fn_id);
+  void PopActivations(Address fp, int fn_id);
+  // Per-site cache of the last recorded read, see |SampleRead|.
+  struct ReadCacheEntry {
+    int site;
+    Object *obj;
+    Object *name;
+    uint32_t epoch;
+    int gc_count;
+  };
+  static const int kReadCacheSize = 256;
+  // The site of the whole array reads by the builtins, which do not pass
+  // a site id. The site ids of the instrumentation are positive.
+  static const int kArrayReadSite = -1;
+
+  bool Sample(EventRacerSampler::Kind kind, int site);
+  bool SampleRead(int site, Object *obj, Object *name);
+  void Append(Op op, int32_t obj, int32_t name, int32_t fn);
+  void AppendRange(Op op, Handle<Object> obj, Handle<Object> start,
+                   Handle<Object> end, int stride, bool inclusive);
+  int32_t ObjectId(Handle<Object> obj);
+  int32_t NameId(Handle<Object> name);
+  int32_t IndexNameId(int32_t index);
+  int32_t SiteNameId(int site);
+  int32_t InternName(char *str, int len);
+  bool IsMismatched(Code *code);
+
+  Isolate *isolate_;
+  int enable_count_;
+
+  // The ring buffer. The capacity is a power of two, the event with
+  // sequence number |n| lives at |buffer_[n & (capacity_ - 1)]|.
+  Event *buffer_;
+  uint64_t capacity_;
+  uint64_t written_;
+
+  // Interned names. Index zero is reserved for the empty name.
+  HashMap name_map_;
+  List<const char *> names_;
+  // The name indices of the non-negative element indices, see
+  // |IndexNameId|.
+  HashMap index_names_;
+
+  // Counts the collections, each one starts with an empty name table.
+  uint32_t collection_;
+
+  // Site information, indexed by the site id minus one, the names of the
+  // sites, which are kept across the collections, and the site ids by
+  // script, kind and position.
+  base::Atomic32 next_site_id_;
+  List<SiteInfo> sites_;
+  HashMap site_names_;
+  HashMap site_ids_;
+
+  // Function identifier to index into |functions_|.
+  HashMap function_map_;
+  List<FunctionInfo> functions_;
+
+  // Function activations, which have been entered, but not exited, since
+  // the log was enabled. Stack frames grow downwards.
+  List<Activation> activations_;
+
+  EventRacerSampler sampler_;
+
+  // Repeated reads are recorded once per epoch and site.
+  uint32_t epoch_;
+  ReadCacheEntry read_cache_[kReadCacheSize];
+
+  // Identifiers of the objects seen since the log was last enabled.
+  EventRacerObjectIds object_ids_;
+
+  // The binary trace, NULL if not requested or already closed.
+  EventRacerTrace *trace_;
+
+  // The race detector, NULL if the race detection is off.
+  EventRacerDetector *detector_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRacerLog);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_LOG_H_
@@ -0,0 +1,95 @@
+#include "src/v8.h"
+
+#include "src/event-racer-object-ids.h"
+
+namespace v8 {
+namespace internal {
+
+static uint32_t AddressHash(Address addr) {
+  return ComputePointerHash(addr);
+}
+
+static void *IndexValue(int index) {
+  return reinterpret_cast<void*>(static_cast<intptr_t>(index));
+}
+
+EventRacerObjectIds::EventRacerObjectIds()
+  : next_id_(1),
+    map_(HashMap::PointersMatch),
+    dead_count_(0) {}
+
+int32_t EventRacerObjectIds::FindOrAddId(HeapObject *obj) {
+  Address addr = obj->address();
+  HashMap::Entry *e = map_.Lookup(addr, AddressHash(addr), true);
+  if (e->value != NULL)
+    return entries_[static_cast<int>(reinterpret_cast<intptr_t>(e->value)) - 1]
+        .id;
+  // The value is the entry index plus one, as NULL denotes a new entry.
+  Entry entry = { addr, next_id_++ };
+  entries_.Add(entry);
+  e->value = IndexValue(entries_.length());
+  return entry.id;
+}
+
+void EventRacerObjectIds::ProcessWeakReferences(WeakObjectRetainer *retainer) {
+  if (entries_.is_empty())
+    return;
+
+  // An object may move to the address of a dead object, or of another
+  // moved object, so first remove all the stale addresses from the map,
+  // then add the new ones.
+  List<int> moved;
+  for (int i = 0; i < entries_.length(); ++i) {
+    Entry &entry = entries_[i];
+    if (entry.addr == NULL)
+      continue;
+    Object *obj = retainer->RetainAs(HeapObject::FromAddress(entry.addr));
+    Address addr = obj == NULL ? NULL : HeapObject::cast(obj)->address();
+    if (addr == entry.addr)
+      continue;
+    map_.Remove(entry.addr, AddressHash(entry.addr));
+    entry.addr = addr;
+    if (addr == NULL)
+      ++dead_count_;
+    else
+      moved.Add(i);
+  }
+  for (int i = 0; i < moved.length(); ++i) {
+    Address addr = entries_[moved[i]].addr;
+    HashMap::Entry *e = map_.Lookup(addr, AddressHash(addr), true);
+    DCHECK(e->value == NULL);
+    e->value = IndexValue(moved[i] + 1);
+  }
+
+  if (dead_count_ > entries_.length() / 2)
+    RemoveDeadEntries();
+}
+
+void EventRacerObjectIds::RemoveDeadEntries() {
+  int first_free_entry = 0;
+  for (int i = 0; i < entries_.length(); ++i) {
+    Entry &entry = entries_[i];
+    if (entry.addr == NULL)
+      continue;
+    if (first_free_entry != i) {
+      entries_[first_free_entry] = entry;
+      HashMap::Entry *e =
+          map_.Lookup(entry.addr, AddressHash(entry.addr), false);
+      DCHECK(e != NULL);
+      e->value = IndexValue(first_free_entry + 1);
+    }
+    ++first_free_entry;
+  }
+  entries_.Rewind(first_free_entry);
+  dead_count_ = 0;
+  DCHECK(static_cast<uint32_t>(entries_.length()) == map_.occupancy());
+}
+
+void EventRacerObjectIds::Clear() {
+  map_.Clear();
+  entries_.Clear();
+  dead_count_ = 0;
+  next_id_ = 1;
+}
+
+} }  // namespace v8::internal
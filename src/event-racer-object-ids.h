@@ -0,0 +1,57 @@
+#ifndef V8_EVENT_RACER_OBJECT_IDS_H_
+#define V8_EVENT_RACER_OBJECT_IDS_H_
+
+#include "src/allocation.h"
+#include "src/hashmap.h"
+#include "src/list.h"
+
+namespace v8 {
+namespace internal {
+
+class HeapObject;
+class WeakObjectRetainer;
+
+// Assigns the objects, accessed by the traced program, small integer
+// identifiers, which remain the same while the object is alive. Like the
+// |HeapObjectsMap| of the heap profiler, the objects are tracked by their
+// address, so the map neither retains them, nor modifies them. The heap
+// reports object moves and deaths via |ProcessWeakReferences| after each
+// GC. The identifiers of dead objects are not reused.
+class EventRacerObjectIds {
+public:
+  EventRacerObjectIds();
+
+  // Returns the identifier of |obj|, assigning a new one if the object has
+  // not been seen before. Identifiers are positive.
+  int32_t FindOrAddId(HeapObject *obj);
+
+  // Updates the addresses of the moved objects and removes the dead ones.
+  // Called by the GC.
+  void ProcessWeakReferences(WeakObjectRetainer *retainer);
+
+  // Forgets all objects and restarts the numbering.
+  void Clear();
+
+  int size() const { return static_cast<int>(map_.occupancy()); }
+
+private:
+  struct Entry {
+    Address addr;
+    int32_t id;
+  };
+
+  void RemoveDeadEntries();
+
+  int32_t next_id_;
+  // Object address to index into |entries_|. Entries of dead objects have
+  // a NULL address and are not in the map.
+  HashMap map_;
+  List<Entry> entries_;
+  int dead_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRacerObjectIds);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_OBJECT_IDS_H_
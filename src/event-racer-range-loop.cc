@@ -0,0 +1,418 @@
+#include "src/v8.h"
+
+#include "src/event-racer-log.h"
+#include "src/event-racer-range-loop.h"
+#include "src/scopes.h"
+
+namespace v8 {
+namespace internal {
+
+typedef EventRacerRangeLoop ERRL;  // for brevity.
+
+ERRL::EventRacerRangeLoop(Zone *zone, EventRacerRangeLoop *outer,
+                          uintptr_t stack_limit)
+  : outer_(outer),
+    loop_(NULL),
+    counter_(NULL),
+    stride_(0),
+    bound_var_(NULL),
+    bound_key_(NULL),
+    inclusive_(false),
+    rejected_(false),
+    conditional_(0),
+    jumped_(false),
+    arrays_(2, zone),
+    accesses_(4, zone),
+    assigned_(4, zone),
+    targets_(2, zone) {
+  InitializeAstVisitor(zone, stack_limit);
+}
+
+bool ERRL::Analyze(ForStatement *loop) {
+  loop_ = loop;
+  if (loop->cond() == NULL || loop->next() == NULL ||
+      !MatchNext(loop->next()) || !MatchCondition(loop->cond()))
+    return false;
+
+  Visit(loop->body());
+  if (rejected_ || arrays_.is_empty() || IsAssigned(counter_) ||
+      IsAssigned(bound_var_))
+    return false;
+  for (int i = 0; i < arrays_.length(); ++i) {
+    if (IsAssigned(arrays_[i].var))
+      return false;
+  }
+  return true;
+}
+
+bool ERRL::IsRangeAccess(Property *p) const {
+  for (const ERRL *loop = this; loop != NULL; loop = loop->outer_) {
+    for (int i = 0; i < loop->accesses_.length(); ++i) {
+      if (loop->accesses_[i] == p)
+        return true;
+    }
+  }
+  return false;
+}
+
+bool ERRL::IsTracked(Variable *var) {
+  return var != NULL && var->IsStackAllocated();
+}
+
+// Returns the variable, referenced by |expr|, if it is tracked, NULL
+// otherwise.
+Variable *ERRL::TrackedVar(Expression *expr) {
+  VariableProxy *vp = expr->AsVariableProxy();
+  if (vp == NULL || !IsTracked(vp->var()))
+    return NULL;
+  return vp->var();
+}
+
+// Matches |i++|, |++i|, |i--|, |--i|, |i += c| and |i -= c|, with an
+// integer literal |c|.
+bool ERRL::MatchNext(Statement *next) {
+  ExpressionStatement *st = next->AsExpressionStatement();
+  if (st == NULL)
+    return false;
+  Expression *expr = st->expression();
+  if (CountOperation *op = expr->AsCountOperation()) {
+    counter_ = TrackedVar(op->expression());
+    stride_ = op->op() == Token::INC ? 1 : -1;
+  } else if (Assignment *op = expr->AsAssignment()) {
+    Literal *lit = op->value()->AsLiteral();
+    if ((op->op() != Token::ASSIGN_ADD && op->op() != Token::ASSIGN_SUB) ||
+        lit == NULL || !lit->raw_value()->IsSmi())
+      return false;
+    counter_ = TrackedVar(op->target());
+    stride_ = lit->raw_value()->AsSmi();
+    if (op->op() == Token::ASSIGN_SUB)
+      stride_ = -stride_;
+  }
+  return counter_ != NULL && stride_ != 0 &&
+         Abs(stride_) <= EventRacerLog::kMaxRangeStride;
+}
+
+// Matches |i < bound| and |i <= bound| for a positive stride and
+// |i > bound| and |i >= bound| for a negative one.
+bool ERRL::MatchCondition(Expression *cond) {
+  CompareOperation *op = cond->AsCompareOperation();
+  if (op == NULL || TrackedVar(op->left()) != counter_)
+    return false;
+  switch (op->op()) {
+    case Token::LT:
+    case Token::GT:
+      inclusive_ = false;
+      break;
+    case Token::LTE:
+    case Token::GTE:
+      inclusive_ = true;
+      break;
+    default:
+      return false;
+  }
+  bool up = op->op() == Token::LT || op->op() == Token::LTE;
+  if (up != (stride_ > 0))
+    return false;
+
+  // A property bound, like |a.length|, is not accepted, as the body, or a
+  // function it calls, may grow it past the range, computed before the
+  // loop.
+  Expression *bound = op->right();
+  if (Literal *lit = bound->AsLiteral()) {
+    bound_key_ = lit;
+    return lit->raw_value()->IsNumber();
+  }
+  bound_var_ = TrackedVar(bound);
+  return bound_var_ != NULL && bound_var_ != counter_;
+}
+
+bool ERRL::IsAssigned(Variable *var) const {
+  for (int i = 0; i < assigned_.length(); ++i) {
+    if (assigned_[i] == var)
+      return true;
+  }
+  return false;
+}
+
+// Visits the target of a for-in or for-of loop, or of a variable
+// assignment.
+void ERRL::Assign(Expression *target) {
+  VariableProxy *vp = target->AsVariableProxy();
+  if (vp != NULL) {
+    assigned_.Add(vp->var(), zone());
+  } else {
+    DCHECK(target->IsProperty());
+    Visit(target->AsProperty()->obj());
+    Visit(target->AsProperty()->key());
+  }
+}
+
+// Visits a property access, |read| and |written| tell if it loads and
+// stores the property.
+void ERRL::AccessElement(Property *p, bool read, bool written) {
+  Variable *var = TrackedVar(p->obj());
+  if (var == NULL || var == counter_ || TrackedVar(p->key()) != counter_ ||
+      conditional_ > 0 || jumped_) {
+    Visit(p->obj());
+    Visit(p->key());
+    return;
+  }
+  accesses_.Add(p, zone());
+  for (int i = 0; i < arrays_.length(); ++i) {
+    if (arrays_[i].var == var) {
+      arrays_[i].read |= read;
+      arrays_[i].written |= written;
+      return;
+    }
+  }
+  ArrayAccess access = { var, read, written };
+  arrays_.Add(access, zone());
+}
+
+// ---------------------------------------------------------------------------
+// -- Element accesses and assignments ---------------------------------------
+// ---------------------------------------------------------------------------
+
+void ERRL::VisitProperty(Property *p) {
+  AccessElement(p, true, false);
+}
+
+void ERRL::VisitAssignment(Assignment *op) {
+  Property *p = op->target()->AsProperty();
+  if (p != NULL)
+    AccessElement(p, op->is_compound(), true);
+  else
+    Assign(op->target());
+  Visit(op->value());
+}
+
+void ERRL::VisitCountOperation(CountOperation *op) {
+  Property *p = op->expression()->AsProperty();
+  if (p != NULL)
+    AccessElement(p, true, true);
+  else
+    Assign(op->expression());
+}
+
+void ERRL::VisitUnaryOperation(UnaryOperation *op) {
+  // Deletions and property calls are logged by the instrumentation as
+  // usual, so they are not part of the range.
+  Property *p = op->expression()->AsProperty();
+  if (op->op() == Token::DELETE && p != NULL) {
+    Visit(p->obj());
+    Visit(p->key());
+  } else {
+    Visit(op->expression());
+  }
+}
+
+void ERRL::VisitCall(Call *c) {
+  Property *p = c->expression()->AsProperty();
+  if (p != NULL) {
+    Visit(p->obj());
+    Visit(p->key());
+  } else {
+    Visit(c->expression());
+  }
+  VisitExpressions(c->arguments());
+}
+
+void ERRL::VisitForInStatement(ForInStatement *st) {
+  targets_.Add(st, zone());
+  Visit(st->subject());
+  ++conditional_;
+  Assign(st->each());
+  Visit(st->body());
+  --conditional_;
+}
+
+void ERRL::VisitForOfStatement(ForOfStatement *st) {
+  targets_.Add(st, zone());
+  Visit(st->subject());
+  ++conditional_;
+  Assign(st->each());
+  Visit(st->body());
+  --conditional_;
+}
+
+void ERRL::VisitFunctionDeclaration(FunctionDeclaration *dcl) {
+  assigned_.Add(dcl->proxy()->var(), zone());
+}
+
+// ---------------------------------------------------------------------------
+// -- Control flow -----------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// A jump to the end of the body, or of a labelled block in it, may skip
+// the accesses after it. The jumps out of the nested loops and switches
+// skip only the code, which runs conditionally anyway.
+void ERRL::Jump(BreakableStatement *target) {
+  if (target == loop_ || target->AsBlock() != NULL)
+    jumped_ = true;
+}
+
+void ERRL::VisitContinueStatement(ContinueStatement *st) {
+  if (st->target() != loop_ && !targets_.Contains(st->target()))
+    Reject();
+  Jump(st->target());
+}
+
+void ERRL::VisitBreakStatement(BreakStatement *st) {
+  // A |break| can only target an enclosing statement, so a target, seen
+  // in the body, is inside the loop.
+  if (!targets_.Contains(st->target()))
+    Reject();
+  Jump(st->target());
+}
+
+void ERRL::VisitReturnStatement(ReturnStatement *st) {
+  Reject();
+}
+
+void ERRL::VisitYield(Yield *e) {
+  Reject();
+}
+
+void ERRL::VisitWithStatement(WithStatement *st) {
+  Reject();
+}
+
+void ERRL::VisitBlock(Block *st) {
+  targets_.Add(st, zone());
+  VisitStatements(st->statements());
+}
+
+void ERRL::VisitSwitchStatement(SwitchStatement *st) {
+  targets_.Add(st, zone());
+  Visit(st->tag());
+  ZoneList<CaseClause*> *clauses = st->cases();
+  for (int i = 0; i < clauses->length(); ++i)
+    VisitConditionally(clauses->at(i));
+}
+
+// The bodies of the nested loops run any number of times, so they are
+// conditional. The body of a |do| loop, too, as a jump may leave it
+// early.
+void ERRL::VisitDoWhileStatement(DoWhileStatement *st) {
+  targets_.Add(st, zone());
+  VisitConditionally(st->body());
+  VisitConditionally(st->cond());
+}
+
+void ERRL::VisitWhileStatement(WhileStatement *st) {
+  targets_.Add(st, zone());
+  Visit(st->cond());
+  VisitConditionally(st->body());
+}
+
+void ERRL::VisitForStatement(ForStatement *st) {
+  targets_.Add(st, zone());
+  VisitIfNotNull(st->init());
+  VisitIfNotNull(st->cond());
+  VisitConditionally(st->body());
+  VisitConditionally(st->next());
+}
+
+// ---------------------------------------------------------------------------
+// -- Leaf nodes -------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ERRL::VisitVariableDeclaration(VariableDeclaration *dcl) {}
+void ERRL::VisitModuleDeclaration(ModuleDeclaration *dcl) {}
+void ERRL::VisitImportDeclaration(ImportDeclaration *dcl) {}
+void ERRL::VisitExportDeclaration(ExportDeclaration *dcl) {}
+void ERRL::VisitModuleVariable(ModuleVariable *leaf) {}
+void ERRL::VisitModulePath(ModulePath *leaf) {}
+void ERRL::VisitModuleUrl(ModuleUrl *leaf) {}
+void ERRL::VisitEmptyStatement(EmptyStatement *leaf) {}
+void ERRL::VisitDebuggerStatement(DebuggerStatement *leaf) {}
+void ERRL::VisitFunctionLiteral(FunctionLiteral *leaf) {}
+void ERRL::VisitNativeFunctionLiteral(NativeFunctionLiteral *leaf) {}
+void ERRL::VisitLiteral(Literal *leaf) {}
+void ERRL::VisitRegExpLiteral(RegExpLiteral *leaf) {}
+void ERRL::VisitThisFunction(ThisFunction *leaf) {}
+void ERRL::VisitSuperReference(SuperReference *leaf) {}
+void ERRL::VisitClassLiteral(ClassLiteral *leaf) {}
+void ERRL::VisitVariableProxy(VariableProxy *leaf) {}
+
+// ---------------------------------------------------------------------------
+// -- Pass-through nodes -----------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ERRL::VisitModuleLiteral(ModuleLiteral *e) {
+  Visit(e->body());
+}
+
+void ERRL::VisitModuleStatement(ModuleStatement *st) {
+  Visit(st->body());
+}
+
+void ERRL::VisitExpressionStatement(ExpressionStatement *st) {
+  Visit(st->expression());
+}
+
+void ERRL::VisitIfStatement(IfStatement *st) {
+  Visit(st->condition());
+  VisitConditionally(st->then_statement());
+  VisitConditionally(st->else_statement());
+}
+
+void ERRL::VisitCaseClause(CaseClause *cc) {
+  if (!cc->is_default())
+    Visit(cc->label());
+  VisitStatements(cc->statements());
+}
+
+void ERRL::VisitTryCatchStatement(TryCatchStatement *st) {
+  Visit(st->try_block());
+  VisitConditionally(st->catch_block());
+}
+
+void ERRL::VisitTryFinallyStatement(TryFinallyStatement *st) {
+  Visit(st->try_block());
+  Visit(st->finally_block());
+}
+
+void ERRL::VisitConditional(Conditional *e) {
+  Visit(e->condition());
+  VisitConditionally(e->then_expression());
+  VisitConditionally(e->else_expression());
+}
+
+void ERRL::VisitObjectLiteral(ObjectLiteral *e) {
+  ZoneList<ObjectLiteralProperty*> *props = e->properties();
+  for (int i = 0; i < props->length(); ++i)
+    Visit(props->at(i)->value());
+}
+
+void ERRL::VisitArrayLiteral(ArrayLiteral *e) {
+  VisitExpressions(e->values());
+}
+
+void ERRL::VisitThrow(Throw *e) {
+  Visit(e->exception());
+}
+
+void ERRL::VisitCallNew(CallNew *e) {
+  Visit(e->expression());
+  VisitExpressions(e->arguments());
+}
+
+void ERRL::VisitCallRuntime(CallRuntime *e) {
+  VisitExpressions(e->arguments());
+}
+
+void ERRL::VisitBinaryOperation(BinaryOperation *e) {
+  Visit(e->left());
+  if (e->op() == Token::AND || e->op() == Token::OR)
+    VisitConditionally(e->right());
+  else
+    Visit(e->right());
+}
+
+void ERRL::VisitCompareOperation(CompareOperation *e) {
+  Visit(e->left());
+  Visit(e->right());
+}
+
+} }  // namespace v8::internal
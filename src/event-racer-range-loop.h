@@ -0,0 +1,130 @@
+#ifndef V8_EVENT_RACER_RANGE_LOOP_H_
+#define V8_EVENT_RACER_RANGE_LOOP_H_
+
+#include "src/ast.h"
+#include "src/zone.h"
+
+namespace v8 {
+namespace internal {
+
+// Recognizes the simple counted loops, which access array elements by the
+// loop counter, like
+//
+//   for (i = ...; i < n; i += c) { ... a[i] ... }
+//
+// so the ER instrumentation can log a single range access of |a| before
+// the loop, instead of an access per iteration.
+//
+// The counter |i| and the arrays must be stack allocated variables (so
+// they are not changed by other functions), which are not assigned in the
+// body. The counter is advanced by the |next| expression only, by a
+// constant, and it is compared with a bound by the condition, in the
+// direction of the advance. The bound is a number literal or a stack
+// allocated variable, not assigned in the body, so it does not change
+// while the loop runs. The body must not leave the loop with |return|,
+// |break| or a |continue| of an outer loop. The loop may still be cut
+// short by an exception, in which case the range covers more elements
+// than were accessed.
+//
+// Only the property loads, assignments and count operations of |a[i]|,
+// which run on every iteration, are part of the range. The ones under a
+// condition, i.e. in a branch of an |if| or a |?:|, in the right operand
+// of a |&&| or a |||, in the clauses of a |switch|, in the body of a
+// nested loop or in a |catch| block, or the ones after a |continue| of
+// the loop or a |break| out of a labelled block, may not run on some
+// iterations, so folding them would log accesses, which did not happen.
+// These and the other accesses of the arrays are logged as usual.
+//
+// Must be run after the scope analysis, on the unmodified loop.
+class EventRacerRangeLoop : public AstVisitor {
+public:
+  EventRacerRangeLoop(Zone *zone, EventRacerRangeLoop *outer,
+                      uintptr_t stack_limit = 0);
+
+  // Returns true if |loop| is a counted loop, which accesses at least one
+  // array by its counter.
+  bool Analyze(ForStatement *loop);
+
+  // The range loop, which encloses this one, or NULL.
+  EventRacerRangeLoop *outer() const { return outer_; }
+
+  Variable *counter() const { return counter_; }
+  int stride() const { return stride_; }
+
+  // The bound, the counter is compared with. If |bound_var| is NULL, the
+  // bound is the number literal |bound_key|, otherwise it is the variable
+  // |bound_var|.
+  Variable *bound_var() const { return bound_var_; }
+  Literal *bound_key() const { return bound_key_; }
+  // True if the loop runs while the counter is equal to the bound.
+  bool inclusive() const { return inclusive_; }
+
+  int array_count() const { return arrays_.length(); }
+  Variable *array(int i) const { return arrays_[i].var; }
+  bool is_read(int i) const { return arrays_[i].read; }
+  bool is_written(int i) const { return arrays_[i].written; }
+
+  // Returns true if |p| is an element access of this loop or of one of
+  // the enclosing range loops.
+  bool IsRangeAccess(Property *p) const;
+
+#define DECLARE_VISIT(type) void Visit##type(type *node) OVERRIDE;
+  AST_NODE_LIST(DECLARE_VISIT)
+#undef DECLARE_VISIT
+
+private:
+  struct ArrayAccess {
+    Variable *var;
+    bool read;
+    bool written;
+  };
+
+  static bool IsTracked(Variable *var);
+  static Variable *TrackedVar(Expression *expr);
+
+  bool MatchCondition(Expression *cond);
+  bool MatchNext(Statement *next);
+  bool IsAssigned(Variable *var) const;
+  void Assign(Expression *target);
+  void AccessElement(Property *p, bool read, bool written);
+  void Jump(BreakableStatement *target);
+  void Reject() { rejected_ = true; }
+  void VisitIfNotNull(AstNode *node) {
+    if (node != NULL)
+      Visit(node);
+  }
+  // Visits the code, which may not run on every iteration.
+  void VisitConditionally(AstNode *node) {
+    ++conditional_;
+    VisitIfNotNull(node);
+    --conditional_;
+  }
+
+  EventRacerRangeLoop *outer_;
+  ForStatement *loop_;
+  Variable *counter_;
+  int stride_;
+  Variable *bound_var_;
+  Literal *bound_key_;
+  bool inclusive_;
+  bool rejected_;
+  // The depth of the conditionally run code at the current node, and
+  // whether a jump may have skipped the rest of the body.
+  int conditional_;
+  bool jumped_;
+
+  ZoneList<ArrayAccess> arrays_;
+  // The element accesses, which are part of the range.
+  ZoneList<Property*> accesses_;
+  // Variables, assigned in the body.
+  ZoneList<Variable*> assigned_;
+  // Statements in the body, which a |break| or |continue| may target.
+  ZoneList<BreakableStatement*> targets_;
+
+  DEFINE_AST_VISITOR_SUBCLASS_MEMBERS();
+  DISALLOW_COPY_AND_ASSIGN(EventRacerRangeLoop);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_RANGE_LOOP_H_
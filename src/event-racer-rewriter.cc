@@ -1,4 +1,5 @@
 #include "src/compiler.h"
+#include "src/event-racer-log.h"
 #include "src/event-racer-rewriter.h"
 #include "src/scopes.h"
 
@@ -6,21 +7,28 @@ namespace v8 {
 
 namespace internal {
 
-EventRacerRewriter::AstRewriterImpl(CompilationInfo *info)
+EventRacerRewriter::AstRewriterImpl(CompilationInfo *info,
+                                    uintptr_t stack_limit)
   : info_(info),
     current_context_(NULL),
     factory_(info_->ast_value_factory()),
     arg_names_(NULL) {
 
-  InitializeAstRewriter(info->zone());
+  InitializeAstRewriter(info->zone(), stack_limit);
 
   Scope &globals = *info->script_scope();
   AstValueFactory &values = *info->ast_value_factory();
 
 #define FN(fn)                                                          \
   instr_fn_name_[fn] = values.GetOneByteString(#fn);                    \
-  instr_fn_[fn] = globals.DeclareDynamicGlobal(instr_fn_name_[fn]);
+  instr_fn_[fn] = globals.DeclareDynamicGlobal(instr_fn_name_[fn]);     \
+  instr_rt_[fn] = NULL;
   INSTRUMENTATION_FUNCTION_LIST(FN)
+#undef FN
+#define FN(fn, id)                                                      \
+  instr_fn_name_[fn] = values.GetOneByteString("_" #id);                \
+  instr_rt_[fn] = Runtime::FunctionForId(Runtime::kInlineOptimized##id);
+  INSTRUMENTATION_RUNTIME_FUNCTION_LIST(FN)
 #undef FN
   o_string_ = values.GetOneByteString("$obj");
   k_string_ = values.GetOneByteString("$key");
@@ -39,7 +47,12 @@ Expression *EventRacerRewriter::call_runtime(enum InstrumentationFunction fn,
                                              ZoneList<Expression*> *args,
                                              int pos) {
   DCHECK(fn < FN_MAX);
-  return factory_.NewCallRuntime(instr_fn_name_[fn], nullptr, args, pos);
+  // The core logging functions are calls to the C++ runtime, which
+  // appends to the isolate's event log, the rest are calls to the
+  // JavaScript helpers in eventracer.js. The runtime functions are
+  // intrinsics, so optimized code tests the enable counter inline and
+  // calls the runtime only while the collection is enabled.
+  return factory_.NewCallRuntime(instr_fn_name_[fn], instr_rt_[fn], args, pos);
 }
 
 FunctionLiteral *EventRacerRewriter::make_fn(Scope *scope,
@@ -63,6 +76,42 @@ FunctionLiteral *EventRacerRewriter::make_fn(Scope *scope,
   return fn;
 }
 
+// Allocates a site id for a global variable access of kind |kind| (an
+// |EventRacerLog::Op|). The instrumentation passes the id to the runtime
+// instead of the name, which is recorded with the log when the compilation
+// is done. A recompilation reuses the id of the site. The script of a
+// streamed script does not exist yet on the background thread, the script
+// is new anyway.
+Literal *EventRacerRewriter::new_site(int kind, const AstRawString *name,
+                                      int pos) {
+  EventRacerLog *log = info_->isolate()->event_racer_log();
+  EventRacerSite site;
+  if (info_->script().is_null())
+    site.id = log->NewSiteId();
+  else
+    site.id = log->SiteId(info_->script()->id()->value(),
+                          static_cast<EventRacerLog::Op>(kind), pos);
+  site.kind = kind;
+  site.name = name;
+  site.function_id = context() != NULL ? context()->function_id : 0;
+  site.position = pos;
+  info_->AddEventRacerSite(site);
+  return factory_.NewSmiLiteral(site.id, pos);
+}
+
+// Allocates the site of a property access with the key |key|. The property
+// accesses pass the site id along with the name, so the log can sample and
+// deduplicate the events by site. The site name is empty if the key is not
+// a string literal.
+Literal *EventRacerRewriter::prop_site(int kind, const Expression *key,
+                                       int pos) {
+  const AstRawString *name = info_->ast_value_factory()->empty_string();
+  const Literal *lit = key->AsLiteral();
+  if (lit != NULL && lit->raw_value()->IsString())
+    name = lit->raw_value()->AsString();
+  return new_site(kind, name, pos);
+}
+
 Expression *EventRacerRewriter::log_vp(VariableProxy *vp, Expression *value,
                                        enum InstrumentationFunction plain_fn,
                                        enum InstrumentationFunction prop_fn) {
@@ -72,14 +121,21 @@ Expression *EventRacerRewriter::log_vp(VariableProxy *vp, Expression *value,
     // Read/Write of a property of the global object is rewritten into a
     // call to ER_read/ER_write:
     //
-    // |v| => |ER_read("v", v)|
+    // |v| => |ER_read(<site>, v)|
     //  or
-    // |v = ex| => |v = ER_write("v", ex)|
-    args = new (zone()) ZoneList<Expression*>(2, zone());
-    args->Add(factory_.NewStringLiteral(vp->raw_name(), vp->position()),
-              zone());
+    // |v = ex| => |v = ER_write(<site>, ex)|
+    //
+    // where <site> is the site id of the access, see |new_site|.
+    bool write_func = plain_fn == ER_write && value->IsFunctionLiteral();
+    EventRacerLog::Op kind;
+    if (plain_fn == ER_read)
+      kind = EventRacerLog::kRead;
+    else
+      kind = write_func ? EventRacerLog::kWriteFunc : EventRacerLog::kWrite;
+    args = new (zone()) ZoneList<Expression*>(3, zone());
+    args->Add(new_site(kind, vp->raw_name(), vp->position()), zone());
     args->Add(value, zone());
-    if (plain_fn == ER_write && value->IsFunctionLiteral()) {
+    if (write_func) {
       // Special case of function literal assignment - call
       // |ER_writeFunc|, passing as a third argument the function
       // literal identifier.
@@ -94,9 +150,9 @@ Expression *EventRacerRewriter::log_vp(VariableProxy *vp, Expression *value,
     // Read/Write of a context allocated variable is rewritten into a call to
     // ER_readProp/ER_writeProp:
     //
-    // |v| => ER_readProp(ctx, "v", v)|
+    // |v| => ER_readProp(ctx, "v", v, <site>)|
     // or
-    // |v = ex| => |v = ER_writeProp(ctx, "v", ex)|
+    // |v = ex| => |v = ER_writeProp(ctx, "v", ex, <site>)|
     DCHECK(var->IsContextSlot());
     args = new (zone()) ZoneList<Expression*>(1, zone());
     args->Add(
@@ -108,11 +164,15 @@ Expression *EventRacerRewriter::log_vp(VariableProxy *vp, Expression *value,
                               Runtime::FunctionForId(Runtime::kGetContextN),
                               args,
                               vp->position());
-    args = new (zone()) ZoneList<Expression*>(3, zone());
+    args = new (zone()) ZoneList<Expression*>(4, zone());
     args->Add(rtcall, zone());
     args->Add(factory_.NewStringLiteral(vp->raw_name(), vp->position()),
               zone());
     args->Add(value, zone());
+    args->Add(new_site(prop_fn == ER_readProp ? EventRacerLog::kReadProp
+                                              : EventRacerLog::kWriteProp,
+                       vp->raw_name(), vp->position()),
+              zone());
     return call_runtime(prop_fn, args, vp->position());
   }
 }
@@ -153,6 +213,15 @@ Literal *EventRacerRewriter::duplicate_key(const Literal *lit) {
   return NULL;
 }
 
+Expression *EventRacerRewriter::log_prop_object(Expression *obj,
+                                                const Literal *key, int pos) {
+  ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(3, zone());
+  args->Add(obj, zone());
+  args->Add(duplicate_key(key), zone());
+  args->Add(prop_site(EventRacerLog::kReadProp, key, pos), zone());
+  return call_runtime(ER_readPropObject, args, pos);
+}
+
 template<typename T> void rewrite(AstRewriter *w, T *&node) {
   if (node)
     node = node->Accept(w);
@@ -197,13 +266,72 @@ WhileStatement *EventRacerRewriter::doVisit(WhileStatement *st) {
 }
 
 ForStatement *EventRacerRewriter::doVisit(ForStatement *st) {
+  // Find the element accesses by the loop counter before the loop is
+  // modified.
+  EventRacerRangeLoop loop(zone(), context()->range_loop, stack_limit());
+  bool is_range_loop = FLAG_er_range_loops && loop.Analyze(st);
+
   rewrite(this, st->init_);
   rewrite(this, st->cond_);
   rewrite(this, st->next_);
-  rewrite(this, st->body_);
+  {
+    ContextScope _(this);
+    if (is_range_loop)
+      _.range_loop = &loop;
+    rewrite(this, st->body_);
+  }
+  if (is_range_loop)
+    st->init_ = log_range_loop(&loop, st->init_, st->position());
   return st;
 }
 
+// The element accesses of a range loop are logged after the loop
+// initialization, instead of in the body:
+//
+// |for (init; i < n; i++) { ... a[i] ... }|
+// =>
+// |for ({ init; ER_readRange(a, i, n, 1, false); }; i < n; i++) {|
+// |  ... a[i] ...                                                |
+// |}                                                             |
+//
+// The runtime works out the accessed elements from the counter, the
+// bound, the stride and whether the bound is inclusive.
+Block *EventRacerRewriter::log_range_loop(const EventRacerRangeLoop *loop,
+                                          Statement *init, int pos) {
+  Block *blk = factory_.NewBlock(NULL, 1 + 2 * loop->array_count(), false,
+                                 RelocInfo::kNoPosition);
+  if (init != NULL)
+    blk->AddStatement(init, zone());
+
+  for (int i = 0; i < loop->array_count(); ++i) {
+    for (int write = 0; write < 2; ++write) {
+      if (write ? !loop->is_written(i) : !loop->is_read(i))
+        continue;
+      Expression *end;
+      if (loop->bound_var() == NULL)
+        end = duplicate_key(loop->bound_key());
+      else
+        end = factory_.NewVariableProxy(loop->bound_var());
+      ZoneList<Expression*> *args =
+          new (zone()) ZoneList<Expression*>(5, zone());
+      args->Add(factory_.NewVariableProxy(loop->array(i)), zone());
+      args->Add(factory_.NewVariableProxy(loop->counter()), zone());
+      args->Add(end, zone());
+      args->Add(factory_.NewSmiLiteral(loop->stride(), RelocInfo::kNoPosition),
+                zone());
+      args->Add(factory_.NewBooleanLiteral(loop->inclusive(),
+                                           RelocInfo::kNoPosition),
+                zone());
+      blk->AddStatement(
+          factory_.NewExpressionStatement(
+              call_runtime(write ? ER_writeRange : ER_readRange, args, pos),
+              pos),
+          zone());
+    }
+  }
+  return blk;
+}
+
 ForInStatement *EventRacerRewriter::doVisit(ForInStatement *st) {
   rewrite(this, st->subject_);
   rewrite(this, st->body_);
@@ -256,16 +384,33 @@ IfStatement *EventRacerRewriter::doVisit(IfStatement *st) {
   return st;
 }
 
+// Emits a statement at the start of a catch or finally block, to log the
+// exits of the functions, which were unwound by an exception.
+void EventRacerRewriter::log_unwind(Block *block) {
+  ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(1, zone());
+  args->Add(factory_.NewSmiLiteral(context()->function_id,
+                                   RelocInfo::kNoPosition),
+            zone());
+  block->statements()->InsertAt(
+      0,
+      factory_.NewExpressionStatement(
+          call_runtime(ER_unwind, args, RelocInfo::kNoPosition),
+          RelocInfo::kNoPosition),
+      zone());
+}
+
 TryCatchStatement *EventRacerRewriter::doVisit(TryCatchStatement *st) {
   rewrite(this, st->try_block_);
   ContextScope _(this, st->scope());
   rewrite(this, st->catch_block_);
+  log_unwind(st->catch_block_);
   return st;
 }
 
 TryFinallyStatement *EventRacerRewriter::doVisit(TryFinallyStatement *st) {
   rewrite(this, st->try_block_);
   rewrite(this, st->finally_block_);
+  log_unwind(st->finally_block_);
   return st;
 }
 
@@ -299,74 +444,42 @@ Expression* EventRacerRewriter::doVisit(Property *p) {
   // Read of a property of an object is rewritten into a call to
   // ER_readProp.
 
-  // If the key is a literal, the Property is rewritten into a call
-  // like:
+  // If the key is a literal, the object expression is wrapped into a
+  // call to the runtime function ER_readPropObject, which logs the
+  // read and returns the object itself:
 
   // |obj.key|
   //  =>
-  // |(function($obj) { return ER_readProp($obj, "key", $obj.key); })(obj)|
+  // |ER_readPropObject(obj, "key", <site>).key|
 
   // If the key as a general expression, the Property is rewritten into
   // a call to the runtime function ER_readPropIdx:
 
   // |arr[idx]|
   // =>
-  // ER_readPropIdx(arr, idx)
+  // ER_readPropIdx(arr, idx, <site>)
 
-  // The function literal is needed in order to ensure |obj| and |key|
-  // are evaluated exactly once. Passing the expressions as parameters
-  // avoids capturing variabes in the inner closure, which may cause
-  // them to be context allocated.
+  // Both forms ensure |obj| and |key| are evaluated exactly once. The
+  // former keeps the property load in the instrumented function, so it
+  // still benefits from the inline caches and does not need an extra
+  // closure.
 
-  ZoneList<Expression*> *args;
   Expression *obj = p->obj(), *key = p->key();
+  if (obj->IsSuperReference() || is_local_object(obj))
+    return p;
 
-  if (is_literal_key(key)) {
-    ScopeHack *scope;
-    ZoneList<Statement*> *body;
-
-    DCHECK(obj->position() < p->position());
-    scope = NewScope(context()->scope);
-    scope->set_start_position(p->position());
-    scope->set_end_position(p->position() + 1);
-
-    // Declare the parameter of the new function.
-    Variable *o_parm = scope->DeclareParameter(o_string_, VAR);
-    o_parm->AllocateTo(Variable::PARAMETER, 0);
-
-    // The |$obj| parameter is referenced in two places, so is the
-    // |key| parameter. Create separate AST nodes for each reference.
-    Expression *o[2], *k[2];
-    o[0] = factory_.NewVariableProxy(o_parm);
-    o[1] = factory_.NewVariableProxy(o_parm);
-    k[0] = duplicate_key(key->AsLiteral());
-    k[1] = duplicate_key(key->AsLiteral());
-
-    // Setup arguments of the call to |ER_readProp|.
-    args = new (zone()) ZoneList<Expression*>(3, zone());
-    args->Add(o[0], zone());
-    args->Add(k[0], zone());
-    args->Add(factory_.NewProperty(o[1], k[1], RelocInfo::kNoPosition), zone());
+  if (is_range_access(p))
+    return p;
 
-    // Create the return statement.
-    body = new (zone()) ZoneList<Statement*>(1, zone());
-    body->Add(
-        factory_.NewReturnStatement(
-            call_runtime(ER_readProp, args, RelocInfo::kNoPosition),
-            RelocInfo::kNoPosition),
-        zone());
-
-    // Define the new function and build the call.
-    FunctionLiteral *fn = make_fn(scope, body, 1 + !is_literal_key(key),
-                                  RelocInfo::kNoPosition);
-    args = new (zone()) ZoneList<Expression*>(1, zone());
-    args->Add(obj, zone());
-    return factory_.NewCall(fn, args, p->position() + 1);
+  if (is_literal_key(key)) {
+    p->obj_ = log_prop_object(obj, key->AsLiteral(), p->position());
+    return p;
   } else {
     // Build a call to |ER_readPropIdx|
-    args = new (zone()) ZoneList<Expression*>(2, zone());
+    ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(3, zone());
     args->Add(obj, zone());
     args->Add(key, zone());
+    args->Add(prop_site(EventRacerLog::kReadProp, key, p->position()), zone());
     return call_runtime(ER_readPropIdx, args, obj->position());
   }
 }
@@ -375,22 +488,14 @@ Call* EventRacerRewriter::doVisit(Call *c) {
   // Non-property calls aren't treated specially.
   if (!c->expression_->IsProperty()) {
     // Do not instrument direct |eval| calls, as the instrumentation
-    // changes them into indirect calls and the semantics differ.
-    if (c->GetCallType(zone()->isolate()) != Call::POSSIBLY_EVAL_CALL)
+    // changes them into indirect calls and the semantics differ. The name
+    // is compared raw, as the rewriter may run before the internalization.
+    if (!is_possibly_eval(c->expression()))
       rewrite(this, c->expression_);
     rewrite(this, c->arguments());
     return c;
   }
 
-  // Call of a property is instrumented like:
-  //
-  // |o.f(e0, e2, ..., en)|
-  // =>
-  // |(function($obj, $key, $a0, $a1, ..., $an) {|
-  // |   ER_readProp($obj, $key, $obj.$key);     |
-  // |   return $obj.$key($a0, $a1, ..., $an);   |
-  // |})(o, f, e0, e1, ..., en)                  |
-  //
   // Property calls are treated by the compiler in a special manner -
   // the callee gets a receiver object - hence we should end up with an
   // instrumented expression, which also contains an analoguos property
@@ -400,10 +505,32 @@ Call* EventRacerRewriter::doVisit(Call *c) {
   rewrite(this, p->key_);
   rewrite(this, c->arguments());
 
+  Expression *obj = p->obj(), *key = p->key();
+  if (obj->IsSuperReference() || is_local_object(obj))
+    return c;
+
+  if (is_literal_key(key)) {
+    // Call of a property with a literal key is instrumented by logging
+    // the read in the receiver expression:
+    //
+    // |o.f(e0, e2, ..., en)|
+    // =>
+    // |ER_readPropObject(o, "f", <site>).f(e0, e1, ..., en)|
+    p->obj_ = log_prop_object(obj, key->AsLiteral(), p->position());
+    return c;
+  }
+
+  // Call of a property with a computed key is instrumented like:
+  //
+  // |o[k](e0, e2, ..., en)|
+  // =>
+  // |(function($obj, $key, $a0, $a1, ..., $an) {|
+  // |   ER_readProp($obj, $key, $obj[$key], <site>);|
+  // |   return $obj[$key]($a0, $a1, ..., $an);  |
+  // |})(o, k, e0, e1, ..., en)                  |
   ScopeHack *scope;
   ZoneList<Expression*> *args;
   ZoneList<Statement*> *body;
-  Expression *obj = p->obj(), *key = p->key();
   const int n = c->arguments()->length();
 
   DCHECK(obj->position() < p->position());
@@ -415,17 +542,13 @@ Call* EventRacerRewriter::doVisit(Call *c) {
   // Declare parameters of the new function.
   Variable *o_parm = scope->DeclareParameter(o_string_, VAR);
   o_parm->AllocateTo(Variable::PARAMETER, 0);
-
-  Variable *k_parm = NULL;
-  if (!is_literal_key(key)) {
-    k_parm = scope->DeclareParameter(k_string_, VAR);
-    k_parm->AllocateTo(Variable::PARAMETER, 1);
-  }
+  Variable *k_parm = scope->DeclareParameter(k_string_, VAR);
+  k_parm->AllocateTo(Variable::PARAMETER, 1);
 
   ensure_arg_names(n);
   for (int i = 0; i < n; ++i) {
     Variable *parm = scope->DeclareParameter(arg_names_->at(i), VAR);
-    parm->AllocateTo(Variable::PARAMETER, i + 1 + !is_literal_key(key));
+    parm->AllocateTo(Variable::PARAMETER, i + 2);
   }
 
   // The |$obj| parameter is referenced in three places, so is the
@@ -433,17 +556,15 @@ Call* EventRacerRewriter::doVisit(Call *c) {
   Expression *o[3], *k[3];
   for (int i = 0; i < 3; ++i) {
     o[i] = factory_.NewVariableProxy(o_parm);
-    if (is_literal_key(key))
-      k[i] = duplicate_key(key->AsLiteral());
-    else
-      k[i] = factory_.NewVariableProxy(k_parm);
+    k[i] = factory_.NewVariableProxy(k_parm);
   }
 
   // Setup arguments of the call to |ER_readProp|.
-  args = new (zone()) ZoneList<Expression*>(3, zone());
+  args = new (zone()) ZoneList<Expression*>(4, zone());
   args->Add(o[0], zone());
   args->Add(k[0], zone());
   args->Add(factory_.NewProperty(o[1], k[1], RelocInfo::kNoPosition), zone());
+  args->Add(prop_site(EventRacerLog::kReadProp, key, p->position()), zone());
 
   body = new (zone()) ZoneList<Statement*>(1, zone());
   body->Add(
@@ -454,12 +575,8 @@ Call* EventRacerRewriter::doVisit(Call *c) {
 
   // Build the inner property call.
   args = new (zone()) ZoneList<Expression *>(n, zone());
-  for (int i = 0; i < n; ++i) {
-    args->Add(
-        factory_.NewVariableProxy(
-            scope->parameter(i + 1 + !is_literal_key(key))),
-        zone());
-  }
+  for (int i = 0; i < n; ++i)
+    args->Add(factory_.NewVariableProxy(scope->parameter(i + 2)), zone());
   body->Add(
       factory_.NewReturnStatement(
           factory_.NewCall(
@@ -470,12 +587,10 @@ Call* EventRacerRewriter::doVisit(Call *c) {
 
 
   // Define the new function and build the call.
-  FunctionLiteral *fn = make_fn(scope, body, n + 1 + !is_literal_key(key),
-                                RelocInfo::kNoPosition);
+  FunctionLiteral *fn = make_fn(scope, body, n + 2, RelocInfo::kNoPosition);
   args = new (zone()) ZoneList<Expression*>(n + 2, zone());
   args->Add(obj, zone());
-  if (!is_literal_key(key))
-    args->Add(key, zone());
+  args->Add(key, zone());
   for (int i = 0; i < n; ++i)
     args->Add(c->arguments()->at(i), zone());
 
@@ -496,9 +611,13 @@ CallRuntime* EventRacerRewriter::doVisit(CallRuntime *c) {
   // function |initializeVarGlobal|.
   const Runtime::Function *fn = c->function();
   if (fn && fn->function_id == Runtime::kInitializeVarGlobal) {
-    ZoneList<Expression *> *args = new(zone()) ZoneList<Expression*>(2, zone());
-    args->Add(duplicate_key(c->arguments()->at(0)->AsLiteral()), zone());
+    Literal *name = c->arguments()->at(0)->AsLiteral();
     Expression *value = c->arguments()->at(2);
+    ZoneList<Expression *> *args = new(zone()) ZoneList<Expression*>(3, zone());
+    args->Add(new_site(value->IsFunctionLiteral() ? EventRacerLog::kWriteFunc
+                                                  : EventRacerLog::kWrite,
+                       name->raw_value()->AsString(), name->position()),
+              zone());
     args->Add(value, zone());
     enum InstrumentationFunction fn;
     if (value->IsFunctionLiteral()) {
@@ -536,13 +655,15 @@ Expression* EventRacerRewriter::doVisit(UnaryOperation *op) {
       // |delete obj.key|
       // =>
       // |(function($obj) {                  |
-      // |   ER_deleteProp(obj, "key");      |
+      // |   ER_deleteProp(obj, "key", <site>);|
       // |   return delete $obj.key;         |
       // |})(obj)                            |
       //
       // or, if the key is a general expression, with a call to the
       // function |ER_deletePropIdx|
       Expression *obj = p->obj_, *key = p->key_;
+      if (is_local_object(obj))
+        return op;
       if (is_literal_key(key)) {
 
         DCHECK(op->position() < p->position());
@@ -563,9 +684,11 @@ Expression* EventRacerRewriter::doVisit(UnaryOperation *op) {
         }
 
         // Setup arguments of the call to |ER_deleteProp|.
-        args = new (zone()) ZoneList<Expression*>(2, zone());
+        args = new (zone()) ZoneList<Expression*>(3, zone());
         args->Add(o[0], zone());
         args->Add(k[0], zone());
+        args->Add(prop_site(EventRacerLog::kDeleteProp, key, p->position()),
+                  zone());
 
         body = new (zone()) ZoneList<Statement*>(2, zone());
         body->Add(
@@ -590,9 +713,11 @@ Expression* EventRacerRewriter::doVisit(UnaryOperation *op) {
         args->Add(obj, zone());
         return factory_.NewCall(fn, args, p->position());
       } else {
-        args = new (zone()) ZoneList<Expression*>(2, zone());
+        args = new (zone()) ZoneList<Expression*>(3, zone());
         args->Add(obj, zone());
         args->Add(key, zone());
+        args->Add(prop_site(EventRacerLog::kDeleteProp, key, p->position()),
+                  zone());
         return call_runtime(context()->scope->strict_mode() == SLOPPY
                             ? ER_deletePropIdx : ER_deletePropIdxStrict,
                             args,
@@ -607,10 +732,10 @@ Expression* EventRacerRewriter::doVisit(UnaryOperation *op) {
         //
         // |delete v|
         // =>
-        // |(function() {      |
-        // |   ER_delete("v"); |
-        // |   return delete v;|
-        // |})();              |
+        // |(function() {         |
+        // |   ER_delete(<site>); |
+        // |   return delete v;   |
+        // |})();                 |
         DCHECK(op->position() < vp->position());
         scope = NewScope(context()->scope);
         scope->set_start_position(op->position());
@@ -618,7 +743,8 @@ Expression* EventRacerRewriter::doVisit(UnaryOperation *op) {
 
         // Call |ER_delete|
         args = new (zone()) ZoneList<Expression*>(1, zone());
-        args->Add(factory_.NewStringLiteral(vp->raw_name(), vp->position()),
+        args->Add(new_site(EventRacerLog::kDelete, vp->raw_name(),
+                           vp->position()),
                   zone());
 
         body = new (zone()) ZoneList<Statement*>(2, zone());
@@ -673,13 +799,13 @@ Expression* EventRacerRewriter::rewriteIncDecVariable(
   //
   // |++x|
   // =>
-  // |(function() { let $v = ++x; ER_write("x", x); return $v; })()|
+  // |(function() { let $v = ++x; ER_write(<site>, x); return $v; })()|
   //
   // Post-increment/decrement of a variable is instrumented like:
   //
   // |x++|
   // =>
-  // |(function() { let $v = x++; ER_write("x", x); return $v; })()|
+  // |(function() { let $v = x++; ER_write(<site>, x); return $v; })()|
   //
   ScopeHack *scope = NewScope(context()->scope);
   scope->set_start_position(vp->position());
@@ -734,7 +860,7 @@ Expression *EventRacerRewriter::rewriteIncDecProperty(
   // =>
   // |(function($obj) {                            |
   // |  let $v = ++$obj.key;                       |
-  // |  ER_writeProp($obj, "key", $obj.key);       |
+  // |  ER_writeProp($obj, "key", $obj.key, <site>);|
   // |  return $v;                                 |
   // |})(obj)                                      |
   //
@@ -743,7 +869,7 @@ Expression *EventRacerRewriter::rewriteIncDecProperty(
   //
   // |++obj[key]|
   // =>
-  // |ER_preIncProp(obj, key)|
+  // |ER_preIncProp(obj, key, <site>)|
   //
   // Post-increment/decrement of a property is instrumented like:
   //
@@ -751,7 +877,7 @@ Expression *EventRacerRewriter::rewriteIncDecProperty(
   // =>
   // |(function($obj) {                            |
   // |  let $v = $obj.key++;                       |
-  // |  ER_writeProp($obj, "key", $obj.key);       |
+  // |  ER_writeProp($obj, "key", $obj.key, <site>);|
   // |  return $v;                                 |
   // |})(obj)                                      |
   //
@@ -760,7 +886,7 @@ Expression *EventRacerRewriter::rewriteIncDecProperty(
   //
   // |obj[key]++|
   // =>
-  // |ER_postIncProp(obj, key)|
+  // |ER_postIncProp(obj, key, <site>)|
   Expression *obj = p->obj_, *key = p->key_;
   if (is_literal_key(key)) {
     DCHECK(obj->position() < p->position());
@@ -807,11 +933,17 @@ Expression *EventRacerRewriter::rewriteIncDecProperty(
     ZoneList<Statement*> *body = new (zone()) ZoneList<Statement*>(2, zone());
     body->Add(blk, zone());
 
-    // Setup arguments of the call to |ER_writeProp|.
-    ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(2, zone());
+    // Log the write.
+    ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(4, zone());
     args->Add(o[1], zone());
     args->Add(k[1], zone());
     args->Add(factory_.NewProperty(o[2], k[2], RelocInfo::kNoPosition), zone());
+    args->Add(prop_site(EventRacerLog::kWriteProp, key, p->position()), zone());
+    body->Add(
+        factory_.NewExpressionStatement(
+            call_runtime(ER_writeProp, args, RelocInfo::kNoPosition),
+            RelocInfo::kNoPosition),
+        zone());
 
     // Create the return statement.
     body->Add(factory_.NewReturnStatement(factory_.NewVariableProxy(value),
@@ -835,9 +967,10 @@ Expression *EventRacerRewriter::rewriteIncDecProperty(
       },
     };
     ZoneList<Expression *> *args =
-        new (zone()) ZoneList<Expression*>(2, zone());
+        new (zone()) ZoneList<Expression*>(3, zone());
     args->Add(obj, zone());
     args->Add(key, zone());
+    args->Add(prop_site(EventRacerLog::kWriteProp, key, p->position()), zone());
     InstrumentationFunction fn =
         fntab[is_prefix][op == Token::DEC][context()->scope->strict_mode() == STRICT];
     return call_runtime(fn, args, pos);
@@ -859,6 +992,8 @@ Expression* EventRacerRewriter::doVisit(CountOperation *op) {
   Property *p = op->expression_->AsProperty();
   rewrite(this, p->obj_);
   rewrite(this, p->key_);
+  if (is_local_object(p->obj_) || is_range_access(p))
+    return op;
   return rewriteIncDecProperty(op->op(), op->is_prefix(), p, op->position());
 }
 
@@ -900,13 +1035,13 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
     //
     // |v = e|
     // =>
-    // |v = ER_write("v", e);|
+    // |v = ER_write(<site>, e);|
     //
     // or, if, it's a compound assignment, like:
     //
     // |v += e|
     // =>
-    // |v = ER_write("v", v + e);|
+    // |v = ER_write(<site>, v + e);|
 
     Expression *value;
     if (op->is_compound()) {
@@ -925,23 +1060,26 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
     DCHECK(op->target_->IsProperty());
     Property *p = op->target_->AsProperty();
     Expression *obj = p->obj_, *key = p->key_;
+    if (is_local_object(obj) || is_range_access(p))
+      return op;
     if (is_literal_key(key)) {
       // If the LHS is a property expression with a literal key, the
       // assignment is rewritten like:
       //
       // |obj.key = e|
       // =>
-      // |function($obj, $v) {                              |
-      // |  return $obj.key = ER_writeProp($obj, "key", $v);|
-      // |}                                                 |
+      // |function($obj, $v) {                                      |
+      // |  return $obj.key = ER_writeProp($obj, "key", $v, <site>);|
+      // |}                                                         |
       //
       // or, if it's a compound assignment, like:
       //
       // |obj.key += e|
       // =>
-      // |function($obj, $v) {                                         |
-      // |  return $obj.key = ER_writeProp($obj, "key", $obj.key + $v);|
-      // |}                                                            |
+      // |function($obj, $v) {                                        |
+      // |  return $obj.key = ER_writeProp($obj, "key", $obj.key + $v,|
+      // |                                 <site>);                   |
+      // |}                                                           |
       ScopeHack *scope;
       ZoneList<Statement*> *body;
 
@@ -976,7 +1114,7 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
 
       // Setup arguments of the call to |ER_writeProp|.
       enum InstrumentationFunction fn = ER_writeProp;
-      args = new (zone()) ZoneList<Expression*>(3, zone());
+      args = new (zone()) ZoneList<Expression*>(5, zone());
       args->Add(o[0], zone());
       args->Add(k[0], zone());
       if (op->is_compound()) {
@@ -1001,6 +1139,10 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
               zone());
         }
       }
+      args->Add(prop_site(fn == ER_writePropFunc ? EventRacerLog::kWritePropFunc
+                                                 : EventRacerLog::kWriteProp,
+                          key, p->position()),
+                zone());
 
       // Create the return statement.
       body = new (zone()) ZoneList<Statement*>(1, zone());
@@ -1026,15 +1168,16 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
       //
       // |arr[idx] = e|
       // =>
-      // |ER_writePropIdx(arr, idx, e)|
+      // |ER_writePropIdx(arr, idx, e, <site>)|
       //
       // or, if it's a compound assignment, like:
       //
       // |arr[idx] += e|
       // =>
-      // |(function($obj, $key, $v) {                                      |
-      //     return $obj[$key] = ER_writeProp($obj, $key, $obj[$key] + $v);|
-      // })(arr, idx, e);                                                  |
+      // |(function($obj, $key, $v) {                                     |
+      // |  return $obj[$key] = ER_writeProp($obj, $key, $obj[$key] + $v, |
+      // |                                   <site>);                     |
+      // |})(arr, idx, e);                                                |
       if (op->is_compound()) {
         ScopeHack *scope;
         ZoneList<Statement*> *body;
@@ -1064,7 +1207,7 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
         v = factory_.NewVariableProxy(v_parm);
 
         // Setup arguments of the call to |ER_writeProp|.
-        args = new (zone()) ZoneList<Expression*>(3, zone());
+        args = new (zone()) ZoneList<Expression*>(4, zone());
         args->Add(o[0], zone());
         args->Add(k[0], zone());
         args->Add(
@@ -1073,6 +1216,8 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
                 factory_.NewProperty(o[2], k[2], RelocInfo::kNoPosition),
                 v, op->position()),
             zone());
+        args->Add(prop_site(EventRacerLog::kWriteProp, key, p->position()),
+                  zone());
 
         // Create the return statement.
         body = new (zone()) ZoneList<Statement*>(1, zone());
@@ -1095,7 +1240,7 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
         return factory_.NewCall(fn, args, op->position());
       } else {
         enum InstrumentationFunction fn;
-        args = new (zone()) ZoneList<Expression*>(3, zone());
+        args = new (zone()) ZoneList<Expression*>(5, zone());
         args->Add(obj, zone());
         args->Add(key, zone());
         args->Add(op->value_, zone());
@@ -1105,11 +1250,16 @@ Expression* EventRacerRewriter::doVisit(Assignment *op) {
                   op->value_->AsFunctionLiteral()->function_id(),
                   RelocInfo::kNoPosition),
               zone());
+          args->Add(prop_site(EventRacerLog::kWritePropFunc, key,
+                              p->position()),
+                    zone());
           if (context()->scope->strict_mode() == SLOPPY)
             fn = ER_writePropIdxFunc;
           else
             fn = ER_writePropIdxFuncStrict;
         } else {
+          args->Add(prop_site(EventRacerLog::kWriteProp, key, p->position()),
+                    zone());
           if (context()->scope->strict_mode() == SLOPPY)
             fn = ER_writePropIdx;
           else
@@ -1138,7 +1288,16 @@ FunctionLiteral* EventRacerRewriter::doVisit(FunctionLiteral *lit) {
   else
     lit->initialize_function_id(zone());
 
+  // Find the objects, which do not escape the function, before the body
+  // is modified.
+  EventRacerEscapeAnalysis escapes(zone(), stack_limit());
+  if (FLAG_er_escape_analysis)
+    escapes.Analyze(lit);
+
   ContextScope _(this, lit->scope());
+  _.escapes = FLAG_er_escape_analysis ? &escapes : NULL;
+  _.range_loop = NULL;
+  _.function_id = lit->function_id();
   rewrite(this, lit->scope()->declarations());
 
   bool empty_body = !lit->body() || lit->body()->length() == 0;
@@ -1159,8 +1318,9 @@ FunctionLiteral* EventRacerRewriter::doVisit(FunctionLiteral *lit) {
         FunctionDeclaration *fndcl = dcls[i]->AsFunctionDeclaration();
         ZoneList<Expression*> *args =
             new (zone()) ZoneList<Expression*>(3, zone());
-        args->Add(factory_.NewStringLiteral(fndcl->proxy()->raw_name(),
-                                            fndcl->proxy()->position()),
+        args->Add(new_site(EventRacerLog::kWriteFunc,
+                           fndcl->proxy()->raw_name(),
+                           fndcl->proxy()->position()),
                   zone());
         args->Add(factory_.NewNullLiteral(RelocInfo::kNoPosition), zone());
         args->Add(factory_.NewSmiLiteral(fndcl->fun()->function_id(),
@@ -1179,29 +1339,12 @@ FunctionLiteral* EventRacerRewriter::doVisit(FunctionLiteral *lit) {
   if (empty_body)
     return lit;
 
-  // Emit a statement to log a function entry.
-  int scriptId = -1, startLine = -1, endLine = -1;
-  if (!info_->script().is_null()) {
-    scriptId = info_->script()->id()->value();
-    startLine = Script::GetLineNumber(info_->script(),
-                                      lit->scope()->start_position())
-                - info_->script()->line_offset()->value();
-    endLine = Script::GetLineNumber(info_->script(),
-                                    lit->scope()->end_position())
-              - info_->script()->line_offset()->value();
-  }
-  ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(3, zone());
-  if (lit->raw_name()->length()) {
-    args->Add(factory_.NewStringLiteral(lit->raw_name(), lit->position()),
-              zone());
-  } else {
-    args->Add(factory_.NewNullLiteral(RelocInfo::kNoPosition), zone());
-  }
-  args->Add(factory_.NewSmiLiteral(scriptId, RelocInfo::kNoPosition), zone());
+  // Emit a statement to log a function entry. The log takes the name,
+  // script and line numbers of the function from the calling frame, the
+  // first time the function is entered.
+  ZoneList<Expression*> *args = new (zone()) ZoneList<Expression*>(1, zone());
   args->Add(factory_.NewSmiLiteral(lit->function_id(), RelocInfo::kNoPosition),
             zone());
-  args->Add(factory_.NewSmiLiteral(startLine, RelocInfo::kNoPosition), zone());
-  args->Add(factory_.NewSmiLiteral(endLine, RelocInfo::kNoPosition), zone());
   Statement *st =
       factory_.NewExpressionStatement(
           call_runtime(ER_enterFunction, args, lit->position()),
@@ -1222,269 +1365,5 @@ FunctionLiteral* EventRacerRewriter::doVisit(FunctionLiteral *lit) {
   }
   return lit;
 }
-
-
-// -----------------------------------------------------------------------------
-void AstSlotCounter::add_materialized_literal(MaterializedLiteral *lit) {
-  lit->set_literal_index(state_->materialized_literal_count++);
-}
-
-template<typename T> void traverse(AstVisitor *v, T *node) {
-  if (node)
-    node->Accept(v);
-}
-
-template<typename T> void traverse(AstVisitor *v, ZoneList<T *> *lst) {
-  if (lst) {
-    const int n = lst->length();
-    for (int i = 0; i < n; ++i)
-      lst->at(i)->Accept(v);
-  }
-}
-
-#define AST_LEAF_NODE_LIST(V)                   \
-  V(ModuleUrl)                                  \
-  V(ModulePath)                                 \
-  V(DebuggerStatement)                          \
-  V(ContinueStatement)                          \
-  V(BreakStatement)                             \
-  V(EmptyStatement)                             \
-  V(Literal)                                    \
-  V(NativeFunctionLiteral)                      \
-  V(ThisFunction)
-
-
-#define LEAF_VISIT(type)                        \
-  void AstSlotCounter::Visit##type(type *) {}
-  AST_LEAF_NODE_LIST(LEAF_VISIT)
-#undef LEAF_VISIT
-
-void AstSlotCounter::VisitVariableDeclaration(VariableDeclaration *dcl) {
-  traverse(this, dcl->proxy());
-}
-
-void AstSlotCounter::VisitFunctionDeclaration(FunctionDeclaration *dcl) {
-  traverse(this, dcl->proxy());
-  traverse(this, dcl->fun());
-}
-
-void AstSlotCounter::VisitModuleDeclaration(ModuleDeclaration *dcl) {
-  traverse(this, dcl->proxy());
-  traverse(this, dcl->module());
-}
-
-void AstSlotCounter::VisitImportDeclaration(ImportDeclaration *dcl) {
-  traverse(this, dcl->proxy());
-  // FIXME: traverse(this, dcl->module());
-}
-
-void AstSlotCounter::VisitExportDeclaration(ExportDeclaration *dcl) {
-  traverse(this, dcl->proxy());
-}
-
-void AstSlotCounter::VisitModuleLiteral(ModuleLiteral *mod) {
-  traverse(this, mod->body());
-}
-
-void AstSlotCounter::VisitModuleVariable(ModuleVariable *mod) {
-  traverse(this, mod->proxy());
-}
-
-void AstSlotCounter::VisitModuleStatement(ModuleStatement *st) {
-  traverse(this, st->proxy());
-  traverse(this, st->body());
-}
-
-void AstSlotCounter::VisitBlock(Block *blk) {
-  if (blk->scope())
-    traverse(this, blk->scope()->declarations());
-  traverse(this, blk->statements());
-}
-
-void AstSlotCounter::VisitExpressionStatement(ExpressionStatement *st) {
-  traverse(this, st->expression());
-}
-
-void AstSlotCounter::VisitDoWhileStatement(DoWhileStatement *st) {
-  traverse(this, st->cond());
-  traverse(this, st->body());
-}
-
-void AstSlotCounter::VisitWhileStatement(WhileStatement *st) {
-  traverse(this, st->cond());
-  traverse(this, st->body());
-}
-
-void AstSlotCounter::VisitForStatement(ForStatement *st) {
-  traverse(this, st->init());
-  traverse(this, st->cond());
-  traverse(this, st->next());
-  traverse(this, st->body());
-}
-
-void AstSlotCounter::VisitForInStatement(ForInStatement *st) {
-  traverse(this, st->each());
-  traverse(this, st->subject());
-  traverse(this, st->body());
-}
-
-void AstSlotCounter::VisitForOfStatement(ForOfStatement *st) {
-  traverse(this, st->each());
-  traverse(this, st->subject());
-  traverse(this, st->body());
-  traverse(this, st->assign_iterator());
-  traverse(this, st->next_result());
-  traverse(this, st->result_done());
-  traverse(this, st->assign_each());
-}
-
-void AstSlotCounter::VisitReturnStatement(ReturnStatement *st) {
-  traverse(this, st->expression());
-}
-
-void AstSlotCounter::VisitWithStatement(WithStatement *st) {
-  traverse(this, st->expression());
-  traverse(this, st->statement());
-}
-
-void AstSlotCounter::VisitCaseClause(CaseClause *ex) {
-  if (!ex->is_default())
-    traverse(this, ex->label());
-  traverse(this, ex->statements());
-}
-
-void AstSlotCounter::VisitSwitchStatement(SwitchStatement *st) {
-  traverse(this, st->tag());
-  traverse(this, st->cases());
-}
-
-void AstSlotCounter::VisitIfStatement(IfStatement *st) {
-  traverse(this, st->condition());
-  traverse(this, st->then_statement());
-  traverse(this, st->else_statement());
-}
-
-void AstSlotCounter::VisitTryCatchStatement(TryCatchStatement *st) {
-  traverse(this, st->try_block());
-  traverse(this, st->catch_block());
-}
-
-void AstSlotCounter::VisitTryFinallyStatement(TryFinallyStatement *st) {
-  traverse(this, st->try_block());
-  traverse(this, st->finally_block());
-}
-
-void AstSlotCounter::VisitObjectLiteral(ObjectLiteral *lit) {
-  add_materialized_literal(lit);
-  if (lit->properties()) {
-    ZoneList<ObjectLiteral::Property *> &ps = *lit->properties();
-    for (int i = 0; i < ps.length(); ++i)
-      traverse(this, ps[i]->value());
-  }
-}
-
-void AstSlotCounter::VisitArrayLiteral(ArrayLiteral *lit) {
-  add_materialized_literal(lit);
-  traverse(this, lit->values());
-}
-
-void AstSlotCounter::VisitVariableProxy(VariableProxy *vp) {
-}
-
-void AstSlotCounter::VisitProperty(Property *p) {
-  traverse(this, p->obj());
-  traverse(this, p->key());
-}
-
-void AstSlotCounter::VisitCall(Call *c) {
-  traverse(this, c->expression());
-  traverse(this, c->arguments());
-}
-
-void AstSlotCounter::VisitCallNew(CallNew *c) {
-  traverse(this, c->expression());
-  traverse(this, c->arguments());
-}
-
-void AstSlotCounter::VisitCallRuntime(CallRuntime *c) {
-  traverse(this, c->arguments());
-}
-
-void AstSlotCounter::VisitUnaryOperation(UnaryOperation *op) {
-  traverse(this, op->expression());
-}
-
-void AstSlotCounter::VisitBinaryOperation(BinaryOperation *op) {
-  traverse(this, op->left());
-  traverse(this, op->right());
-}
-
-void AstSlotCounter::VisitCountOperation(CountOperation *op) {
-  traverse(this, op->expression());
-}
-
-void AstSlotCounter::VisitCompareOperation(CompareOperation *op) {
-  traverse(this, op->left());
-  traverse(this, op->right());
-}
-
-void AstSlotCounter::VisitSuperReference(SuperReference *sup) {
-  traverse(this, sup->this_var());
-}
-
-void AstSlotCounter::VisitConditional(Conditional *op) {
-  traverse(this, op->condition());
-  traverse(this, op->then_expression());
-  traverse(this, op->else_expression());
-}
-
-void AstSlotCounter::VisitAssignment(Assignment *op) {
-  if (op->is_compound())
-    traverse(this, op->binary_operation());
-  else {
-    traverse(this, op->target());
-    traverse(this, op->value());
-  }
-}
-
-void AstSlotCounter::VisitYield(Yield *op) {
-  // FIXME:  if (op->yield_kind() == Yield::SUSPEND || op->yield_kind() == Yield::FINAL)
-  traverse(this, op->expression());
-}
-
-void AstSlotCounter::VisitThrow(Throw *op) {
-  traverse(this, op->exception());
-}
-
-void AstSlotCounter::VisitRegExpLiteral(RegExpLiteral *lit) {
-  add_materialized_literal(lit);
-}
-
-void AstSlotCounter::VisitFunctionLiteral(FunctionLiteral *fn) {
-  if (!fn->body())
-    return;
-
-  FunctionState state;
-  begin_function(&state);
-  Scope *scope = fn->scope();
-  if (scope->is_function_scope())
-    traverse(this, scope->function());
-  traverse(this, scope->declarations());
-  traverse(this, fn->body());
-  fn->set_materialized_literal_count(state.materialized_literal_count - JSFunction::kLiteralsPrefixSize);
-
-  end_function();
-}
-
-void AstSlotCounter::VisitClassLiteral(ClassLiteral *cls) {
-  traverse(this, cls->constructor());
-  if (cls->properties()) {
-    ZoneList<ClassLiteral::Property *> &ps = *cls->properties();
-    for (int i = 0; i < ps.length(); ++i)
-      traverse(this, ps[i]->value());
-  }
-}
-
-AstSlotCounter::FunctionState AstSlotCounter::FunctionState::guard;
 
 } } // namespace v8::internal
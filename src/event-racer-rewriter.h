@@ -2,6 +2,8 @@
 #define V8_EVENT_RACER_REWRITER_H_
 
 #include "src/ast.h"
+#include "src/event-racer-escape-analysis.h"
+#include "src/event-racer-range-loop.h"
 #include "src/scopes.h"
 
 namespace v8 {
@@ -60,6 +62,7 @@ namespace internal {
 #define INSTRUMENTATION_FUNCTION_LIST(V)         \
   V(ER_read)                                    \
   V(ER_readProp)                                \
+  V(ER_readPropObject)                          \
   V(ER_write)                                   \
   V(ER_writeProp)                               \
   V(ER_writeFunc)                               \
@@ -68,6 +71,7 @@ namespace internal {
   V(ER_deleteProp)                              \
   V(ER_enterFunction)                           \
   V(ER_exitFunction)                            \
+  V(ER_unwind)                                  \
   V(ER_readPropIdx)                              \
   V(ER_writePropIdx)                             \
   V(ER_writePropIdxFunc)                         \
@@ -82,14 +86,35 @@ namespace internal {
   V(ER_postDecProp)                              \
   V(ER_postDecPropStrict)                        \
   V(ER_deletePropIdx)                            \
-  V(ER_deletePropIdxStrict)
+  V(ER_deletePropIdxStrict)                      \
+  V(ER_readRange)                                \
+  V(ER_writeRange)
+
+// Instrumentation functions, implemented directly as runtime functions.
+#define INSTRUMENTATION_RUNTIME_FUNCTION_LIST(V)        \
+  V(ER_read, EventRacerRead)                            \
+  V(ER_readProp, EventRacerReadProp)                    \
+  V(ER_readPropObject, EventRacerReadPropObject)        \
+  V(ER_write, EventRacerWrite)                          \
+  V(ER_writeProp, EventRacerWriteProp)                  \
+  V(ER_writeFunc, EventRacerWriteFunc)                  \
+  V(ER_writePropFunc, EventRacerWritePropFunc)          \
+  V(ER_delete, EventRacerDelete)                        \
+  V(ER_deleteProp, EventRacerDeleteProp)                \
+  V(ER_enterFunction, EventRacerEnterFunction)          \
+  V(ER_exitFunction, EventRacerExitFunction)            \
+  V(ER_unwind, EventRacerUnwind)                        \
+  V(ER_readRange, EventRacerReadRange)                  \
+  V(ER_writeRange, EventRacerWriteRange)
 
 struct EventRacerRewriterTag {};
 
 template<>
 class AstRewriterImpl<EventRacerRewriterTag> : public AstRewriter {
 public:
-  AstRewriterImpl(CompilationInfo *info);
+  // A non-zero |stack_limit| is checked instead of the isolate's one, when
+  // run off the main thread, see |Compiler::AnalyzeOnBackground|.
+  AstRewriterImpl(CompilationInfo *info, uintptr_t stack_limit = 0);
 
 #define DEF_VISIT(type) \
   virtual type* doVisit(type *nd) FINAL OVERRIDE;
@@ -119,6 +144,9 @@ private:
         scope = prev->scope;
       else
         scope = NULL;
+      escapes = prev ? prev->escapes : NULL;
+      range_loop = prev ? prev->range_loop : NULL;
+      function_id = prev ? prev->function_id : 0;
       w->current_context_ = this;
     }
 
@@ -128,6 +156,13 @@ private:
 
     AstRewriterImpl<EventRacerRewriterTag> *rewriter;
     Scope *scope;
+    // Escape analysis of the innermost function literal.
+    EventRacerEscapeAnalysis *escapes;
+    // The innermost range loop in the current function, see
+    // |EventRacerRangeLoop|.
+    EventRacerRangeLoop *range_loop;
+    // Identifier of the innermost function literal.
+    int function_id;
     ContextScope *prev;
   };
 
@@ -154,6 +189,25 @@ private:
     return var == NULL || !var->IsStackAllocated();
   }
 
+  // Same as |Variable::is_possibly_eval|, but without the heap access.
+  bool is_possibly_eval(Expression *callee) const {
+    VariableProxy *vp = callee->AsVariableProxy();
+    return vp != NULL && vp->var() != NULL &&
+           vp->raw_name() == info_->ast_value_factory()->eval_string();
+  }
+
+  // Accesses to the properties of objects, which are not reachable from
+  // outside the current function activation, cannot race.
+  bool is_local_object(Expression *obj) const {
+    return context()->escapes != NULL && context()->escapes->IsLocalObject(obj);
+  }
+
+  // Element accesses of range loops are logged once, before the loop.
+  bool is_range_access(Property *p) const {
+    return context()->range_loop != NULL &&
+           context()->range_loop->IsRangeAccess(p);
+  }
+
   ContextScope *context() const { return current_context_; }
 
   CompilationInfo *info_;
@@ -171,6 +225,7 @@ private:
 #undef FN
   Variable *instr_fn_[FN_MAX];
   const AstRawString *instr_fn_name_[FN_MAX];
+  const Runtime::Function *instr_rt_[FN_MAX];
 
   VariableProxy *fn_proxy(enum InstrumentationFunction);
   Expression *call_runtime(enum InstrumentationFunction, ZoneList<Expression*> *, int);
@@ -180,6 +235,11 @@ private:
 
   bool is_literal_key(const Expression *) const;
   Literal *duplicate_key(const Literal *);
+  Literal *new_site(int kind, const AstRawString *name, int pos);
+  Literal *prop_site(int kind, const Expression *key, int pos);
+  Expression *log_prop_object(Expression *, const Literal *, int);
+  void log_unwind(Block *);
+  Block *log_range_loop(const EventRacerRangeLoop *, Statement *, int);
 
   FunctionLiteral *make_fn(Scope *scope, ZoneList<Statement *> *body,
                            int param_count, int pos);
@@ -192,42 +252,6 @@ private:
 
 typedef AstRewriterImpl<EventRacerRewriterTag> EventRacerRewriter;
 
-class AstSlotCounter : public AstVisitor {
-public:
-  AstSlotCounter() : state_(&FunctionState::guard) {}
-
-#define DECLARE_VISIT(type) virtual void Visit##type(type* node);
-  AST_NODE_LIST(DECLARE_VISIT)
-#undef DECLARE_VISIT
-
-  void add_materialized_literal(MaterializedLiteral *);
-
-private:
-  struct FunctionState {
-    FunctionState()
-        : prev(NULL),
-          materialized_literal_count(JSFunction::kLiteralsPrefixSize) {}
-
-    FunctionState *prev;
-    int materialized_literal_count;
-
-    static FunctionState guard;
-  };
-
-  void begin_function (FunctionState *st) {
-    st->prev = state_;
-    state_ = st;
-  }
-  void end_function() {
-    state_ = state_->prev;
-  }
-
-  FunctionState *state_;
-
-  DEFINE_AST_VISITOR_SUBCLASS_MEMBERS();
-};
-
-
 } }  // namespace v8::internal
 
 #endif // V8_EVENT_RACER_REWRITER_H_
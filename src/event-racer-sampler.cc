@@ -0,0 +1,97 @@
+#include "src/v8.h"
+
+#include "src/event-racer-sampler.h"
+
+namespace v8 {
+namespace internal {
+
+EventRacerSampler::EventRacerSampler()
+  : active_(false),
+    burst_length_(0),
+    burst_period_(0),
+    burst_counter_(0),
+    backoff_limit_(0),
+    sites_(NULL) {
+  for (int i = 0; i < kKindCount; ++i) {
+    periods_[i] = 1;
+    counters_[i] = 0;
+  }
+}
+
+EventRacerSampler::~EventRacerSampler() {
+  DeleteArray(sites_);
+}
+
+void EventRacerSampler::Configure(int read_period, int write_period,
+                                  int call_period, int burst_length,
+                                  int burst_period, int backoff_limit) {
+  periods_[kRead] = Max(read_period, 1);
+  periods_[kWrite] = Max(write_period, 1);
+  periods_[kCall] = Max(call_period, 1);
+  burst_length_ = Max(burst_length, 0);
+  burst_period_ = Max(burst_period, burst_length_);
+  backoff_limit_ = Max(backoff_limit, 0);
+
+  active_ = backoff_limit_ > 1;
+  if (active_ && sites_ == NULL)
+    sites_ = NewArray<SiteState>(kSiteTableSize);
+  for (int i = 0; i < kKindCount; ++i)
+    active_ = active_ || periods_[i] > 1;
+  Reset();
+}
+
+void EventRacerSampler::ConfigureFromFlags() {
+  Configure(FLAG_er_sample_reads, FLAG_er_sample_writes, FLAG_er_sample_calls,
+            FLAG_er_sample_burst_length, FLAG_er_sample_burst_period,
+            FLAG_er_sample_backoff_limit);
+}
+
+void EventRacerSampler::Reset() {
+  for (int i = 0; i < kKindCount; ++i)
+    counters_[i] = 0;
+  burst_counter_ = 0;
+  if (sites_ != NULL) {
+    for (int i = 0; i < kSiteTableSize; ++i)
+      sites_[i].site = 0;
+  }
+}
+
+bool EventRacerSampler::SiteAllows(Kind kind, int site) {
+  if (backoff_limit_ <= 1 || site == 0)
+    return true;
+  uint32_t key = static_cast<uint32_t>(site) * kKindCount + kind;
+  SiteState *state = &sites_[ComputeIntegerHash(key, 0) & (kSiteTableSize - 1)];
+  if (state->site != site || state->kind != kind) {
+    state->site = site;
+    state->kind = kind;
+    state->skip = 0;
+    state->period = 1;
+  }
+  if (state->skip > 0) {
+    --state->skip;
+    return false;
+  }
+  state->period = Min(2 * state->period, backoff_limit_);
+  state->skip = state->period - 1;
+  return true;
+}
+
+bool EventRacerSampler::ShouldRecord(Kind kind, int site) {
+  if (!active_)
+    return true;
+  if (burst_length_ > 0) {
+    bool in_burst = burst_counter_ < burst_length_;
+    if (++burst_counter_ == burst_period_)
+      burst_counter_ = 0;
+    if (in_burst)
+      return true;
+  }
+  int n = counters_[kind]++;
+  if (counters_[kind] == periods_[kind])
+    counters_[kind] = 0;
+  if (n != 0)
+    return false;
+  return SiteAllows(kind, site);
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,92 @@
+#ifndef V8_EVENT_RACER_SAMPLER_H_
+#define V8_EVENT_RACER_SAMPLER_H_
+
+#include "src/allocation.h"
+#include "src/globals.h"
+
+namespace v8 {
+namespace internal {
+
+// Decides which of the events, reported by the ER instrumentation, are
+// recorded, so the instrumentation is cheap enough to leave on under real
+// load.
+//
+// Bursts: the first |burst_length| of each |burst_period| events are all
+// recorded. Outside of the bursts, one in each sampling period of events
+// of a kind is recorded, and, with adaptive back-off, only if its access
+// site is not throttled. The back-off doubles the distance between the
+// recorded events of a site after each one, up to |backoff_limit| events,
+// so hot sites, which report the same accesses over and over, are sampled
+// less and less. The site of an access is identified by the site id,
+// which the ER rewriter allocates for it, and the site of a function entry
+// by the function literal id. The back-off state of the sites is kept in a
+// fixed size table, so a site may be evicted by another one, which maps to
+// the same slot, after which it starts over.
+//
+// Function exits are not sampled, they are recorded iff the entry was. With
+// the default configuration, all the events are recorded.
+class EventRacerSampler {
+public:
+  enum Kind {
+    kRead,
+    kWrite,
+    kCall,
+    kKindCount
+  };
+
+  EventRacerSampler();
+  ~EventRacerSampler();
+
+  // Sets the sampling periods of the event kinds and the burst and the
+  // back-off parameters. A period of one records all events, a burst
+  // length or a back-off limit of zero turns the feature off.
+  void Configure(int read_period, int write_period, int call_period,
+                 int burst_length, int burst_period, int backoff_limit);
+
+  // Reads the configuration from the |--er-sample-*| flags.
+  void ConfigureFromFlags();
+
+  // Returns false if all the events are recorded.
+  bool is_active() const { return active_; }
+
+  // Returns true if an event of the kind |kind|, reported from |site|, is
+  // to be recorded. |site| is zero if unknown, such sites are not throttled.
+  bool ShouldRecord(Kind kind, int site);
+
+  // Restarts the counters and forgets the access sites.
+  void Reset();
+
+private:
+  struct SiteState {
+    // The site and the kind of its events, the site is zero if the slot is
+    // free.
+    int site;
+    Kind kind;
+    // Events to skip before the next recorded one.
+    int skip;
+    // The distance between the recorded events.
+    int period;
+  };
+
+  static const int kSiteTableSize = 1024;
+
+  bool SiteAllows(Kind kind, int site);
+
+  bool active_;
+  int periods_[kKindCount];
+  int counters_[kKindCount];
+  int burst_length_;
+  int burst_period_;
+  int burst_counter_;
+  int backoff_limit_;
+
+  // The back-off state of the sites, indexed by a hash of the site. NULL
+  // until the back-off is turned on.
+  SiteState *sites_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRacerSampler);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_SAMPLER_H_
@@ -0,0 +1,265 @@
+#include <errno.h>
+#include <string.h>
+
+#include "src/v8.h"
+
+#include "src/event-racer-trace.h"
+#include "src/log-utils.h"
+
+namespace v8 {
+namespace internal {
+
+const char EventRacerTrace::kMagic[8] = {
+  'V', '8', 'E', 'R', 'T', 'R', 'C', 2
+};
+
+// Large enough for the longest name record.
+static const int kMinChunkSize = 4 * KB;
+
+class EventRacerTrace::Writer : public base::Thread {
+public:
+  explicit Writer(EventRacerTrace *trace)
+    : base::Thread(Options("v8:ERTraceWriter")), trace_(trace) {}
+
+  void Run() OVERRIDE { trace_->WriteChunks(); }
+
+private:
+  EventRacerTrace *trace_;
+};
+
+EventRacerTrace::EventRacerTrace()
+  : output_(NULL),
+    temporary_(false),
+    failed_(0),
+    chunk_size_(0),
+    last_seq_(0),
+    current_(NULL),
+    ready_head_(0),
+    ready_tail_(0),
+    ready_count_(0),
+    free_head_(0),
+    free_tail_(0),
+    free_count_(0),
+    writer_(NULL) {
+  for (int i = 0; i < kChunkCount; ++i) {
+    chunks_[i].data = NULL;
+    chunks_[i].size = 0;
+  }
+}
+
+EventRacerTrace::~EventRacerTrace() {
+  FILE *f = Close();
+  if (f != NULL)
+    fclose(f);
+}
+
+bool EventRacerTrace::Open(const char *name, int chunk_size) {
+  DCHECK(!is_open() && writer_ == NULL);
+  temporary_ = strcmp(name, Log::kLogToTemporaryFile) == 0;
+  if (temporary_)
+    output_ = base::OS::OpenTemporaryFile();
+  else
+    output_ = base::OS::FOpen(name, base::OS::LogFileOpenMode);
+  if (output_ == NULL)
+    return false;
+  if (fwrite(kMagic, 1, sizeof(kMagic), output_) != sizeof(kMagic)) {
+    fclose(output_);
+    output_ = NULL;
+    return false;
+  }
+
+  chunk_size_ = Max(chunk_size, kMinChunkSize);
+  for (int i = 0; i < kChunkCount; ++i) {
+    chunks_[i].data = NewArray<byte>(chunk_size_);
+    chunks_[i].size = 0;
+  }
+  current_ = &chunks_[0];
+  for (int i = 1; i < kChunkCount; ++i) {
+    free_[free_tail_] = &chunks_[i];
+    free_tail_ = (free_tail_ + 1) % kChunkCount;
+    free_count_.Signal();
+  }
+
+  writer_ = new Writer(this);
+  writer_->Start();
+  return true;
+}
+
+FILE *EventRacerTrace::Close() {
+  if (!is_open())
+    return NULL;
+
+  Flush();
+  {
+    base::LockGuard<base::Mutex> lock(&mutex_);
+    ready_[ready_tail_] = NULL;
+    ready_tail_ = (ready_tail_ + 1) % (kChunkCount + 1);
+  }
+  ready_count_.Signal();
+  writer_->Join();
+  delete writer_;
+  writer_ = NULL;
+
+  for (int i = 0; i < kChunkCount; ++i) {
+    DeleteArray(chunks_[i].data);
+    chunks_[i].data = NULL;
+  }
+  current_ = NULL;
+
+  FILE *result = NULL;
+  if (temporary_) {
+    fflush(output_);
+    result = output_;
+  } else {
+    fclose(output_);
+  }
+  output_ = NULL;
+  return result;
+}
+
+void EventRacerTrace::Flush() {
+  if (current_ == NULL || current_->size == 0)
+    return;
+  if (failed()) {
+    current_->size = 0;
+    return;
+  }
+  {
+    base::LockGuard<base::Mutex> lock(&mutex_);
+    ready_[ready_tail_] = current_;
+    ready_tail_ = (ready_tail_ + 1) % (kChunkCount + 1);
+  }
+  ready_count_.Signal();
+
+  // Blocks while all the chunks are waiting to be written.
+  free_count_.Wait();
+  base::LockGuard<base::Mutex> lock(&mutex_);
+  current_ = free_[free_head_];
+  free_head_ = (free_head_ + 1) % kChunkCount;
+  DCHECK(current_->size == 0);
+}
+
+void EventRacerTrace::WriteChunks() {
+  for (;;) {
+    ready_count_.Wait();
+    Chunk *chunk;
+    {
+      base::LockGuard<base::Mutex> lock(&mutex_);
+      chunk = ready_[ready_head_];
+      ready_head_ = (ready_head_ + 1) % (kChunkCount + 1);
+    }
+    if (chunk == NULL)
+      break;
+
+    // The chunks, which are still queued after a failure, are dropped.
+    if (!failed()) {
+      size_t size = static_cast<size_t>(chunk->size);
+      byte header[4] = {
+        static_cast<byte>(size), static_cast<byte>(size >> 8),
+        static_cast<byte>(size >> 16), static_cast<byte>(size >> 24)
+      };
+      if (fwrite(header, 1, sizeof(header), output_) != sizeof(header) ||
+          fwrite(chunk->data, 1, size, output_) != size)
+        Fail();
+    }
+
+    chunk->size = 0;
+    {
+      base::LockGuard<base::Mutex> lock(&mutex_);
+      free_[free_tail_] = chunk;
+      free_tail_ = (free_tail_ + 1) % kChunkCount;
+    }
+    free_count_.Signal();
+  }
+  if (!failed() && fflush(output_) != 0)
+    Fail();
+}
+
+// Called on the writer thread, at the first failed write.
+void EventRacerTrace::Fail() {
+  base::NoBarrier_Store(&failed_, 1);
+  base::OS::PrintError("Cannot write the ER trace: %s, the trace is cut "
+                       "short\n", strerror(errno));
+}
+
+void EventRacerTrace::Reserve(int size) {
+  DCHECK(is_open() && size <= chunk_size_);
+  if (current_->size + size > chunk_size_)
+    Flush();
+}
+
+void EventRacerTrace::PutVarint(uint32_t value) {
+  while (value >= 0x80) {
+    PutByte(static_cast<byte>(value | 0x80));
+    value >>= 7;
+  }
+  PutByte(static_cast<byte>(value));
+}
+
+// Tag byte plus up to four 5-byte varints.
+static const int kMaxFixedRecordSize = 1 + 4 * 5;
+
+// Writes out the gap between the last written sequence number and |seq|,
+// as |kSeq| records, each one counting at most 32 bits.
+void EventRacerTrace::PutSequence(uint64_t seq) {
+  DCHECK(seq > last_seq_);
+  uint64_t skip = seq - last_seq_ - 1;
+  last_seq_ = seq;
+  while (skip > 0) {
+    uint32_t count = static_cast<uint32_t>(Min<uint64_t>(skip, kMaxUInt32));
+    Reserve(1 + 5);
+    PutByte(kSeq);
+    PutVarint(count);
+    skip -= count;
+  }
+}
+
+void EventRacerTrace::WriteEvent(uint64_t seq, int op, int32_t obj,
+                                 int32_t name, int32_t fn) {
+  DCHECK(op > 0 && op < kName);
+  PutSequence(seq);
+  Reserve(kMaxFixedRecordSize);
+  PutByte(static_cast<byte>(op));
+  PutVarint(static_cast<uint32_t>(obj));
+  PutVarint(static_cast<uint32_t>(name));
+  PutVarint(static_cast<uint32_t>(fn));
+}
+
+void EventRacerTrace::WriteRange(uint64_t seq, int op, int32_t obj,
+                                 int32_t first, int32_t last, int32_t stride) {
+  DCHECK(op > 0 && op < kName);
+  PutSequence(seq);
+  Reserve(kMaxFixedRecordSize);
+  PutByte(static_cast<byte>(op));
+  PutVarint(static_cast<uint32_t>(obj));
+  PutSigned(first);
+  PutSigned(last);
+  PutSigned(stride);
+}
+
+void EventRacerTrace::WriteName(int32_t id, const char *str, int len) {
+  len = Min(len, chunk_size_ - kMaxFixedRecordSize);
+  Reserve(kMaxFixedRecordSize + len);
+  PutByte(kName);
+  PutVarint(static_cast<uint32_t>(id));
+  PutVarint(static_cast<uint32_t>(len));
+  MemCopy(current_->data + current_->size, str, len);
+  current_->size += len;
+}
+
+void EventRacerTrace::WriteFunction(int32_t fn_id, int32_t script_id,
+                                    int32_t start_line, int32_t end_line) {
+  Reserve(kMaxFixedRecordSize);
+  PutByte(kFunc);
+  PutVarint(static_cast<uint32_t>(fn_id));
+  PutSigned(script_id);
+  PutSigned(start_line);
+  PutSigned(end_line);
+}
+
+void EventRacerTrace::WriteReset() {
+  Reserve(1);
+  PutByte(kReset);
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,144 @@
+#ifndef V8_EVENT_RACER_TRACE_H_
+#define V8_EVENT_RACER_TRACE_H_
+
+#include <stdio.h>
+
+#include "src/allocation.h"
+#include "src/base/atomicops.h"
+#include "src/base/platform/mutex.h"
+#include "src/base/platform/platform.h"
+#include "src/base/platform/semaphore.h"
+
+namespace v8 {
+namespace internal {
+
+// Streams the ER events into a file in a compact binary format, so traces
+// larger than the in-memory ring buffer can be recorded with a bounded
+// amount of memory.
+//
+// The file starts with the eight bytes |kMagic|, followed by a sequence of
+// chunks. Each chunk is a 32-bit little-endian payload size, followed by
+// that many bytes of records. A record does not span chunks. Each record
+// starts with a tag byte:
+//
+//   1..12   event, the tag is the |EventRacerLog::Op|, followed by the
+//           object id, the name index and the function id as varints
+//   13, 14  range access, the tag is the |EventRacerLog::Op|, followed by
+//           the varint object id, zig-zag varints first and last index
+//           and stride
+//   kName   varint name index, varint length, followed by the name bytes
+//   kFunc   varint function id, zig-zag varints script id, start and end
+//           line
+//   kReset  the log was re-enabled, name indices and function ids are
+//           reset
+//   kSeq    varint count of the sequence numbers, skipped before the next
+//           event
+//
+// Varints are unsigned LEB128, 32-bit values. Names and functions are
+// defined by a record, which precedes the first event, which refers to them.
+//
+// The events carry the process-wide sequence numbers, which order the
+// events of all the isolates, see |EventRacerLog::Event|. The sequence
+// number of an event is one more than the one of the previous event in the
+// trace (zero before the first event), plus the counts of the |kSeq|
+// records in between. The traces of the isolates, which ran at the same
+// time, are merged by the sequence numbers.
+//
+// Records are appended to a chunk on the recording thread. Full chunks are
+// handed to a background thread, which writes them out. At most
+// |kChunkCount| chunks are in memory, the recording thread blocks when
+// all of them are waiting to be written.
+class EventRacerTrace {
+public:
+  static const char kMagic[8];
+  static const int kChunkCount = 4;
+
+  enum Tag {
+    kName = 0x80,
+    kFunc = 0x81,
+    kReset = 0x82,
+    kSeq = 0x83
+  };
+
+  EventRacerTrace();
+  ~EventRacerTrace();
+
+  // Opens the file |name| and starts the writer thread. The name
+  // |Log::kLogToTemporaryFile| opens a temporary file. Returns false if
+  // the file cannot be opened.
+  bool Open(const char *name, int chunk_size);
+
+  // Writes out the remaining records and stops the writer thread. When a
+  // temporary file is used, returns its stream, leaving the file open.
+  FILE *Close();
+
+  bool is_open() const { return output_ != NULL; }
+
+  // True after a write to the file failed. The trace stops there, the
+  // later records are dropped.
+  bool failed() const { return base::NoBarrier_Load(&failed_) != 0; }
+
+  void WriteEvent(uint64_t seq, int op, int32_t obj, int32_t name,
+                  int32_t fn);
+  void WriteRange(uint64_t seq, int op, int32_t obj, int32_t first,
+                  int32_t last, int32_t stride);
+  void WriteName(int32_t id, const char *str, int len);
+  void WriteFunction(int32_t fn_id, int32_t script_id, int32_t start_line,
+                     int32_t end_line);
+  void WriteReset();
+
+  // Hands the current chunk to the writer thread, if it is not empty.
+  void Flush();
+
+private:
+  class Writer;
+
+  struct Chunk {
+    byte *data;
+    int size;
+  };
+
+  void Reserve(int size);
+  void PutByte(byte b) { current_->data[current_->size++] = b; }
+  void PutVarint(uint32_t value);
+  void PutSigned(int32_t value) {
+    PutVarint((static_cast<uint32_t>(value) << 1) ^
+              static_cast<uint32_t>(value >> 31));
+  }
+  void PutSequence(uint64_t seq);
+
+  // Called on the writer thread. Writes out the ready chunks until the
+  // terminating NULL chunk is seen.
+  void WriteChunks();
+  void Fail();
+
+  FILE *output_;
+  bool temporary_;
+  base::Atomic32 failed_;
+  int chunk_size_;
+  // Sequence number of the last event written.
+  uint64_t last_seq_;
+  Chunk chunks_[kChunkCount];
+  Chunk *current_;
+
+  // Chunks, which are waiting to be written, and the chunks, available
+  // for recording, as circular queues. |ready_count_| and |free_count_|
+  // count their elements.
+  base::Mutex mutex_;
+  Chunk *ready_[kChunkCount + 1];
+  int ready_head_;
+  int ready_tail_;
+  base::Semaphore ready_count_;
+  Chunk *free_[kChunkCount];
+  int free_head_;
+  int free_tail_;
+  base::Semaphore free_count_;
+
+  Writer *writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRacerTrace);
+};
+
+} }  // namespace v8::internal
+
+#endif // V8_EVENT_RACER_TRACE_H_
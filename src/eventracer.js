@@ -1,249 +1,122 @@
-// Operations encoding.
-const ER_OP_read          =  1;
-const ER_OP_readProp      =  2;
-const ER_OP_readArray     =  3;
-const ER_OP_write         =  4;
-const ER_OP_writeProp     =  5;
-const ER_OP_writeFunc     =  6;
-const ER_OP_writePropFunc =  7;
-const ER_OP_writeArray    =  8;
-const ER_OP_enterFunc     =  9;
-const ER_OP_exitFunc      = 10;
-const ER_OP_delete        = 11;
-const ER_OP_deleteProp    = 12;
-
-// Operations
-global.ER_op = [];
-
-// Accessed objects.
-global.ER_obj = [];
-
-// Property or function names.
-global.ER_name = [];
-
-// Read/written values; integer function id for enterFunc.
-global.ER_value = [];
-
-// Script identifiers
-global.ER_scriptId = [];
-
-// Function identifiers.
-global.ER_funcId = [];
-
-// Function start and end line number.
-global.ER_startLine = [];
-global.ER_endLine = [];
-
-// Collection enable counter.
-global.ER_enableCount = 0;
-
-// Clears the data and increments the collection enable counter.
+// The ER events are recorded by the runtime into a per-isolate ring
+// buffer (see event-racer-log.h). The instrumentation calls the runtime
+// functions %_EventRacerRead, %_EventRacerReadProp, etc. directly; only the
+// helper functions below are implemented in JavaScript.
+
+// Increments the collection enable counter, clearing the recorded events
+// when collection starts. Unless --no-instrument-lazily is given, code is
+// compiled with the instrumentation only while collection is enabled, so
+// starting or stopping the collection discards the compiled functions,
+// which are not currently running.
 global.ER_enable = function() {
-    if (++global.ER_enableCount == 1) {
-        global.ER_op.length = 0;
-        global.ER_obj.length = 0;
-        global.ER_name.length = 0;
-        global.ER_value.length = 0;
-        global.ER_scriptId.length = 0;
-        global.ER_funcId.length = 0;
-        global.ER_startLine.length = 0;
-        global.ER_endLine.length = 0;
-    }
+    %EventRacerEnable();
 }
 
 // Decrements the enable counter. Data is not collected if the counter
 // is zero.
 global.ER_disable = function() {
-    return --global.ER_enableCount;
+    return %EventRacerDisable();
 }
 
-// Core functions
-function ER_read(name, value) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_read);
-        global.ER_name.push_(name);
-        global.ER_value.push_(value);
-    }
-    return value;
+// Returns the recorded events as an object with the parallel arrays |seq|,
+// |op|, |obj|, |name|, |funcId|, |stride|, |scriptId|, |startLine| and
+// |endLine|. The |seq| numbers are unique across all the isolates of the
+// process and order their events. The operations are encoded as:
+//
+//   1 read,       2 readProp,      3 readArray,  4 write,
+//   5 writeProp,  6 writeFunc,     7 writePropFunc,
+//   8 writeArray, 9 enterFunc,    10 exitFunc,  11 delete,
+//  12 deleteProp, 13 readRange,  14 writeRange
+//
+// A range access stands for the accesses of the elements |name|,
+// |name| + |stride|, ..., |funcId| of the array |obj|.
+global.ER_getLog = function() {
+    return %EventRacerGetLog();
 }
 
-function ER_readProp(obj, name, value) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_readProp);
-        global.ER_obj.push_(obj);
-        global.ER_name.push_(name);
-        global.ER_value.push_(value);
-    }
-    return value;
+// Helper functions. The instrumentation passes the site id of the access
+// as the last argument.
+function ER_readPropIdx(arr, idx, site) {
+    return %_EventRacerReadProp(arr, idx, arr[idx], site);
 }
 
-function ER_readArray(array) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_readArray);
-        global.ER_obj.push_(array);
-    }
+function ER_writePropIdx(obj, idx, value, site) {
+    return obj[idx] = %_EventRacerWriteProp(obj, idx, value, site);
 }
 
-function ER_write(name, value) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_write);
-        global.ER_name.push_(name);
-        global.ER_value.push_(value);
-    }
-    return value;
+function ER_writePropIdxFunc(obj, idx, value, id, site) {
+    return obj[idx] = %_EventRacerWritePropFunc(obj, idx, value, id, site);
 }
 
-function ER_writeProp(obj, name, value) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_writeProp);
-        global.ER_obj.push_(obj);
-        global.ER_name.push_(name);
-        global.ER_value.push_(value);
-    }
-    return value;
-}
-
-function ER_writeFunc(name, value, id) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_writeFunc);
-        global.ER_name.push_(name);
-        global.ER_funcId.push_(id);
-    }
-    return value;
-}
-
-function ER_writePropFunc(obj, name, value, id) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_writePropFunc);
-        global.ER_obj.push_(obj);
-        global.ER_name.push_(name);
-        global.ER_funcId.push_(id);
-    }
-    return value;
-}
-
-function ER_writeArray(array) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_writeArray);
-        global.ER_obj.push_(array);
-    }
-}
-
-
-function ER_enterFunction(name, scriptId, fnId, startLine, endLine) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_enterFunc);
-        global.ER_name.push_(name);
-        global.ER_scriptId.push_(scriptId);
-        global.ER_funcId.push_(fnId);
-        global.ER_startLine.push_(startLine);
-        global.ER_endLine.push_(endLine);
-    }
-}
-
-function ER_exitFunction(val) {
-    if (global.ER_enableCount)
-        global.ER_op.push_(ER_OP_exitFunc);
-    return val;
-}
-
-function ER_delete(name) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_delete);
-        global.ER_name.push_(name);
-    }
-}
-
-function ER_deleteProp(obj, name) {
-    if (global.ER_enableCount) {
-        global.ER_op.push_(ER_OP_deleteProp);
-        global.ER_obj.push_(obj);
-        global.ER_name.push_(name);
-    }
-}
-
-// Helper functions
-function ER_readPropIdx(arr, idx) {
-    return ER_readProp(arr, idx, arr[idx]);
-}
-
-function ER_writePropIdx(obj, idx, value) {
-    return obj[idx] = ER_writeProp(obj, idx, value);
-}
-
-function ER_writePropIdxFunc(obj, idx, value, id) {
-    return obj[idx] = ER_writePropFunc(obj, idx, value, id);
-}
-
-function ER_writePropIdxStrict(obj, idx, value) {
+function ER_writePropIdxStrict(obj, idx, value, site) {
     "use strict";
-    return obj[idx] = ER_writeProp(obj, idx, value);
+    return obj[idx] = %_EventRacerWriteProp(obj, idx, value, site);
 }
 
-function ER_writePropIdxFuncStrict(obj, idx, value, id) {
+function ER_writePropIdxFuncStrict(obj, idx, value, id, site) {
     "use strict";
-    return obj[idx] = ER_writePropFunc(obj, idx, value, id);
+    return obj[idx] = %_EventRacerWritePropFunc(obj, idx, value, id, site);
 }
 
-function ER_preIncProp(obj, idx) {
+function ER_preIncProp(obj, idx, site) {
     var v = ++obj[idx];
-    ER_writeProp(obj, idx, v);
+    %_EventRacerWriteProp(obj, idx, v, site);
     return v;
 }
 
-function ER_preIncPropStrict(obj, idx) {
+function ER_preIncPropStrict(obj, idx, site) {
     "use strict";
     var v = ++obj[idx];
-    ER_writeProp(obj, idx, v);
+    %_EventRacerWriteProp(obj, idx, v, site);
     return v;
 }
 
-function ER_preDecProp(obj, idx) {
+function ER_preDecProp(obj, idx, site) {
     var v = --obj[idx];
-    ER_writeProp(obj, idx, v);
+    %_EventRacerWriteProp(obj, idx, v, site);
     return v;
 }
 
-function ER_preDecPropStrict(obj, idx) {
+function ER_preDecPropStrict(obj, idx, site) {
     "use strict";
     var v = --obj[idx];
-    ER_writeProp(obj, idx, v);
+    %_EventRacerWriteProp(obj, idx, v, site);
     return v;
 }
 
-function ER_postIncProp(obj, idx) {
+function ER_postIncProp(obj, idx, site) {
     var v = obj[idx]++;
-    ER_writeProp(obj, idx, obj[idx]);
+    %_EventRacerWriteProp(obj, idx, obj[idx], site);
     return v;
 }
 
-function ER_postIncPropStrict(obj, idx) {
+function ER_postIncPropStrict(obj, idx, site) {
     "use strict";
     var v = obj[idx]++;
-    ER_writeProp(obj, idx, obj[idx]);
+    %_EventRacerWriteProp(obj, idx, obj[idx], site);
     return v;
 }
 
-function ER_postDecProp(obj, idx) {
+function ER_postDecProp(obj, idx, site) {
     var v = obj[idx]--;
-    ER_writeProp(obj, idx, obj[idx]);
+    %_EventRacerWriteProp(obj, idx, obj[idx], site);
     return v;
 }
 
-function ER_postDecPropStrict(obj, idx) {
+function ER_postDecPropStrict(obj, idx, site) {
     "use strict";
     var v = obj[idx]--;
-    ER_writeProp(obj, idx, obj[idx]);
+    %_EventRacerWriteProp(obj, idx, obj[idx], site);
     return v;
 }
 
-function ER_deletePropIdx(obj, idx) {
-    ER_deleteProp(obj, idx);
+function ER_deletePropIdx(obj, idx, site) {
+    %_EventRacerDeleteProp(obj, idx, site);
     return delete obj[idx];
 }
 
-function ER_deletePropIdxStrict(obj, idx) {
+function ER_deletePropIdxStrict(obj, idx, site) {
     "use strict";
-    ER_deleteProp(obj, idx);
+    %_EventRacerDeleteProp(obj, idx, site);
     return delete obj[idx];
 }
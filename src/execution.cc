@@ -7,6 +7,7 @@
 #include "src/bootstrapper.h"
 #include "src/codegen.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/isolate-inl.h"
 #include "src/vm-state-inl.h"
 
@@ -62,6 +63,10 @@ MUST_USE_RESULT static MaybeHandle<Object> Invoke(
     return MaybeHandle<Object>();
   }
 
+  // Each outermost invocation, e.g. an event handler run by the embedder,
+  // starts a new epoch of the ER read deduplication.
+  if (isolate->js_entry_sp() == NULL) isolate->event_racer_log()->NewEpoch();
+
   // Placeholder for return value.
   Object* value = NULL;
 
@@ -111,6 +116,9 @@ MUST_USE_RESULT static MaybeHandle<Object> Invoke(
   bool has_exception = value->IsException();
   DCHECK(has_exception == isolate->has_pending_exception());
   if (has_exception) {
+    // The JS frames, entered by the call, are gone.
+    EventRacerLog* er_log = isolate->event_racer_log();
+    if (er_log->enabled()) er_log->LogUnwind(0);
     isolate->ReportPendingMessages();
     // Reset stepping state when script exits with uncaught exception.
     if (isolate->debug()->is_active()) {
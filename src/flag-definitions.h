@@ -593,7 +593,18 @@ DEFINE_BOOL(age_code, true,
             "old code (required for code flushing)")
 DEFINE_BOOL(incremental_marking, true, "use incremental marking")
 DEFINE_BOOL(incremental_marking_steps, true, "do incremental marking steps")
+DEFINE_BOOL(incremental_marking_task, false,
+            "advance incremental marking in tasks, posted to the foreground "
+            "thread of the platform")
 DEFINE_BOOL(concurrent_sweeping, true, "use concurrent sweeping")
+DEFINE_BOOL(parallel_store_buffer_scan, false,
+            "scan the scan-on-scavenge pages for pointers to new space on "
+            "the worker threads")
+DEFINE_BOOL(parallel_markbit_clearing, false,
+            "clear the mark bits of the pages on the worker threads")
+DEFINE_BOOL(parallel_pointer_update, false,
+            "update the slots, recorded for the evacuation candidates, on "
+            "the worker threads")
 DEFINE_BOOL(trace_incremental_marking, false,
             "trace progress of the incremental marking")
 DEFINE_BOOL(track_gc_object_stats, false,
@@ -723,6 +734,9 @@ DEFINE_BOOL(predictable, false, "enable predictable mode")
 DEFINE_NEG_IMPLICATION(predictable, concurrent_recompilation)
 DEFINE_NEG_IMPLICATION(predictable, concurrent_osr)
 DEFINE_NEG_IMPLICATION(predictable, concurrent_sweeping)
+DEFINE_NEG_IMPLICATION(predictable, parallel_store_buffer_scan)
+DEFINE_NEG_IMPLICATION(predictable, parallel_markbit_clearing)
+DEFINE_NEG_IMPLICATION(predictable, parallel_pointer_update)
 
 
 //
@@ -758,6 +772,39 @@ DEFINE_BOOL(stress_compaction, false,
             "--force_marking_deque_overflows)")
 
 DEFINE_BOOL(instrument, true, "enable ER instrumentation")
+DEFINE_BOOL(instrument_lazily, true,
+            "compile the ER instrumentation only while the event log is "
+            "enabled")
+DEFINE_BOOL(er_escape_analysis, true,
+            "do not instrument accesses to objects, which do not escape "
+            "the function")
+DEFINE_BOOL(er_range_loops, true,
+            "log the array element accesses of counted loops once per loop "
+            "as a range access")
+DEFINE_STRING(er_script_filter, "*",
+              "ER instrumentation filter for script names")
+DEFINE_STRING(er_function_filter, "*",
+              "ER instrumentation filter for function names")
+DEFINE_INT(er_log_size, 1 << 20,
+           "capacity of the ER event ring buffer, in events")
+DEFINE_STRING(er_trace, NULL,
+              "stream the ER events to the given binary trace file")
+DEFINE_INT(er_trace_chunk_size, 64 * KB,
+           "size of the ER trace chunks, which are written out at once")
+DEFINE_INT(er_sample_reads, 1, "record one in N ER read events")
+DEFINE_INT(er_sample_writes, 1, "record one in N ER write events")
+DEFINE_INT(er_sample_calls, 1, "record one in N ER function entries")
+DEFINE_INT(er_sample_burst_length, 0,
+           "record all of the first N ER events of each sampling burst period")
+DEFINE_INT(er_sample_burst_period, 100000,
+           "length of the ER sampling burst period, in events")
+DEFINE_INT(er_sample_backoff_limit, 0,
+           "throttle the hot ER access sites down to one in N events")
+DEFINE_BOOL(er_dedup_reads, true,
+            "record the repeated ER reads at an access site once per event "
+            "action")
+DEFINE_BOOL(er_detect_races, false,
+            "detect the races between the ER event actions and print them")
 
 //
 // Debug only flags
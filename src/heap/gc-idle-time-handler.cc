@@ -16,6 +16,7 @@ const size_t GCIdleTimeHandler::kMinTimeForFinalizeSweeping = 100;
 const int GCIdleTimeHandler::kMaxMarkCompactsInIdleRound = 7;
 const int GCIdleTimeHandler::kIdleScavengeThreshold = 5;
 const double GCIdleTimeHandler::kHighContextDisposalRate = 100;
+const double GCIdleTimeHandler::kMinPreemptiveScavengeFillRatio = 0.25;
 
 
 void GCIdleTimeAction::Print() {
@@ -60,8 +61,15 @@ void GCIdleTimeHandler::HeapState::Print() {
   PrintF("scavenge_speed=%" V8_PTR_PREFIX "d ", scavenge_speed_in_bytes_per_ms);
   PrintF("new_space_size=%" V8_PTR_PREFIX "d ", used_new_space_size);
   PrintF("new_space_capacity=%" V8_PTR_PREFIX "d ", new_space_capacity);
-  PrintF("new_space_allocation_throughput=%" V8_PTR_PREFIX "d",
+  PrintF("new_space_allocation_throughput=%" V8_PTR_PREFIX "d ",
          new_space_allocation_throughput_in_bytes_per_ms);
+  PrintF("can_start_incremental_marking_early=%d ",
+         can_start_incremental_marking_early);
+  PrintF("old_generation_space_available=%" V8_PTR_PREFIX "d ",
+         old_generation_space_available);
+  PrintF("old_generation_allocation_throughput=%" V8_PTR_PREFIX "d ",
+         old_generation_allocation_throughput_in_bytes_per_ms);
+  PrintF("mutator_time=%" V8_PTR_PREFIX "d", mutator_time_in_ms);
 }
 
 
@@ -150,6 +158,58 @@ bool GCIdleTimeHandler::ShouldDoScavenge(
 }
 
 
+// Scavenges now, if the new space will likely fill up while the mutator
+// runs until the next idle period, so the scavenge does not interrupt it.
+bool GCIdleTimeHandler::ShouldDoPreemptiveScavenge(
+    size_t idle_time_in_ms, size_t new_space_size, size_t used_new_space_size,
+    size_t scavenge_speed_in_bytes_per_ms,
+    size_t new_space_allocation_throughput_in_bytes_per_ms,
+    size_t mutator_time_in_ms) {
+  if (scavenge_speed_in_bytes_per_ms == 0 ||
+      new_space_allocation_throughput_in_bytes_per_ms == 0) {
+    return false;
+  }
+  if (used_new_space_size <
+      static_cast<size_t>(new_space_size * kMinPreemptiveScavengeFillRatio)) {
+    return false;
+  }
+  // The product may overflow on 32-bit hosts, so it is clamped to the new
+  // space size, which is enough to fill it up.
+  size_t expected_allocation = new_space_size;
+  if (mutator_time_in_ms <
+      new_space_size / new_space_allocation_throughput_in_bytes_per_ms) {
+    expected_allocation =
+        new_space_allocation_throughput_in_bytes_per_ms * mutator_time_in_ms;
+  }
+  if (used_new_space_size + expected_allocation < new_space_size) {
+    return false;
+  }
+  return used_new_space_size / scavenge_speed_in_bytes_per_ms <=
+         idle_time_in_ms;
+}
+
+
+// Starts incremental marking, if the old generation would reach its
+// allocation limit, at the current allocation throughput, before the
+// marking is done.
+bool GCIdleTimeHandler::ShouldStartIncrementalMarkingEarly(
+    size_t size_of_objects, size_t incremental_marking_speed_in_bytes_per_ms,
+    size_t old_generation_space_available,
+    size_t old_generation_allocation_throughput_in_bytes_per_ms) {
+  if (old_generation_allocation_throughput_in_bytes_per_ms == 0) return false;
+  if (incremental_marking_speed_in_bytes_per_ms == 0) {
+    incremental_marking_speed_in_bytes_per_ms =
+        kInitialConservativeMarkingSpeed;
+  }
+  size_t marking_time_in_ms =
+      size_of_objects / incremental_marking_speed_in_bytes_per_ms;
+  size_t time_to_limit_in_ms =
+      old_generation_space_available /
+      old_generation_allocation_throughput_in_bytes_per_ms;
+  return time_to_limit_in_ms <= marking_time_in_ms;
+}
+
+
 bool GCIdleTimeHandler::ShouldDoMarkCompact(
     size_t idle_time_in_ms, size_t size_of_objects,
     size_t mark_compact_speed_in_bytes_per_ms) {
@@ -182,6 +242,8 @@ bool GCIdleTimeHandler::ShouldDoFinalIncrementalMarkCompact(
 // a full GC.
 // (2) If the new space is almost full and we can affort a Scavenge or if the
 // next Scavenge will very likely take long, then a Scavenge is performed.
+// So is a Scavenge, which we can afford, if the new space will likely fill up
+// before the next idle period.
 // (3) If there is currently no MarkCompact idle round going on, we start a
 // new idle round if enough garbage was created. Otherwise we do not perform
 // garbage collection to keep system utilization low.
@@ -193,6 +255,9 @@ bool GCIdleTimeHandler::ShouldDoFinalIncrementalMarkCompact(
 // request, we finalize sweeping here.
 // (6) If incremental marking is in progress, we perform a marking step. Note,
 // that this currently may trigger a full garbage collection.
+// Incremental marking may be started, before the next GC is likely to be
+// full, if the old generation allocation throughput would make the marking
+// finish late otherwise.
 GCIdleTimeAction GCIdleTimeHandler::Compute(double idle_time_in_ms,
                                             HeapState heap_state) {
   if (static_cast<int>(idle_time_in_ms) <= 0) {
@@ -213,7 +278,13 @@ GCIdleTimeAction GCIdleTimeHandler::Compute(double idle_time_in_ms,
           static_cast<size_t>(idle_time_in_ms), heap_state.new_space_capacity,
           heap_state.used_new_space_size,
           heap_state.scavenge_speed_in_bytes_per_ms,
-          heap_state.new_space_allocation_throughput_in_bytes_per_ms)) {
+          heap_state.new_space_allocation_throughput_in_bytes_per_ms) ||
+      ShouldDoPreemptiveScavenge(
+          static_cast<size_t>(idle_time_in_ms), heap_state.new_space_capacity,
+          heap_state.used_new_space_size,
+          heap_state.scavenge_speed_in_bytes_per_ms,
+          heap_state.new_space_allocation_throughput_in_bytes_per_ms,
+          heap_state.mutator_time_in_ms)) {
     return GCIdleTimeAction::Scavenge();
   }
 
@@ -225,6 +296,15 @@ GCIdleTimeAction GCIdleTimeHandler::Compute(double idle_time_in_ms,
     }
   }
 
+  bool can_start_incremental_marking =
+      heap_state.can_start_incremental_marking ||
+      (heap_state.can_start_incremental_marking_early &&
+       ShouldStartIncrementalMarkingEarly(
+           heap_state.size_of_objects,
+           heap_state.incremental_marking_speed_in_bytes_per_ms,
+           heap_state.old_generation_space_available,
+           heap_state.old_generation_allocation_throughput_in_bytes_per_ms));
+
   if (heap_state.incremental_marking_stopped) {
     if (ShouldDoMarkCompact(static_cast<size_t>(idle_time_in_ms),
                             heap_state.size_of_objects,
@@ -237,12 +317,11 @@ GCIdleTimeAction GCIdleTimeHandler::Compute(double idle_time_in_ms,
       int remaining_mark_sweeps =
           kMaxMarkCompactsInIdleRound - mark_compacts_since_idle_round_started_;
       if (static_cast<size_t>(idle_time_in_ms) > kMaxFrameRenderingIdleTime &&
-          (remaining_mark_sweeps <= 2 ||
-           !heap_state.can_start_incremental_marking)) {
+          (remaining_mark_sweeps <= 2 || !can_start_incremental_marking)) {
         return GCIdleTimeAction::FullGC();
       }
     }
-    if (!heap_state.can_start_incremental_marking) {
+    if (!can_start_incremental_marking) {
       return GCIdleTimeAction::Nothing();
     }
   }
@@ -253,7 +332,7 @@ GCIdleTimeAction GCIdleTimeHandler::Compute(double idle_time_in_ms,
   }
 
   if (heap_state.incremental_marking_stopped &&
-      !heap_state.can_start_incremental_marking) {
+      !can_start_incremental_marking) {
     return GCIdleTimeAction::Nothing();
   }
   size_t step_size = EstimateMarkingStepSize(
@@ -129,12 +129,19 @@ class GCIdleTimeHandler {
   // lower bound for the scavenger speed.
   static const size_t kInitialConservativeScavengeSpeed = 100 * KB;
 
+  // A preemptive scavenge is not worth it before the new space is filled up
+  // to this fraction of its capacity.
+  static const double kMinPreemptiveScavengeFillRatio;
+
   // If contexts are disposed at a higher rate a full gc is triggered.
   static const double kHighContextDisposalRate;
 
   // Incremental marking step time.
   static const size_t kIncrementalMarkingStepTimeInMs = 1;
 
+  // Time frame of the allocation throughput, the handler uses.
+  static const size_t kAllocationThroughputTimeFrameInMs = 5000;
+
   class HeapState {
    public:
     void Print();
@@ -152,6 +159,14 @@ class GCIdleTimeHandler {
     size_t used_new_space_size;
     size_t new_space_capacity;
     size_t new_space_allocation_throughput_in_bytes_per_ms;
+    // Incremental marking may be started before the next GC is likely to be
+    // full.
+    bool can_start_incremental_marking_early;
+    size_t old_generation_space_available;
+    size_t old_generation_allocation_throughput_in_bytes_per_ms;
+    // Mutator time between the last two idle notifications, the expected
+    // time until the next idle period.
+    size_t mutator_time_in_ms;
   };
 
   GCIdleTimeHandler()
@@ -197,6 +212,17 @@ class GCIdleTimeHandler {
       size_t scavenger_speed_in_bytes_per_ms,
       size_t new_space_allocation_throughput_in_bytes_per_ms);
 
+  static bool ShouldDoPreemptiveScavenge(
+      size_t idle_time_in_ms, size_t new_space_size, size_t used_new_space_size,
+      size_t scavenger_speed_in_bytes_per_ms,
+      size_t new_space_allocation_throughput_in_bytes_per_ms,
+      size_t mutator_time_in_ms);
+
+  static bool ShouldStartIncrementalMarkingEarly(
+      size_t size_of_objects, size_t incremental_marking_speed_in_bytes_per_ms,
+      size_t old_generation_space_available,
+      size_t old_generation_allocation_throughput_in_bytes_per_ms);
+
  private:
   void StartIdleRound() { mark_compacts_since_idle_round_started_ = 0; }
   bool IsMarkCompactIdleRoundFinished() {
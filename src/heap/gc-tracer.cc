@@ -19,10 +19,12 @@ static intptr_t CountTotalHolesSize(Heap* heap) {
 }
 
 
-GCTracer::AllocationEvent::AllocationEvent(double duration,
-                                           intptr_t allocation_in_bytes) {
+GCTracer::AllocationEvent::AllocationEvent(
+    double duration, intptr_t new_space_allocation_in_bytes,
+    intptr_t old_generation_allocation_in_bytes) {
   duration_ = duration;
-  allocation_in_bytes_ = allocation_in_bytes;
+  new_space_allocation_in_bytes_ = new_space_allocation_in_bytes;
+  old_generation_allocation_in_bytes_ = old_generation_allocation_in_bytes;
 }
 
 
@@ -100,6 +102,7 @@ GCTracer::GCTracer(Heap* heap)
       cumulative_marking_duration_(0.0),
       cumulative_sweeping_duration_(0.0),
       new_space_top_after_gc_(0),
+      old_generation_size_after_gc_(0),
       start_counter_(0) {
   current_ = Event(Event::START, NULL, NULL);
   current_.end_time = base::OS::TimeCurrentMillis();
@@ -112,14 +115,13 @@ void GCTracer::Start(GarbageCollector collector, const char* gc_reason,
   start_counter_++;
   if (start_counter_ != 1) return;
 
-  previous_ = current_;
   double start_time = base::OS::TimeCurrentMillis();
-  if (new_space_top_after_gc_ != 0) {
-    AddNewSpaceAllocationTime(
-        start_time - previous_.end_time,
-        reinterpret_cast<intptr_t>((heap_->new_space()->top()) -
-                                   new_space_top_after_gc_));
+  AllocationEvent allocation = AllocationSinceLastGC(start_time);
+  if (allocation.duration_ > 0.0) {
+    allocation_events_.push_front(allocation);
   }
+
+  previous_ = current_;
   if (current_.type == Event::INCREMENTAL_MARK_COMPACTOR)
     previous_incremental_mark_compactor_event_ = current_;
 
@@ -180,6 +182,7 @@ void GCTracer::Stop(GarbageCollector collector) {
   current_.end_holes_size = CountTotalHolesSize(heap_);
   new_space_top_after_gc_ =
       reinterpret_cast<intptr_t>(heap_->new_space()->top());
+  old_generation_size_after_gc_ = heap_->PromotedSpaceSizeOfObjects();
 
   if (current_.type == Event::SCAVENGER) {
     current_.incremental_marking_steps =
@@ -246,9 +249,12 @@ void GCTracer::Stop(GarbageCollector collector) {
 }
 
 
-void GCTracer::AddNewSpaceAllocationTime(double duration,
-                                         intptr_t allocation_in_bytes) {
-  allocation_events_.push_front(AllocationEvent(duration, allocation_in_bytes));
+void GCTracer::AddAllocationTime(double duration,
+                                 intptr_t new_space_allocation_in_bytes,
+                                 intptr_t old_generation_allocation_in_bytes) {
+  allocation_events_.push_front(
+      AllocationEvent(duration, new_space_allocation_in_bytes,
+                      old_generation_allocation_in_bytes));
 }
 
 
@@ -538,12 +544,38 @@ intptr_t GCTracer::FinalIncrementalMarkCompactSpeedInBytesPerMillisecond()
 }
 
 
-intptr_t GCTracer::NewSpaceAllocationThroughputInBytesPerMillisecond() const {
-  intptr_t bytes = 0;
-  double durations = 0.0;
+GCTracer::AllocationEvent GCTracer::AllocationSinceLastGC(
+    double current_time) const {
+  // The new space top is not known before the first garbage collection.
+  if (new_space_top_after_gc_ == 0) {
+    return AllocationEvent(0.0, 0, 0);
+  }
+  intptr_t new_space_bytes =
+      reinterpret_cast<intptr_t>(heap_->new_space()->top()) -
+      new_space_top_after_gc_;
+  intptr_t old_generation_bytes =
+      heap_->PromotedSpaceSizeOfObjects() - old_generation_size_after_gc_;
+  return AllocationEvent(current_time - current_.end_time,
+                         Max(new_space_bytes, static_cast<intptr_t>(0)),
+                         Max(old_generation_bytes, static_cast<intptr_t>(0)));
+}
+
+
+intptr_t GCTracer::AllocationThroughputInBytesPerMillisecond(
+    bool old_generation, double time_ms) const {
+  // The current event is only complete outside of the garbage collection.
+  AllocationEvent current(0.0, 0, 0);
+  if (start_counter_ == 0) {
+    current = AllocationSinceLastGC(base::OS::TimeCurrentMillis());
+  }
+  intptr_t bytes = old_generation ? current.old_generation_allocation_in_bytes_
+                                  : current.new_space_allocation_in_bytes_;
+  double durations = current.duration_;
   AllocationEventBuffer::const_iterator iter = allocation_events_.begin();
-  while (iter != allocation_events_.end()) {
-    bytes += iter->allocation_in_bytes_;
+  while (iter != allocation_events_.end() &&
+         (time_ms == 0.0 || durations < time_ms)) {
+    bytes += old_generation ? iter->old_generation_allocation_in_bytes_
+                            : iter->new_space_allocation_in_bytes_;
     durations += iter->duration_;
     ++iter;
   }
@@ -554,6 +586,18 @@ intptr_t GCTracer::NewSpaceAllocationThroughputInBytesPerMillisecond() const {
 }
 
 
+intptr_t GCTracer::NewSpaceAllocationThroughputInBytesPerMillisecond(
+    double time_ms) const {
+  return AllocationThroughputInBytesPerMillisecond(false, time_ms);
+}
+
+
+intptr_t GCTracer::OldGenerationAllocationThroughputInBytesPerMillisecond(
+    double time_ms) const {
+  return AllocationThroughputInBytesPerMillisecond(true, time_ms);
+}
+
+
 double GCTracer::ContextDisposalRateInMilliseconds() const {
   if (context_disposal_events_.size() < kRingBufferMaxSize) return 0.0;
 
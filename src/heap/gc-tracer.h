@@ -140,7 +140,8 @@ class GCTracer {
     // Default constructor leaves the event uninitialized.
     AllocationEvent() {}
 
-    AllocationEvent(double duration, intptr_t allocation_in_bytes);
+    AllocationEvent(double duration, intptr_t new_space_allocation_in_bytes,
+                    intptr_t old_generation_allocation_in_bytes);
 
     // Time spent in the mutator during the end of the last garbage collection
     // to the beginning of the next garbage collection.
@@ -148,7 +149,11 @@ class GCTracer {
 
     // Memory allocated in the new space during the end of the last garbage
     // collection to the beginning of the next garbage collection.
-    intptr_t allocation_in_bytes_;
+    intptr_t new_space_allocation_in_bytes_;
+
+    // Growth of the old generation during the same time. It is an
+    // approximation, as the concurrent sweeping shrinks the old generation.
+    intptr_t old_generation_allocation_in_bytes_;
   };
 
 
@@ -295,7 +300,9 @@ class GCTracer {
   void Stop(GarbageCollector collector);
 
   // Log an allocation throughput event.
-  void AddNewSpaceAllocationTime(double duration, intptr_t allocation_in_bytes);
+  void AddAllocationTime(double duration,
+                         intptr_t new_space_allocation_in_bytes,
+                         intptr_t old_generation_allocation_in_bytes);
 
   void AddContextDisposalTime(double time);
 
@@ -377,9 +384,19 @@ class GCTracer {
   // Returns 0 if no events have been recorded.
   intptr_t FinalIncrementalMarkCompactSpeedInBytesPerMillisecond() const;
 
-  // Allocation throughput in the new space in bytes/millisecond.
+  // Allocation throughput in the new space in bytes/millisecond. It takes
+  // the mutator time since the last garbage collection and the recorded
+  // events, the most recent first, until they cover |time_ms| (all of them,
+  // if |time_ms| is 0).
+  // Returns 0 if no events have been recorded.
+  intptr_t NewSpaceAllocationThroughputInBytesPerMillisecond(
+      double time_ms = 0.0) const;
+
+  // Allocation throughput in the old generation in bytes/millisecond, over
+  // the same time as above.
   // Returns 0 if no events have been recorded.
-  intptr_t NewSpaceAllocationThroughputInBytesPerMillisecond() const;
+  intptr_t OldGenerationAllocationThroughputInBytesPerMillisecond(
+      double time_ms = 0.0) const;
 
   // Computes the context disposal rate in milliseconds. It takes the time
   // frame of the first recorded context disposal to the current time and
@@ -413,6 +430,13 @@ class GCTracer {
   // Compute the max duration of the events in the given ring buffer.
   double MaxDuration(const EventBuffer& events) const;
 
+  // The allocation in the mutator time from the end of the last garbage
+  // collection to |current_time|. Its duration is 0, if it is not known.
+  AllocationEvent AllocationSinceLastGC(double current_time) const;
+
+  intptr_t AllocationThroughputInBytesPerMillisecond(bool old_generation,
+                                                     double time_ms) const;
+
   void ClearMarkCompactStatistics() {
     cumulative_incremental_marking_steps_ = 0;
     cumulative_incremental_marking_bytes_ = 0;
@@ -488,6 +512,10 @@ class GCTracer {
   // collection.
   intptr_t new_space_top_after_gc_;
 
+  // Holds the size of the old generation objects recorded at the end of the
+  // last garbage collection.
+  intptr_t old_generation_size_after_gc_;
+
   // Counts how many tracers were started without stopping.
   int start_counter_;
 
@@ -16,6 +16,7 @@
 #include "src/cpu-profiler.h"
 #include "src/debug.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/global-handles.h"
 #include "src/heap/gc-idle-time-handler.h"
 #include "src/heap/incremental-marking.h"
@@ -1687,6 +1688,7 @@ void Heap::ProcessWeakReferences(WeakObjectRetainer* retainer) {
   // TODO(mvstanton): AllocationSites only need to be processed during
   // MARK_COMPACT, as they live in old space. Verify and address.
   ProcessAllocationSites(retainer);
+  isolate()->event_racer_log()->ProcessWeakReferences(retainer);
   // Collects callback info for handles that are pending (about to be
   // collected) and either phantom or internal-fields.  Releases the global
   // handles.  See also PostGarbageCollectionProcessing.
@@ -4518,9 +4520,25 @@ bool Heap::IdleNotification(double deadline_in_seconds) {
   heap_state.new_space_capacity = new_space_.Capacity();
   heap_state.new_space_allocation_throughput_in_bytes_per_ms =
       static_cast<size_t>(
-          tracer()->NewSpaceAllocationThroughputInBytesPerMillisecond());
+          tracer()->NewSpaceAllocationThroughputInBytesPerMillisecond(
+              GCIdleTimeHandler::kAllocationThroughputTimeFrameInMs));
+  heap_state.can_start_incremental_marking_early =
+      incremental_marking()->WorthActivating();
+  heap_state.old_generation_space_available =
+      static_cast<size_t>(Max(OldGenerationSpaceAvailable(),
+                              static_cast<intptr_t>(0)));
+  heap_state.old_generation_allocation_throughput_in_bytes_per_ms =
+      static_cast<size_t>(
+          tracer()->OldGenerationAllocationThroughputInBytesPerMillisecond(
+              GCIdleTimeHandler::kAllocationThroughputTimeFrameInMs));
+
+  double start_time = MonotonicallyIncreasingTimeInMs();
+  heap_state.mutator_time_in_ms =
+      last_idle_notification_time_ > 0.0
+          ? static_cast<size_t>(start_time - last_idle_notification_time_)
+          : 0;
 
-  double idle_time_in_ms = deadline_in_ms - MonotonicallyIncreasingTimeInMs();
+  double idle_time_in_ms = deadline_in_ms - start_time;
   GCIdleTimeAction action =
       gc_idle_time_handler_.Compute(idle_time_in_ms, heap_state);
   isolate()->counters()->gc_idle_time_allotted_in_ms()->AddSample(
@@ -5530,6 +5548,8 @@ void Heap::TearDown() {
 
   external_string_table_.TearDown();
 
+  incremental_marking()->TearDown();
+
   mark_compact_collector()->TearDown();
 
   new_space_.TearDown();
@@ -28,7 +28,8 @@ IncrementalMarking::IncrementalMarking(Heap* heap)
       idle_marking_delay_counter_(0),
       no_marking_scope_depth_(0),
       unscanned_bytes_of_large_object_(0),
-      was_activated_(false) {}
+      was_activated_(false),
+      step_task_(NULL) {}
 
 
 void IncrementalMarking::RecordWriteSlow(HeapObject* obj, Object** slot,
@@ -556,6 +557,8 @@ void IncrementalMarking::StartMarking(CompactionFlag flag) {
   if (FLAG_trace_incremental_marking) {
     PrintF("[IncrementalMarking] Running\n");
   }
+
+  if (FLAG_incremental_marking_task) ScheduleStepTask();
 }
 
 
@@ -958,6 +961,63 @@ intptr_t IncrementalMarking::Step(intptr_t allocated_bytes,
 }
 
 
+class IncrementalMarking::StepTask : public v8::Task {
+ public:
+  explicit StepTask(IncrementalMarking* marking) : marking_(marking) {}
+
+  virtual ~StepTask() {
+    if (marking_ != NULL && marking_->step_task_ == this) {
+      marking_->step_task_ = NULL;
+    }
+  }
+
+  // The platform may run or delete the task after the heap is gone.
+  void Cancel() { marking_ = NULL; }
+
+ private:
+  // v8::Task overrides.
+  void Run() OVERRIDE {
+    if (marking_ != NULL) marking_->RunStepTask();
+  }
+
+  IncrementalMarking* marking_;
+
+  DISALLOW_COPY_AND_ASSIGN(StepTask);
+};
+
+
+void IncrementalMarking::ScheduleStepTask() {
+  // A pending task serves a restarted marking, too.
+  if (step_task_ != NULL) return;
+  step_task_ = new StepTask(this);
+  V8::GetCurrentPlatform()->CallOnForegroundThread(
+      reinterpret_cast<v8::Isolate*>(heap_->isolate()), step_task_);
+}
+
+
+void IncrementalMarking::RunStepTask() {
+  step_task_ = NULL;
+  // While sweeping, the task is not posted, StartMarking posts it again.
+  if (state_ != MARKING) return;
+  Step(kAllocatedThreshold, NO_GC_VIA_STACK_GUARD, FORCE_MARKING);
+  if (IsComplete()) {
+    // No JavaScript runs here to notice a GC request on the stack guard.
+    heap_->CollectAllGarbage(Heap::kNoGCFlags,
+                             "incremental marking task: finalize marking");
+  } else if (state_ == MARKING) {
+    ScheduleStepTask();
+  }
+}
+
+
+void IncrementalMarking::TearDown() {
+  if (step_task_ != NULL) {
+    step_task_->Cancel();
+    step_task_ = NULL;
+  }
+}
+
+
 void IncrementalMarking::ResetStepCounters() {
   steps_count_ = 0;
   old_generation_space_available_at_start_of_incremental_ =
@@ -176,7 +176,21 @@ class IncrementalMarking {
 
   bool IsIdleMarkingDelayCounterLimitReached();
 
+  // With --incremental-marking-task, the marking is also advanced by tasks,
+  // posted to the foreground thread of the platform, so it makes progress
+  // when the embedder runs the message loop, not only when the mutator
+  // allocates. The task finalizes the marking with a full GC, when it is
+  // complete.
+  void ScheduleStepTask();
+
+  // Cancels the pending step task.
+  void TearDown();
+
  private:
+  class StepTask;
+
+  void RunStepTask();
+
   int64_t SpaceLeftInOldSpace();
 
   void SpeedUp();
@@ -228,6 +242,9 @@ class IncrementalMarking {
 
   bool was_activated_;
 
+  // The posted step task, which has not run yet.
+  StepTask* step_task_;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(IncrementalMarking);
 };
 }
@@ -17,6 +17,7 @@
 #include "src/heap/mark-compact.h"
 #include "src/heap/objects-visiting.h"
 #include "src/heap/objects-visiting-inl.h"
+#include "src/heap/parallel-page-job.h"
 #include "src/heap/spaces-inl.h"
 #include "src/heap-profiler.h"
 #include "src/ic/ic.h"
@@ -402,32 +403,68 @@ void MarkCompactCollector::VerifyOmittedMapChecks() {
 #endif  // VERIFY_HEAP
 
 
-static void ClearMarkbitsInPagedSpace(PagedSpace* space) {
+static void CollectPagesOfPagedSpace(PagedSpace* space,
+                                     List<MemoryChunk*>* pages) {
   PageIterator it(space);
 
   while (it.has_next()) {
-    Bitmap::Clear(it.next());
+    pages->Add(it.next());
   }
 }
 
 
-static void ClearMarkbitsInNewSpace(NewSpace* space) {
+static void CollectPagesOfNewSpace(NewSpace* space,
+                                   List<MemoryChunk*>* pages) {
   NewSpacePageIterator it(space->ToSpaceStart(), space->ToSpaceEnd());
 
   while (it.has_next()) {
-    Bitmap::Clear(it.next());
+    pages->Add(it.next());
   }
 }
 
 
+// Clears the mark bits and the live bytes of the pages. The pages do not
+// share any of these, so no synchronization is needed.
+class MarkbitClearingJob : public ParallelPageJob {
+ public:
+  explicit MarkbitClearingJob(List<MemoryChunk*>* pages)
+      : ParallelPageJob(pages->length()), pages_(pages) {}
+
+ protected:
+  void ProcessPage(int index) OVERRIDE { Bitmap::Clear(pages_->at(index)); }
+
+ private:
+  // Owned by the main thread, which is blocked, while the pages are
+  // processed.
+  List<MemoryChunk*>* pages_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkbitClearingJob);
+};
+
+
+// Upper bound on the worker tasks, clearing the mark bits.
+static const int kMaxMarkbitClearingTasks = 7;
+
+
 void MarkCompactCollector::ClearMarkbits() {
-  ClearMarkbitsInPagedSpace(heap_->code_space());
-  ClearMarkbitsInPagedSpace(heap_->map_space());
-  ClearMarkbitsInPagedSpace(heap_->old_pointer_space());
-  ClearMarkbitsInPagedSpace(heap_->old_data_space());
-  ClearMarkbitsInPagedSpace(heap_->cell_space());
-  ClearMarkbitsInPagedSpace(heap_->property_cell_space());
-  ClearMarkbitsInNewSpace(heap_->new_space());
+  List<MemoryChunk*> pages;
+  CollectPagesOfPagedSpace(heap_->code_space(), &pages);
+  CollectPagesOfPagedSpace(heap_->map_space(), &pages);
+  CollectPagesOfPagedSpace(heap_->old_pointer_space(), &pages);
+  CollectPagesOfPagedSpace(heap_->old_data_space(), &pages);
+  CollectPagesOfPagedSpace(heap_->cell_space(), &pages);
+  CollectPagesOfPagedSpace(heap_->property_cell_space(), &pages);
+  CollectPagesOfNewSpace(heap_->new_space(), &pages);
+
+  if (FLAG_parallel_markbit_clearing && pages.length() > 1) {
+    MarkbitClearingJob* job = new MarkbitClearingJob(&pages);
+    job->Run(kMaxMarkbitClearingTasks);
+    job->Release();
+  } else {
+    for (int i = 0; i < pages.length(); ++i) {
+      Bitmap::Clear(pages[i]);
+    }
+  }
 
   LargeObjectIterator it(heap_->lo_space());
   for (HeapObject* obj = it.Next(); obj != NULL; obj = it.Next()) {
@@ -3372,6 +3409,40 @@ void MarkCompactCollector::ProcessInvalidatedCode(ObjectVisitor* visitor) {
 }
 
 
+// Updates the untyped slots, recorded in the slots buffers of the
+// evacuation candidates. A slot may be recorded for several pages, but the
+// update is idempotent and atomic.
+class SlotsUpdatingJob : public ParallelPageJob {
+ public:
+  SlotsUpdatingJob(Heap* heap, List<Page*>* pages,
+                   bool code_slots_filtering_required)
+      : ParallelPageJob(pages->length()),
+        heap_(heap),
+        pages_(pages),
+        code_slots_filtering_required_(code_slots_filtering_required) {}
+
+ protected:
+  void ProcessPage(int index) OVERRIDE {
+    SlotsBuffer::UpdateSlotsRecordedIn(
+        heap_, pages_->at(index)->slots_buffer(),
+        code_slots_filtering_required_, SlotsBuffer::UNTYPED_SLOTS_ONLY);
+  }
+
+ private:
+  Heap* heap_;
+  // Owned by the main thread, which is blocked, while the pages are
+  // processed.
+  List<Page*>* pages_;
+  bool code_slots_filtering_required_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlotsUpdatingJob);
+};
+
+
+// Upper bound on the worker tasks, updating the slots.
+static const int kMaxSlotsUpdatingTasks = 7;
+
+
 void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
   Heap::RelocationLock relocation_lock(heap());
 
@@ -3455,6 +3526,22 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
     GCTracer::Scope gc_scope(
         heap()->tracer(),
         GCTracer::Scope::MC_UPDATE_POINTERS_BETWEEN_EVACUATED);
+    SlotsBuffer::SlotSelection selection = SlotsBuffer::ALL_SLOTS;
+    if (FLAG_parallel_pointer_update) {
+      List<Page*> pages;
+      for (int i = 0; i < npages; i++) {
+        Page* p = evacuation_candidates_[i];
+        if (p->IsEvacuationCandidate()) pages.Add(p);
+      }
+      if (pages.length() > 1) {
+        SlotsUpdatingJob* job =
+            new SlotsUpdatingJob(heap_, &pages, code_slots_filtering_required);
+        job->Run(kMaxSlotsUpdatingTasks);
+        job->Release();
+        selection = SlotsBuffer::TYPED_SLOTS_ONLY;
+      }
+    }
+
     for (int i = 0; i < npages; i++) {
       Page* p = evacuation_candidates_[i];
       DCHECK(p->IsEvacuationCandidate() ||
@@ -3462,7 +3549,8 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
 
       if (p->IsEvacuationCandidate()) {
         SlotsBuffer::UpdateSlotsRecordedIn(heap_, p->slots_buffer(),
-                                           code_slots_filtering_required);
+                                           code_slots_filtering_required,
+                                           selection);
         if (FLAG_trace_fragmentation) {
           PrintF("  page %p slots buffer: %d\n", reinterpret_cast<void*>(p),
                  SlotsBuffer::SizeOfChain(p->slots_buffer()));
@@ -4350,37 +4438,42 @@ static inline SlotsBuffer::SlotType DecodeSlotType(
 }
 
 
-void SlotsBuffer::UpdateSlots(Heap* heap) {
+void SlotsBuffer::UpdateSlots(Heap* heap, SlotSelection selection) {
   PointersUpdatingVisitor v(heap);
 
   for (int slot_idx = 0; slot_idx < idx_; ++slot_idx) {
     ObjectSlot slot = slots_[slot_idx];
     if (!IsTypedSlot(slot)) {
-      PointersUpdatingVisitor::UpdateSlot(heap, slot);
+      if (selection != TYPED_SLOTS_ONLY) {
+        PointersUpdatingVisitor::UpdateSlot(heap, slot);
+      }
     } else {
       ++slot_idx;
       DCHECK(slot_idx < idx_);
-      UpdateSlot(heap->isolate(), &v, DecodeSlotType(slot),
-                 reinterpret_cast<Address>(slots_[slot_idx]));
+      if (selection != UNTYPED_SLOTS_ONLY) {
+        UpdateSlot(heap->isolate(), &v, DecodeSlotType(slot),
+                   reinterpret_cast<Address>(slots_[slot_idx]));
+      }
     }
   }
 }
 
 
-void SlotsBuffer::UpdateSlotsWithFilter(Heap* heap) {
+void SlotsBuffer::UpdateSlotsWithFilter(Heap* heap, SlotSelection selection) {
   PointersUpdatingVisitor v(heap);
 
   for (int slot_idx = 0; slot_idx < idx_; ++slot_idx) {
     ObjectSlot slot = slots_[slot_idx];
     if (!IsTypedSlot(slot)) {
-      if (!IsOnInvalidatedCodeObject(reinterpret_cast<Address>(slot))) {
+      if (selection != TYPED_SLOTS_ONLY &&
+          !IsOnInvalidatedCodeObject(reinterpret_cast<Address>(slot))) {
         PointersUpdatingVisitor::UpdateSlot(heap, slot);
       }
     } else {
       ++slot_idx;
       DCHECK(slot_idx < idx_);
       Address pc = reinterpret_cast<Address>(slots_[slot_idx]);
-      if (!IsOnInvalidatedCodeObject(pc)) {
+      if (selection != UNTYPED_SLOTS_ONLY && !IsOnInvalidatedCodeObject(pc)) {
         UpdateSlot(heap->isolate(), &v, DecodeSlotType(slot),
                    reinterpret_cast<Address>(slots_[slot_idx]));
       }
@@ -295,9 +295,14 @@ class SlotsBuffer {
     return "UNKNOWN SlotType";
   }
 
-  void UpdateSlots(Heap* heap);
+  // The untyped slots are updated with a compare-and-swap, so the slots
+  // buffers of different pages can be updated in parallel. The typed slots
+  // patch the code, so they are updated on the main thread.
+  enum SlotSelection { ALL_SLOTS, UNTYPED_SLOTS_ONLY, TYPED_SLOTS_ONLY };
 
-  void UpdateSlotsWithFilter(Heap* heap);
+  void UpdateSlots(Heap* heap, SlotSelection selection = ALL_SLOTS);
+
+  void UpdateSlotsWithFilter(Heap* heap, SlotSelection selection = ALL_SLOTS);
 
   SlotsBuffer* next() { return next_; }
 
@@ -312,12 +317,13 @@ class SlotsBuffer {
   inline bool HasSpaceForTypedSlot() { return idx_ < kNumberOfElements - 1; }
 
   static void UpdateSlotsRecordedIn(Heap* heap, SlotsBuffer* buffer,
-                                    bool code_slots_filtering_required) {
+                                    bool code_slots_filtering_required,
+                                    SlotSelection selection = ALL_SLOTS) {
     while (buffer != NULL) {
       if (code_slots_filtering_required) {
-        buffer->UpdateSlotsWithFilter(heap);
+        buffer->UpdateSlotsWithFilter(heap, selection);
       } else {
-        buffer->UpdateSlots(heap);
+        buffer->UpdateSlots(heap, selection);
       }
       buffer = buffer->next();
     }
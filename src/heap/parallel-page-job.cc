@@ -0,0 +1,76 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/v8.h"
+
+#include "src/base/sys-info.h"
+#include "src/heap/parallel-page-job.h"
+
+namespace v8 {
+namespace internal {
+
+class ParallelPageJob::Task : public v8::Task {
+ public:
+  explicit Task(ParallelPageJob* job) : job_(job) {}
+
+  virtual ~Task() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() OVERRIDE {
+    job_->ProcessPages(true);
+    job_->Release();
+  }
+
+  ParallelPageJob* job_;
+
+  DISALLOW_COPY_AND_ASSIGN(Task);
+};
+
+
+ParallelPageJob::ParallelPageJob(int page_count)
+    : page_count_(page_count),
+      next_page_(0),
+      ref_count_(1),
+      pages_done_(0) {}
+
+
+int ParallelPageJob::NumberOfTasks(int page_count, int max_tasks) {
+  // The main thread takes a page, too.
+  int tasks = Min(page_count - 1, max_tasks);
+  tasks = Min(tasks, base::SysInfo::NumberOfProcessors() - 1);
+  return Max(tasks, 0);
+}
+
+
+void ParallelPageJob::Run(int max_tasks) {
+  int task_count = NumberOfTasks(page_count_, max_tasks);
+  base::NoBarrier_AtomicIncrement(&ref_count_, task_count);
+  for (int i = 0; i < task_count; ++i) {
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new Task(this), v8::Platform::kShortRunningTask);
+  }
+  int processed = ProcessPages(false);
+  for (int i = processed; i < page_count_; ++i) pages_done_.Wait();
+}
+
+
+int ParallelPageJob::ProcessPages(bool signal) {
+  int processed = 0;
+  for (;;) {
+    int index = base::NoBarrier_AtomicIncrement(&next_page_, 1) - 1;
+    if (index >= page_count_) break;
+    ProcessPage(index);
+    ++processed;
+    if (signal) pages_done_.Signal();
+  }
+  return processed;
+}
+
+
+void ParallelPageJob::Release() {
+  if (base::Barrier_AtomicIncrement(&ref_count_, -1) == 0) delete this;
+}
+}
+}  // namespace v8::internal
@@ -0,0 +1,66 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_HEAP_PARALLEL_PAGE_JOB_H_
+#define V8_HEAP_PARALLEL_PAGE_JOB_H_
+
+#include "src/base/atomicops.h"
+#include "src/base/platform/semaphore.h"
+#include "src/globals.h"
+
+namespace v8 {
+namespace internal {
+
+// Processes a number of pages, each one independently of the others, on
+// the worker threads of the platform and on the main thread, which is
+// blocked meanwhile. The pages are claimed one by one, so the threads,
+// which get to run first, take more of them.
+//
+// The main thread waits for the pages, claimed by the worker tasks, to be
+// done, but not for the tasks, which have not started yet, e.g. because the
+// workers are busy with sweeping. The tasks find no pages left, when they
+// run late, so the job is reference counted and deleted by the last of the
+// main thread and the tasks. A subclass must therefore be allocated with
+// new, and must not touch anything, but its own fields, in the destructor.
+class ParallelPageJob {
+ public:
+  explicit ParallelPageJob(int page_count);
+  virtual ~ParallelPageJob() {}
+
+  // Processes all the pages, using up to |max_tasks| worker tasks. Called
+  // once, on the main thread.
+  void Run(int max_tasks);
+
+  // Drops the reference of the main thread. The results of the job are
+  // read before this.
+  void Release();
+
+  int page_count() const { return page_count_; }
+
+  // The number of the worker tasks, worth starting for |page_count| pages.
+  static int NumberOfTasks(int page_count, int max_tasks);
+
+ protected:
+  // Processes the page |index|. Called on the main thread or on a worker
+  // thread, while the main thread is in |Run|.
+  virtual void ProcessPage(int index) = 0;
+
+ private:
+  class Task;
+
+  // Processes the pages until none is left. Returns the number of the
+  // pages processed. The worker tasks signal each page done.
+  int ProcessPages(bool signal);
+
+  int page_count_;
+  base::Atomic32 next_page_;
+  base::Atomic32 ref_count_;
+  base::Semaphore pages_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelPageJob);
+};
+}
+}  // namespace v8::internal
+
+#endif  // V8_HEAP_PARALLEL_PAGE_JOB_H_
@@ -8,6 +8,7 @@
 
 #include "src/base/atomicops.h"
 #include "src/counters.h"
+#include "src/heap/parallel-page-job.h"
 #include "src/heap/store-buffer-inl.h"
 
 namespace v8 {
@@ -374,21 +375,28 @@ void StoreBuffer::FindPointersToNewSpaceInRegion(
     bool clear_maps) {
   for (Address slot_address = start; slot_address < end;
        slot_address += kPointerSize) {
-    Object** slot = reinterpret_cast<Object**>(slot_address);
-    Object* object = reinterpret_cast<Object*>(
+    VisitSlotToNewSpace(slot_address, slot_callback, clear_maps);
+  }
+}
+
+
+void StoreBuffer::VisitSlotToNewSpace(Address slot_address,
+                                      ObjectSlotCallback slot_callback,
+                                      bool clear_maps) {
+  Object** slot = reinterpret_cast<Object**>(slot_address);
+  Object* object = reinterpret_cast<Object*>(
+      base::NoBarrier_Load(reinterpret_cast<base::AtomicWord*>(slot)));
+  if (heap_->InNewSpace(object)) {
+    HeapObject* heap_object = reinterpret_cast<HeapObject*>(object);
+    DCHECK(heap_object->IsHeapObject());
+    // The new space object was not promoted if it still contains a map
+    // pointer. Clear the map field now lazily.
+    if (clear_maps) ClearDeadObject(heap_object);
+    slot_callback(reinterpret_cast<HeapObject**>(slot), heap_object);
+    object = reinterpret_cast<Object*>(
         base::NoBarrier_Load(reinterpret_cast<base::AtomicWord*>(slot)));
     if (heap_->InNewSpace(object)) {
-      HeapObject* heap_object = reinterpret_cast<HeapObject*>(object);
-      DCHECK(heap_object->IsHeapObject());
-      // The new space object was not promoted if it still contains a map
-      // pointer. Clear the map field now lazily.
-      if (clear_maps) ClearDeadObject(heap_object);
-      slot_callback(reinterpret_cast<HeapObject**>(slot), heap_object);
-      object = reinterpret_cast<Object*>(
-          base::NoBarrier_Load(reinterpret_cast<base::AtomicWord*>(slot)));
-      if (heap_->InNewSpace(object)) {
-        EnterDirectlyIntoStoreBuffer(slot_address);
-      }
+      EnterDirectlyIntoStoreBuffer(slot_address);
     }
   }
 }
@@ -458,98 +466,241 @@ void StoreBuffer::IteratePointersToNewSpace(ObjectSlotCallback slot_callback,
   // space left on the page we will keep the pointers in the store buffer and
   // remove the flag from the page.
   if (some_pages_to_scan) {
-    if (callback_ != NULL) {
-      (*callback_)(heap_, NULL, kStoreBufferStartScanningPagesEvent);
+    IteratePointersOnScanOnScavengePages(slot_callback, clear_maps);
+  }
+}
+
+
+void StoreBuffer::EnsureChunkIsSwept(MemoryChunk* chunk) {
+  if (chunk->owner() == heap_->lo_space()) return;
+  Page* page = reinterpret_cast<Page*>(chunk);
+  PagedSpace* owner = reinterpret_cast<PagedSpace*>(page->owner());
+  if (owner == heap_->map_space()) {
+    DCHECK(page->WasSwept());
+    return;
+  }
+  if (!page->SweepingCompleted()) {
+    heap_->mark_compact_collector()->SweepInParallel(page, owner);
+    if (!page->SweepingCompleted()) {
+      // We were not able to sweep that page, i.e., a concurrent
+      // sweeper thread currently owns this page.
+      // TODO(hpayer): This may introduce a huge pause here. We
+      // just care about finish sweeping of the scan on scavenge page.
+      heap_->mark_compact_collector()->EnsureSweepingCompleted();
     }
-    PointerChunkIterator it(heap_);
-    MemoryChunk* chunk;
-    while ((chunk = it.next()) != NULL) {
-      if (chunk->scan_on_scavenge()) {
-        chunk->set_scan_on_scavenge(false);
-        if (callback_ != NULL) {
-          (*callback_)(heap_, chunk, kStoreBufferScanningPageEvent);
-        }
-        if (chunk->owner() == heap_->lo_space()) {
-          LargePage* large_page = reinterpret_cast<LargePage*>(chunk);
-          HeapObject* array = large_page->GetObject();
-          DCHECK(array->IsFixedArray());
-          Address start = array->address();
-          Address end = start + array->Size();
-          FindPointersToNewSpaceInRegion(start, end, slot_callback, clear_maps);
-        } else {
-          Page* page = reinterpret_cast<Page*>(chunk);
-          PagedSpace* owner = reinterpret_cast<PagedSpace*>(page->owner());
-          if (owner == heap_->map_space()) {
-            DCHECK(page->WasSwept());
-            HeapObjectIterator iterator(page, NULL);
-            for (HeapObject* heap_object = iterator.Next(); heap_object != NULL;
-                 heap_object = iterator.Next()) {
-              // We skip free space objects.
-              if (!heap_object->IsFiller()) {
-                DCHECK(heap_object->IsMap());
-                FindPointersToNewSpaceInRegion(
-                    heap_object->address() + Map::kPointerFieldsBeginOffset,
-                    heap_object->address() + Map::kPointerFieldsEndOffset,
-                    slot_callback, clear_maps);
-              }
-            }
-          } else {
-            if (!page->SweepingCompleted()) {
-              heap_->mark_compact_collector()->SweepInParallel(page, owner);
-              if (!page->SweepingCompleted()) {
-                // We were not able to sweep that page, i.e., a concurrent
-                // sweeper thread currently owns this page.
-                // TODO(hpayer): This may introduce a huge pause here. We
-                // just care about finish sweeping of the scan on scavenge page.
-                heap_->mark_compact_collector()->EnsureSweepingCompleted();
-              }
-            }
-            CHECK(page->owner() == heap_->old_pointer_space());
-            HeapObjectIterator iterator(page, NULL);
-            for (HeapObject* heap_object = iterator.Next(); heap_object != NULL;
-                 heap_object = iterator.Next()) {
-              // We iterate over objects that contain new space pointers only.
-              bool may_contain_raw_values = heap_object->MayContainRawValues();
-              if (!may_contain_raw_values) {
-                Address obj_address = heap_object->address();
-                const int start_offset = HeapObject::kHeaderSize;
-                const int end_offset = heap_object->Size();
+  }
+  CHECK(page->owner() == heap_->old_pointer_space());
+}
+
+
+template <class RegionVisitor>
+void StoreBuffer::VisitPointerRegions(MemoryChunk* chunk,
+                                      RegionVisitor* visitor) {
+  if (chunk->owner() == heap_->lo_space()) {
+    LargePage* large_page = reinterpret_cast<LargePage*>(chunk);
+    HeapObject* array = large_page->GetObject();
+    DCHECK(array->IsFixedArray());
+    Address start = array->address();
+    Address end = start + array->Size();
+    visitor->VisitRegion(start, end);
+    return;
+  }
+  Page* page = reinterpret_cast<Page*>(chunk);
+  PagedSpace* owner = reinterpret_cast<PagedSpace*>(page->owner());
+  if (owner == heap_->map_space()) {
+    HeapObjectIterator iterator(page, NULL);
+    for (HeapObject* heap_object = iterator.Next(); heap_object != NULL;
+         heap_object = iterator.Next()) {
+      // We skip free space objects.
+      if (!heap_object->IsFiller()) {
+        DCHECK(heap_object->IsMap());
+        visitor->VisitRegion(
+            heap_object->address() + Map::kPointerFieldsBeginOffset,
+            heap_object->address() + Map::kPointerFieldsEndOffset);
+      }
+    }
+    return;
+  }
+  HeapObjectIterator iterator(page, NULL);
+  for (HeapObject* heap_object = iterator.Next(); heap_object != NULL;
+       heap_object = iterator.Next()) {
+    // We iterate over objects that contain new space pointers only.
+    bool may_contain_raw_values = heap_object->MayContainRawValues();
+    if (!may_contain_raw_values) {
+      Address obj_address = heap_object->address();
+      const int start_offset = HeapObject::kHeaderSize;
+      const int end_offset = heap_object->Size();
 #if V8_DOUBLE_FIELDS_UNBOXING
-                LayoutDescriptorHelper helper(heap_object->map());
-                bool has_only_tagged_fields = helper.all_fields_tagged();
-
-                if (!has_only_tagged_fields) {
-                  for (int offset = start_offset; offset < end_offset;) {
-                    int end_of_region_offset;
-                    if (helper.IsTagged(offset, end_offset,
-                                        &end_of_region_offset)) {
-                      FindPointersToNewSpaceInRegion(
-                          obj_address + offset,
-                          obj_address + end_of_region_offset, slot_callback,
-                          clear_maps);
-                    }
-                    offset = end_of_region_offset;
-                  }
-                } else {
+      LayoutDescriptorHelper helper(heap_object->map());
+      bool has_only_tagged_fields = helper.all_fields_tagged();
+
+      if (!has_only_tagged_fields) {
+        for (int offset = start_offset; offset < end_offset;) {
+          int end_of_region_offset;
+          if (helper.IsTagged(offset, end_offset, &end_of_region_offset)) {
+            visitor->VisitRegion(obj_address + offset,
+                                 obj_address + end_of_region_offset);
+          }
+          offset = end_of_region_offset;
+        }
+      } else {
 #endif
-                  Address start_address = obj_address + start_offset;
-                  Address end_address = obj_address + end_offset;
-                  // Object has only tagged fields.
-                  FindPointersToNewSpaceInRegion(start_address, end_address,
-                                                 slot_callback, clear_maps);
+        Address start_address = obj_address + start_offset;
+        Address end_address = obj_address + end_offset;
+        // Object has only tagged fields.
+        visitor->VisitRegion(start_address, end_address);
 #if V8_DOUBLE_FIELDS_UNBOXING
-                }
+      }
 #endif
-              }
-            }
-          }
-        }
+    }
+  }
+}
+
+
+class StoreBuffer::SlotCallbackVisitor {
+ public:
+  SlotCallbackVisitor(StoreBuffer* store_buffer,
+                      ObjectSlotCallback slot_callback, bool clear_maps)
+      : store_buffer_(store_buffer),
+        slot_callback_(slot_callback),
+        clear_maps_(clear_maps) {}
+
+  void VisitRegion(Address start, Address end) {
+    store_buffer_->FindPointersToNewSpaceInRegion(start, end, slot_callback_,
+                                                  clear_maps_);
+  }
+
+ private:
+  StoreBuffer* store_buffer_;
+  ObjectSlotCallback slot_callback_;
+  bool clear_maps_;
+};
+
+
+class StoreBuffer::SlotCollector {
+ public:
+  SlotCollector(Heap* heap, List<Address>* slots)
+      : heap_(heap), slots_(slots) {}
+
+  void VisitRegion(Address start, Address end) {
+    for (Address slot_address = start; slot_address < end;
+         slot_address += kPointerSize) {
+      Object* object = reinterpret_cast<Object*>(base::NoBarrier_Load(
+          reinterpret_cast<base::AtomicWord*>(slot_address)));
+      if (heap_->InNewSpace(object)) slots_->Add(slot_address);
+    }
+  }
+
+ private:
+  Heap* heap_;
+  List<Address>* slots_;
+};
+
+
+// Collects the slots of each scan-on-scavenge page into the list of the
+// page.
+class StoreBuffer::PointerScanJob : public ParallelPageJob {
+ public:
+  PointerScanJob(StoreBuffer* store_buffer, List<MemoryChunk*>* chunks)
+      : ParallelPageJob(chunks->length()),
+        store_buffer_(store_buffer),
+        chunks_(chunks),
+        slots_(new List<Address>[chunks->length()]) {}
+
+  ~PointerScanJob() { delete[] slots_; }
+
+  List<Address>* slots(int i) { return &slots_[i]; }
+
+ protected:
+  void ProcessPage(int index) OVERRIDE {
+    SlotCollector collector(store_buffer_->heap_, &slots_[index]);
+    store_buffer_->VisitPointerRegions(chunks_->at(index), &collector);
+  }
+
+ private:
+  StoreBuffer* store_buffer_;
+  // Owned by the main thread, which does not change it while the pages
+  // are scanned.
+  List<MemoryChunk*>* chunks_;
+  List<Address>* slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(PointerScanJob);
+};
+
+
+// Upper bound on the worker tasks of a parallel page scan.
+static const int kMaxPointerScanTasks = 7;
+
+
+void StoreBuffer::IteratePointersOnScanOnScavengePages(
+    ObjectSlotCallback slot_callback, bool clear_maps) {
+  if (FLAG_parallel_store_buffer_scan) {
+    List<MemoryChunk*> chunks;
+    PointerChunkIterator it(heap_);
+    MemoryChunk* chunk;
+    while ((chunk = it.next()) != NULL) {
+      if (chunk->scan_on_scavenge()) {
+        EnsureChunkIsSwept(chunk);
+        chunks.Add(chunk);
       }
     }
+    if (chunks.length() > 1) {
+      IteratePointersInParallel(&chunks, slot_callback, clear_maps);
+      return;
+    }
+  }
+
+  if (callback_ != NULL) {
+    (*callback_)(heap_, NULL, kStoreBufferStartScanningPagesEvent);
+  }
+  SlotCallbackVisitor visitor(this, slot_callback, clear_maps);
+  PointerChunkIterator it(heap_);
+  MemoryChunk* chunk;
+  while ((chunk = it.next()) != NULL) {
+    if (chunk->scan_on_scavenge()) {
+      chunk->set_scan_on_scavenge(false);
+      if (callback_ != NULL) {
+        (*callback_)(heap_, chunk, kStoreBufferScanningPageEvent);
+      }
+      EnsureChunkIsSwept(chunk);
+      VisitPointerRegions(chunk, &visitor);
+    }
+  }
+  if (callback_ != NULL) {
+    (*callback_)(heap_, NULL, kStoreBufferScanningPageEvent);
+  }
+}
+
+
+// The slots are collected before any of them is visited, so the visits,
+// which promote objects into the old space pages, do not disturb the
+// scanning. The objects, promoted into the scanned pages, are not found by
+// the scan, like in the sequential case they are processed through the
+// promotion queue.
+void StoreBuffer::IteratePointersInParallel(List<MemoryChunk*>* chunks,
+                                            ObjectSlotCallback slot_callback,
+                                            bool clear_maps) {
+  PointerScanJob* job = new PointerScanJob(this, chunks);
+  job->Run(kMaxPointerScanTasks);
+
+  if (callback_ != NULL) {
+    (*callback_)(heap_, NULL, kStoreBufferStartScanningPagesEvent);
+  }
+  for (int i = 0; i < chunks->length(); ++i) {
+    MemoryChunk* chunk = chunks->at(i);
+    chunk->set_scan_on_scavenge(false);
     if (callback_ != NULL) {
-      (*callback_)(heap_, NULL, kStoreBufferScanningPageEvent);
+      (*callback_)(heap_, chunk, kStoreBufferScanningPageEvent);
     }
+    List<Address>* slots = job->slots(i);
+    for (int j = 0; j < slots->length(); ++j) {
+      VisitSlotToNewSpace(slots->at(j), slot_callback, clear_maps);
+    }
+  }
+  if (callback_ != NULL) {
+    (*callback_)(heap_, NULL, kStoreBufferScanningPageEvent);
   }
+  job->Release();
 }
 
 
@@ -13,6 +13,7 @@
 namespace v8 {
 namespace internal {
 
+class MemoryChunk;
 class Page;
 class PagedSpace;
 class StoreBuffer;
@@ -166,6 +167,31 @@ class StoreBuffer {
   void IteratePointersInStoreBuffer(ObjectSlotCallback slot_callback,
                                     bool clear_maps);
 
+  // Scans the scan-on-scavenge pages. With --parallel-store-buffer-scan, the
+  // slots, which point to new space, are first collected on the worker
+  // threads and then visited on the main thread, in the page order.
+  void IteratePointersOnScanOnScavengePages(ObjectSlotCallback slot_callback,
+                                            bool clear_maps);
+  void IteratePointersInParallel(List<MemoryChunk*>* chunks,
+                                 ObjectSlotCallback slot_callback,
+                                 bool clear_maps);
+
+  // Sweeps the page, if it has not been swept yet.
+  void EnsureChunkIsSwept(MemoryChunk* chunk);
+
+  // Calls |visitor->VisitRegion(start, end)| for the regions of the objects
+  // on |chunk|, which may contain pointers to new space. Does not modify
+  // the heap itself.
+  template <class RegionVisitor>
+  void VisitPointerRegions(MemoryChunk* chunk, RegionVisitor* visitor);
+
+  void VisitSlotToNewSpace(Address slot_address,
+                           ObjectSlotCallback slot_callback, bool clear_maps);
+
+  class SlotCallbackVisitor;
+  class SlotCollector;
+  class PointerScanJob;
+
 #ifdef VERIFY_HEAP
   void VerifyPointers(LargeObjectSpace* space);
 #endif
@@ -10,6 +10,7 @@
 
 #include "src/allocation-site-scopes.h"
 #include "src/ast-numbering.h"
+#include "src/event-racer-log.h"
 #include "src/full-codegen.h"
 #include "src/hydrogen-bce.h"
 #include "src/hydrogen-bch.h"
@@ -12818,6 +12819,61 @@ void HOptimizedGraphBuilder::GenerateGetPrototype(CallRuntime* call) {
 }
 
 
+
+void HOptimizedGraphBuilder::BuildEventRacerLogCall(CallRuntime* call,
+                                                    Runtime::FunctionId id,
+                                                    int result_index) {
+  ZoneList<Expression*>* arguments = call->arguments();
+  int argument_count = arguments->length();
+  DCHECK(result_index < argument_count);
+  CHECK_ALIVE(VisitExpressions(arguments));
+  HValue** values = zone()->NewArray<HValue*>(argument_count);
+  for (int i = argument_count - 1; i >= 0; --i) values[i] = Pop();
+  HValue* result = result_index < 0 ? graph()->GetConstantUndefined()
+                                    : values[result_index];
+
+  // Recording an event needs the object identity hash and the interned
+  // name, so it is left to the runtime. The common case of a disabled log
+  // costs just a load and a branch.
+  HValue* enable_count = Add<HLoadNamedField>(
+      Add<HConstant>(
+          ExternalReference::event_racer_log_enable_count_address(isolate())),
+      nullptr, HObjectAccess::ForCounter());
+  IfBuilder if_enabled(this);
+  if_enabled.If<HCompareNumericAndBranch>(enable_count,
+                                          graph()->GetConstant0(), Token::NE);
+  if_enabled.Then();
+  {
+    HPushArguments* push_args = New<HPushArguments>();
+    for (int i = 0; i < argument_count; ++i) push_args->AddInput(values[i]);
+    AddInstruction(push_args);
+    Add<HCallRuntime>(call->name(), Runtime::FunctionForId(id),
+                      argument_count);
+    // A lazy deoptimization in the call resumes after it, rather than
+    // logging the event again. Full code has the value of the call on the
+    // stack there, unless it is in an effect context.
+    if (ast_context()->IsEffect()) {
+      Add<HSimulate>(call->id(), REMOVABLE_SIMULATE);
+    } else {
+      Push(result);
+      Add<HSimulate>(call->id(), REMOVABLE_SIMULATE);
+      Drop(1);
+    }
+  }
+  if_enabled.End();
+
+  return ast_context()->ReturnValue(result);
+}
+
+
+
+#define GENERATE_EVENT_RACER_INTRINSIC(Name, result_index)         \
+  void HOptimizedGraphBuilder::Generate##Name(CallRuntime* call) { \
+    BuildEventRacerLogCall(call, Runtime::k##Name, result_index);  \
+  }
+EVENT_RACER_INTRINSIC_LIST(GENERATE_EVENT_RACER_INTRINSIC)
+#undef GENERATE_EVENT_RACER_INTRINSIC
+
 #undef CHECK_BAILOUT
 #undef CHECK_ALIVE
 
@@ -2195,6 +2195,13 @@ class HOptimizedGraphBuilder : public HGraphBuilder, public AstVisitor {
   INLINE_OPTIMIZED_FUNCTION_LIST(INLINE_FUNCTION_GENERATOR_DECLARATION)
 #undef INLINE_FUNCTION_GENERATOR_DECLARATION
 
+  // Emits a call to an ER event recording runtime function, guarded by a
+  // test of the event log enable counter. The call evaluates to its
+  // argument at |result_index|, or to undefined if |result_index| is
+  // negative, the same as the runtime function.
+  void BuildEventRacerLogCall(CallRuntime* call, Runtime::FunctionId id,
+                              int result_index);
+
   void VisitDelete(UnaryOperation* expr);
   void VisitVoid(UnaryOperation* expr);
   void VisitTypeof(UnaryOperation* expr);
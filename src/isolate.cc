@@ -21,6 +21,7 @@
 #include "src/cpu-profiler.h"
 #include "src/debug.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/heap/spaces.h"
 #include "src/heap-profiler.h"
 #include "src/hydrogen.h"
@@ -1662,11 +1663,13 @@ Isolate::Isolate(bool enable_serializer)
       initialized_from_snapshot_(false),
       cpu_profiler_(NULL),
       heap_profiler_(NULL),
+      event_racer_log_(NULL),
       function_entry_hook_(NULL),
       deferred_handles_head_(NULL),
       optimizing_compiler_thread_(NULL),
       stress_deopt_count_(0),
       next_optimization_id_(0),
+      next_function_id_(0),
 #if TRACE_MAPS
       next_unique_sfi_id_(0),
 #endif
@@ -1795,6 +1798,8 @@ void Isolate::Deinit() {
   heap_profiler_ = NULL;
   delete cpu_profiler_;
   cpu_profiler_ = NULL;
+  delete event_racer_log_;
+  event_racer_log_ = NULL;
 }
 
 
@@ -2019,6 +2024,7 @@ bool Isolate::Init(Deserializer* des) {
       new CallInterfaceDescriptorData[CallDescriptors::NUMBER_OF_DESCRIPTORS];
   cpu_profiler_ = new CpuProfiler(this);
   heap_profiler_ = new HeapProfiler(heap());
+  event_racer_log_ = new EventRacerLog(this);
 
   // Enable logging before setting up the heap
   logger_->SetUp(this);
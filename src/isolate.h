@@ -49,6 +49,7 @@ class CpuProfiler;
 class DeoptimizerData;
 class Deserializer;
 class EmptyStatement;
+class EventRacerLog;
 class ExternalCallbackScope;
 class ExternalReferenceTable;
 class Factory;
@@ -392,7 +393,6 @@ typedef List<HeapObject*> DebugObjectCache;
   V(int, max_available_threads, 0)                                             \
   V(uint32_t, per_isolate_assert_data, 0xFFFFFFFFu)                            \
   V(PromiseRejectCallback, promise_reject_callback, NULL)                      \
-  V(int, function_id, 1)                                                       \
   ISOLATE_INIT_SIMULATOR_LIST(V)
 
 #define THREAD_LOCAL_TOP_ACCESSOR(type, name)                        \
@@ -978,6 +978,7 @@ class Isolate {
 
   CpuProfiler* cpu_profiler() const { return cpu_profiler_; }
   HeapProfiler* heap_profiler() const { return heap_profiler_; }
+  EventRacerLog* event_racer_log() const { return event_racer_log_; }
 
 #ifdef DEBUG
   HistogramInfo* heap_histograms() { return heap_histograms_; }
@@ -1091,6 +1092,12 @@ class Isolate {
     return id;
   }
 
+  // Returns the next function id for the ER instrumentation. The ids start
+  // at one. Safe to call from the background parsing threads.
+  int NextFunctionId() {
+    return base::NoBarrier_AtomicIncrement(&next_function_id_, 1);
+  }
+
   // Get (and lazily initialize) the registry for per-isolate symbols.
   Handle<JSObject> GetSymbolRegistry();
 
@@ -1293,6 +1300,7 @@ class Isolate {
   Debug* debug_;
   CpuProfiler* cpu_profiler_;
   HeapProfiler* heap_profiler_;
+  EventRacerLog* event_racer_log_;
   FunctionEntryHook function_entry_hook_;
 
   typedef std::pair<InterruptCallback, void*> InterruptEntry;
@@ -1327,6 +1335,8 @@ class Isolate {
 
   int next_optimization_id_;
 
+  base::Atomic32 next_function_id_;
+
 #if TRACE_MAPS
   int next_unique_sfi_id_;
 #endif
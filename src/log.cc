@@ -1788,8 +1788,8 @@ static void AddIsolateIdIfNeeded(std::ostream& os,  // NOLINT
 }
 
 
-static void PrepareLogFileName(std::ostream& os,  // NOLINT
-                               Isolate* isolate, const char* file_name) {
+void Logger::PrepareLogFileName(std::ostream& os,  // NOLINT
+                                Isolate* isolate, const char* file_name) {
   AddIsolateIdIfNeeded(os, isolate);
   for (const char* p = file_name; *p; p++) {
     if (*p == '%') {
@@ -174,6 +174,12 @@ class Logger {
   // leaving the file open.
   FILE* TearDown();
 
+  // Writes |file_name| to |os|, expanding %p to the process id and %t to
+  // the current time, and prefixing it with the isolate address when
+  // --logfile-per-isolate is on.
+  static void PrepareLogFileName(std::ostream& os,  // NOLINT
+                                 Isolate* isolate, const char* file_name);
+
   // Emits an event with a string value -> (name, value).
   void StringEvent(const char* name, const char* value);
 
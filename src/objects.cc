@@ -13952,11 +13952,13 @@ class StringSharedKey : public HashTableKey {
   StringSharedKey(Handle<String> source,
                   Handle<SharedFunctionInfo> shared,
                   StrictMode strict_mode,
-                  int scope_position)
+                  int scope_position,
+                  bool instrumented)
       : source_(source),
         shared_(shared),
         strict_mode_(strict_mode),
-        scope_position_(scope_position) { }
+        scope_position_(scope_position),
+        instrumented_(instrumented) { }
 
   bool IsMatch(Object* other) OVERRIDE {
     DisallowHeapAllocation no_allocation;
@@ -13974,6 +13976,8 @@ class StringSharedKey : public HashTableKey {
     if (strict_mode != strict_mode_) return false;
     int scope_position = Smi::cast(other_array->get(3))->value();
     if (scope_position != scope_position_) return false;
+    bool instrumented = Smi::cast(other_array->get(4))->value() != 0;
+    if (instrumented != instrumented_) return false;
     String* source = String::cast(other_array->get(1));
     return source->Equals(*source_);
   }
@@ -13981,8 +13985,10 @@ class StringSharedKey : public HashTableKey {
   static uint32_t StringSharedHashHelper(String* source,
                                          SharedFunctionInfo* shared,
                                          StrictMode strict_mode,
-                                         int scope_position) {
+                                         int scope_position,
+                                         bool instrumented) {
     uint32_t hash = source->Hash();
+    if (instrumented) hash ^= 0x4000;
     if (shared->HasSourceCode()) {
       // Instead of using the SharedFunctionInfo pointer in the hash
       // code computation, we use a combination of the hash of the
@@ -13999,7 +14005,7 @@ class StringSharedKey : public HashTableKey {
 
   uint32_t Hash() OVERRIDE {
     return StringSharedHashHelper(*source_, *shared_, strict_mode_,
-                                  scope_position_);
+                                  scope_position_, instrumented_);
   }
 
   uint32_t HashForObject(Object* obj) OVERRIDE {
@@ -14014,17 +14020,19 @@ class StringSharedKey : public HashTableKey {
     DCHECK(strict_unchecked == SLOPPY || strict_unchecked == STRICT);
     StrictMode strict_mode = static_cast<StrictMode>(strict_unchecked);
     int scope_position = Smi::cast(other_array->get(3))->value();
+    bool instrumented = Smi::cast(other_array->get(4))->value() != 0;
     return StringSharedHashHelper(
-        source, shared, strict_mode, scope_position);
+        source, shared, strict_mode, scope_position, instrumented);
   }
 
 
   Handle<Object> AsHandle(Isolate* isolate) OVERRIDE {
-    Handle<FixedArray> array = isolate->factory()->NewFixedArray(4);
+    Handle<FixedArray> array = isolate->factory()->NewFixedArray(5);
     array->set(0, *shared_);
     array->set(1, *source_);
     array->set(2, Smi::FromInt(strict_mode_));
     array->set(3, Smi::FromInt(scope_position_));
+    array->set(4, Smi::FromInt(instrumented_ ? 1 : 0));
     return array;
   }
 
@@ -14033,6 +14041,7 @@ class StringSharedKey : public HashTableKey {
   Handle<SharedFunctionInfo> shared_;
   StrictMode strict_mode_;
   int scope_position_;
+  bool instrumented_;
 };
 
 
@@ -15175,11 +15184,12 @@ Handle<String> StringTable::LookupKey(Isolate* isolate, HashTableKey* key) {
 
 
 Handle<Object> CompilationCacheTable::Lookup(Handle<String> src,
-                                             Handle<Context> context) {
+                                             Handle<Context> context,
+                                             bool instrumented) {
   Isolate* isolate = GetIsolate();
   Handle<SharedFunctionInfo> shared(context->closure()->shared());
   StringSharedKey key(src, shared, FLAG_use_strict ? STRICT : SLOPPY,
-                      RelocInfo::kNoPosition);
+                      RelocInfo::kNoPosition, instrumented);
   int entry = FindEntry(&key);
   if (entry == kNotFound) return isolate->factory()->undefined_value();
   int index = EntryToIndex(entry);
@@ -15190,11 +15200,12 @@ Handle<Object> CompilationCacheTable::Lookup(Handle<String> src,
 
 Handle<Object> CompilationCacheTable::LookupEval(
     Handle<String> src, Handle<SharedFunctionInfo> outer_info,
-    StrictMode strict_mode, int scope_position) {
+    StrictMode strict_mode, int scope_position, bool instrumented) {
   Isolate* isolate = GetIsolate();
   // Cache key is the tuple (source, outer shared function info, scope position)
   // to unambiguously identify the context chain the cached eval code assumes.
-  StringSharedKey key(src, outer_info, strict_mode, scope_position);
+  StringSharedKey key(src, outer_info, strict_mode, scope_position,
+                      instrumented);
   int entry = FindEntry(&key);
   if (entry == kNotFound) return isolate->factory()->undefined_value();
   int index = EntryToIndex(entry);
@@ -15216,11 +15227,11 @@ Handle<Object> CompilationCacheTable::LookupRegExp(Handle<String> src,
 
 Handle<CompilationCacheTable> CompilationCacheTable::Put(
     Handle<CompilationCacheTable> cache, Handle<String> src,
-    Handle<Context> context, Handle<Object> value) {
+    Handle<Context> context, Handle<Object> value, bool instrumented) {
   Isolate* isolate = cache->GetIsolate();
   Handle<SharedFunctionInfo> shared(context->closure()->shared());
   StringSharedKey key(src, shared, FLAG_use_strict ? STRICT : SLOPPY,
-                      RelocInfo::kNoPosition);
+                      RelocInfo::kNoPosition, instrumented);
   {
     Handle<Object> k = key.AsHandle(isolate);
     DisallowHeapAllocation no_allocation_scope;
@@ -15246,9 +15257,10 @@ Handle<CompilationCacheTable> CompilationCacheTable::Put(
 Handle<CompilationCacheTable> CompilationCacheTable::PutEval(
     Handle<CompilationCacheTable> cache, Handle<String> src,
     Handle<SharedFunctionInfo> outer_info, Handle<SharedFunctionInfo> value,
-    int scope_position) {
+    int scope_position, bool instrumented) {
   Isolate* isolate = cache->GetIsolate();
-  StringSharedKey key(src, outer_info, value->strict_mode(), scope_position);
+  StringSharedKey key(src, outer_info, value->strict_mode(), scope_position,
+                      instrumented);
   {
     Handle<Object> k = key.AsHandle(isolate);
     DisallowHeapAllocation no_allocation_scope;
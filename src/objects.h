@@ -5177,6 +5177,11 @@ class Code: public HeapObject {
   inline bool has_reloc_info_for_serialization();
   inline void set_has_reloc_info_for_serialization(bool value);
 
+  // [is_instrumented]: For FUNCTION kind, tells if it has been compiled
+  // with the ER instrumentation.
+  inline bool is_instrumented();
+  inline void set_is_instrumented(bool value);
+
   // [allow_osr_at_loop_nesting_level]: For FUNCTION kind, tells for
   // how long the function has been marked for OSR and therefore which
   // level of loop nesting we are willing to do on-stack replacement
@@ -5461,6 +5466,7 @@ class Code: public HeapObject {
   class FullCodeFlagsIsCompiledOptimizable: public BitField<bool, 2, 1> {};
   class FullCodeFlagsHasRelocInfoForSerialization
       : public BitField<bool, 3, 1> {};
+  class FullCodeFlagsIsInstrumented : public BitField<bool, 4, 1> {};
 
   static const int kProfilerTicksOffset = kFullCodeFlags + 1;
 
@@ -8059,19 +8065,23 @@ class CompilationCacheTable: public HashTable<CompilationCacheTable,
                                               CompilationCacheShape,
                                               HashTableKey*> {
  public:
-  // Find cached value for a string key, otherwise return null.
-  Handle<Object> Lookup(Handle<String> src, Handle<Context> context);
+  // Find cached value for a string key, otherwise return null. Code
+  // compiled with and without the ER instrumentation is cached under
+  // different keys.
+  Handle<Object> Lookup(Handle<String> src, Handle<Context> context,
+                        bool instrumented);
   Handle<Object> LookupEval(Handle<String> src,
                             Handle<SharedFunctionInfo> shared,
-                            StrictMode strict_mode, int scope_position);
+                            StrictMode strict_mode, int scope_position,
+                            bool instrumented);
   Handle<Object> LookupRegExp(Handle<String> source, JSRegExp::Flags flags);
   static Handle<CompilationCacheTable> Put(
       Handle<CompilationCacheTable> cache, Handle<String> src,
-      Handle<Context> context, Handle<Object> value);
+      Handle<Context> context, Handle<Object> value, bool instrumented);
   static Handle<CompilationCacheTable> PutEval(
       Handle<CompilationCacheTable> cache, Handle<String> src,
       Handle<SharedFunctionInfo> context, Handle<SharedFunctionInfo> value,
-      int scope_position);
+      int scope_position, bool instrumented);
   static Handle<CompilationCacheTable> PutRegExp(
       Handle<CompilationCacheTable> cache, Handle<String> src,
       JSRegExp::Flags flags, Handle<FixedArray> value);
@@ -5179,6 +5179,17 @@ void Parser::ParseOnBackground() {
 }
 
 
+void Parser::AnalyzeOnBackground(bool instrument) {
+  if (info()->function() == NULL) return;
+  // Only the stack checks fail the analysis, which runs on the parser's
+  // stack limit.
+  if (!Compiler::AnalyzeOnBackground(info(), instrument, stack_limit_)) {
+    info()->SetFunction(NULL);
+    set_stack_overflow();
+  }
+}
+
+
 ParserTraits::TemplateLiteralState Parser::OpenTemplateLiteral(int pos) {
   return new (zone()) ParserTraits::TemplateLiteral(zone(), pos);
 }
@@ -678,6 +678,9 @@ class Parser : public ParserBase<ParserTraits> {
   }
   bool Parse();
   void ParseOnBackground();
+  // Runs Compiler::AnalyzeOnBackground after ParseOnBackground. A failure
+  // is reported by Internalize, as a stack overflow.
+  void AnalyzeOnBackground(bool instrument);
 
   // Handle errors detected during parsing, move statistics to Isolate,
   // internalize strings (move them to the heap).
@@ -15,13 +15,14 @@ namespace internal {
 
 class Processor: public AstVisitor {
  public:
-  Processor(Variable* result, AstValueFactory* ast_value_factory)
+  Processor(Variable* result, AstValueFactory* ast_value_factory,
+            uintptr_t stack_limit)
       : result_(result),
         result_assigned_(false),
         is_set_(false),
         in_try_(false),
         factory_(ast_value_factory) {
-    InitializeAstVisitor(ast_value_factory->zone());
+    InitializeAstVisitor(ast_value_factory->zone(), stack_limit);
   }
 
   virtual ~Processor() { }
@@ -222,7 +223,7 @@ EXPRESSION_NODE_LIST(DEF_VISIT)
 
 // Assumes code has been parsed.  Mutates the AST, so the AST should not
 // continue to be used in the case of failure.
-bool Rewriter::Rewrite(CompilationInfo* info) {
+bool Rewriter::Rewrite(CompilationInfo* info, uintptr_t stack_limit) {
   FunctionLiteral* function = info->function();
   DCHECK(function != NULL);
   Scope* scope = function->scope();
@@ -233,9 +234,11 @@ bool Rewriter::Rewrite(CompilationInfo* info) {
   if (!body->is_empty()) {
     Variable* result =
         scope->NewTemporary(info->ast_value_factory()->dot_result_string());
-    // The name string must be internalized at this point.
-    DCHECK(!result->name().is_null());
-    Processor processor(result, info->ast_value_factory());
+    // The name string must be internalized at this point, unless running
+    // off the main thread.
+    DCHECK(!info->ast_value_factory()->IsInternalized() ||
+           !result->name().is_null());
+    Processor processor(result, info->ast_value_factory(), stack_limit);
     processor.Process(body);
     if (processor.HasStackOverflow()) return false;
 
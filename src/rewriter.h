@@ -18,7 +18,9 @@ class Rewriter {
   //
   // Assumes code has been parsed and scopes have been analyzed.  Mutates the
   // AST, so the AST should not continue to be used in the case of failure.
-  static bool Rewrite(CompilationInfo* info);
+  // A non-zero |stack_limit| is checked instead of the isolate's one, when
+  // running off the main thread.
+  static bool Rewrite(CompilationInfo* info, uintptr_t stack_limit = 0);
 };
 
 
@@ -0,0 +1,317 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/v8.h"
+
+#include "src/arguments.h"
+#include "src/event-racer-log.h"
+#include "src/runtime/runtime-utils.h"
+
+
+namespace v8 {
+namespace internal {
+
+// The functions below are called directly by the ER instrumentation. They
+// return the accessed value, so the instrumented expression evaluates to
+// the same value as the original one.
+
+RUNTIME_FUNCTION(Runtime_EventRacerEnable) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  bool was_enabled = log->enabled();
+  log->Enable();
+  if (!was_enabled) log->FlushMismatchedCode();
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerDisable) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  bool was_enabled = log->enabled();
+  int count = log->Disable();
+  if (was_enabled && !log->enabled()) log->FlushMismatchedCode();
+  return Smi::FromInt(count);
+}
+
+
+static Handle<JSArray> NewSmiArray(Isolate* isolate,
+                                   Handle<FixedArray> elements) {
+  return isolate->factory()->NewJSArrayWithElements(elements, FAST_SMI_ELEMENTS,
+                                                    elements->length());
+}
+
+
+// Returns the recorded events as an object with the parallel arrays |seq|,
+// |op|, |obj|, |name|, |funcId|, |stride|, |scriptId|, |startLine| and
+// |endLine|, each containing one element per event, and the count of the
+// events, dropped due to buffer overflow. The |name| of a range access is
+// its first index. The |seq| numbers order the events of all the isolates.
+RUNTIME_FUNCTION(Runtime_EventRacerGetLog) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 0);
+  Factory* factory = isolate->factory();
+  EventRacerLog* log = isolate->event_racer_log();
+
+  // Materialize each interned name once.
+  const int name_count = log->name_count();
+  Handle<FixedArray> names = factory->NewFixedArray(name_count);
+  for (int i = 0; i < name_count; ++i) {
+    Handle<String> name = factory->InternalizeUtf8String(log->name(i));
+    names->set(i, *name);
+  }
+
+  const int n = log->length();
+  Handle<FixedArray> seq = factory->NewFixedArray(n);
+  Handle<FixedArray> op = factory->NewFixedArray(n);
+  Handle<FixedArray> obj = factory->NewFixedArray(n);
+  Handle<FixedArray> name = factory->NewFixedArray(n);
+  Handle<FixedArray> fn = factory->NewFixedArray(n);
+  Handle<FixedArray> stride = factory->NewFixedArray(n);
+  Handle<FixedArray> script = factory->NewFixedArray(n);
+  Handle<FixedArray> start = factory->NewFixedArray(n);
+  Handle<FixedArray> end = factory->NewFixedArray(n);
+  for (int i = 0; i < n; ++i) {
+    const EventRacerLog::Event& e = log->at(i);
+    Handle<Object> number = factory->NewNumber(static_cast<double>(e.seq));
+    seq->set(i, *number);
+    op->set(i, Smi::FromInt(e.op));
+    obj->set(i, Smi::FromInt(e.obj));
+    if (e.stride != 0) {
+      name->set(i, Smi::FromInt(e.name));
+    } else {
+      name->set(i, names->get(e.name));
+    }
+    fn->set(i, Smi::FromInt(e.fn));
+    stride->set(i, Smi::FromInt(e.stride));
+    const EventRacerLog::FunctionInfo* info = NULL;
+    if (e.op == EventRacerLog::kEnterFunc) info = log->function_info(e.fn);
+    script->set(i, Smi::FromInt(info ? info->script_id : -1));
+    start->set(i, Smi::FromInt(info ? info->start_line : -1));
+    end->set(i, Smi::FromInt(info ? info->end_line : -1));
+  }
+
+  Handle<JSObject> result = factory->NewJSObject(
+      handle(isolate->native_context()->object_function()));
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("seq"),
+                        factory->NewJSArrayWithElements(seq), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("op"),
+                        NewSmiArray(isolate, op), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("obj"),
+                        NewSmiArray(isolate, obj), NONE);
+  JSObject::AddProperty(
+      result, factory->InternalizeUtf8String("name"),
+      factory->NewJSArrayWithElements(name, FAST_ELEMENTS, n), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("funcId"),
+                        NewSmiArray(isolate, fn), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("stride"),
+                        NewSmiArray(isolate, stride), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("scriptId"),
+                        NewSmiArray(isolate, script), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("startLine"),
+                        NewSmiArray(isolate, start), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("endLine"),
+                        NewSmiArray(isolate, end), NONE);
+  JSObject::AddProperty(result, factory->InternalizeUtf8String("dropped"),
+                        factory->NewNumber(static_cast<double>(log->dropped())),
+                        NONE);
+  return *result;
+}
+
+
+// The global variable accesses pass the site id, rather than the name, and
+// the property accesses pass it as the last argument, see
+// EventRacerLog::RegisterSite.
+RUNTIME_FUNCTION(Runtime_EventRacerRead) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 2);
+  CONVERT_SMI_ARG_CHECKED(site, 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogReadSite(site);
+  return args[1];
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerReadProp) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 4);
+  CONVERT_SMI_ARG_CHECKED(site, 3);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled())
+    log->LogReadProp(args.at<Object>(0), args.at<Object>(1), site);
+  return args[2];
+}
+
+
+// Logs a read of a property and returns the object, rather than the
+// property value, so the instrumented code can perform the load itself.
+RUNTIME_FUNCTION(Runtime_EventRacerReadPropObject) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 3);
+  CONVERT_SMI_ARG_CHECKED(site, 2);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled())
+    log->LogReadProp(args.at<Object>(0), args.at<Object>(1), site);
+  return args[0];
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerReadArray) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogReadArray(args.at<Object>(0));
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerWrite) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 2);
+  CONVERT_SMI_ARG_CHECKED(site, 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogWriteSite(site);
+  return args[1];
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerWriteProp) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 4);
+  CONVERT_SMI_ARG_CHECKED(site, 3);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled())
+    log->LogWriteProp(args.at<Object>(0), args.at<Object>(1), site);
+  return args[2];
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerWriteFunc) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 3);
+  CONVERT_SMI_ARG_CHECKED(site, 0);
+  CONVERT_SMI_ARG_CHECKED(fn_id, 2);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogWriteFuncSite(site, fn_id);
+  return args[1];
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerWritePropFunc) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 5);
+  CONVERT_SMI_ARG_CHECKED(fn_id, 3);
+  CONVERT_SMI_ARG_CHECKED(site, 4);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) {
+    log->LogWritePropFunc(args.at<Object>(0), args.at<Object>(1), fn_id,
+                          site);
+  }
+  return args[2];
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerWriteArray) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogWriteArray(args.at<Object>(0));
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerReadRange) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 5);
+  CONVERT_SMI_ARG_CHECKED(stride, 3);
+  CONVERT_BOOLEAN_ARG_CHECKED(inclusive, 4);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) {
+    log->LogReadRange(args.at<Object>(0), args.at<Object>(1),
+                      args.at<Object>(2), stride, inclusive);
+  }
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerWriteRange) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 5);
+  CONVERT_SMI_ARG_CHECKED(stride, 3);
+  CONVERT_BOOLEAN_ARG_CHECKED(inclusive, 4);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) {
+    log->LogWriteRange(args.at<Object>(0), args.at<Object>(1),
+                       args.at<Object>(2), stride, inclusive);
+  }
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerEnterFunction) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  CONVERT_SMI_ARG_CHECKED(fn_id, 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogEnterFunction(fn_id);
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerExitFunction) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogExitFunction();
+  return args[0];
+}
+
+
+// Logs the exits of the functions, unwound by an exception, which is
+// caught by the function |fn_id|. Called on entry to each catch and
+// finally block.
+RUNTIME_FUNCTION(Runtime_EventRacerUnwind) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  CONVERT_SMI_ARG_CHECKED(fn_id, 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogUnwind(fn_id);
+  return isolate->heap()->undefined_value();
+}
+
+
+// Logs an entry into the native function, named |name|. The exit is logged
+// with %_EventRacerExitFunction.
+RUNTIME_FUNCTION(Runtime_EventRacerEnterNative) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogEnterNative(args.at<Object>(0));
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerDelete) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 1);
+  CONVERT_SMI_ARG_CHECKED(site, 0);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled()) log->LogDeleteSite(site);
+  return isolate->heap()->undefined_value();
+}
+
+
+RUNTIME_FUNCTION(Runtime_EventRacerDeleteProp) {
+  HandleScope scope(isolate);
+  DCHECK(args.length() == 3);
+  CONVERT_SMI_ARG_CHECKED(site, 2);
+  EventRacerLog* log = isolate->event_racer_log();
+  if (log->enabled())
+    log->LogDeleteProp(args.at<Object>(0), args.at<Object>(1), site);
+  return isolate->heap()->undefined_value();
+}
+}
+}  // namespace v8::internal
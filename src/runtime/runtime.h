@@ -498,6 +498,12 @@ namespace internal {
   F(StoreLookupSlot, 4, 1)                                   \
   F(GetContextN, 1, 1)                                       \
                                                              \
+  /* EventRacer instrumentation */                           \
+  F(EventRacerEnable, 0, 1)                                  \
+  F(EventRacerDisable, 0, 1)                                 \
+  F(EventRacerGetLog, 0, 1)                                  \
+  F(EventRacerEnterNative, 1, 1)                             \
+                                                             \
   /* Declarations and initialization */                      \
   F(DeclareGlobals, 3, 1)                                    \
   F(DeclareModules, 1, 1)                                    \
@@ -731,7 +737,24 @@ namespace internal {
   F(SetInitialize, 1, 1)                  \
   /* Arrays */                            \
   F(HasFastPackedElements, 1, 1)          \
-  F(GetPrototype, 1, 1)
+  F(GetPrototype, 1, 1)                   \
+  /* EventRacer instrumentation */        \
+  F(EventRacerRead, 2, 1)                 \
+  F(EventRacerReadProp, 4, 1)             \
+  F(EventRacerReadPropObject, 3, 1)       \
+  F(EventRacerReadArray, 1, 1)            \
+  F(EventRacerWrite, 2, 1)                \
+  F(EventRacerWriteProp, 4, 1)            \
+  F(EventRacerWriteFunc, 3, 1)            \
+  F(EventRacerWritePropFunc, 5, 1)        \
+  F(EventRacerWriteArray, 1, 1)           \
+  F(EventRacerEnterFunction, 1, 1)        \
+  F(EventRacerExitFunction, 1, 1)         \
+  F(EventRacerUnwind, 1, 1)               \
+  F(EventRacerDelete, 1, 1)               \
+  F(EventRacerDeleteProp, 3, 1)           \
+  F(EventRacerReadRange, 5, 1)            \
+  F(EventRacerWriteRange, 5, 1)
 
 
 //---------------------------------------------------------------------------
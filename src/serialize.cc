@@ -10,6 +10,7 @@
 #include "src/bootstrapper.h"
 #include "src/code-stubs.h"
 #include "src/deoptimizer.h"
+#include "src/event-racer-log.h"
 #include "src/execution.h"
 #include "src/global-handles.h"
 #include "src/ic/ic.h"
@@ -202,6 +203,9 @@ void ExternalReferenceTable::PopulateTable(Isolate* isolate) {
       "Code::MarkCodeAsExecuted");
   Add(ExternalReference::is_profiling_address(isolate).address(),
       "CpuProfiler::is_profiling");
+  Add(ExternalReference::event_racer_log_enable_count_address(isolate)
+          .address(),
+      "EventRacerLog::enable_count_address()");
   Add(ExternalReference::scheduled_exception_address(isolate).address(),
       "Isolate::scheduled_exception");
   Add(ExternalReference::invoke_function_callback(isolate).address(),
@@ -2278,7 +2282,9 @@ MaybeHandle<SharedFunctionInfo> CodeSerializer::Deserialize(
     HandleScope scope(isolate);
 
     SmartPointer<SerializedCodeData> scd(
-        SerializedCodeData::FromCachedData(cached_data, *source));
+        SerializedCodeData::FromCachedData(
+            cached_data, *source,
+            isolate->event_racer_log()->InstrumentsNewCode()));
     if (scd.is_empty()) {
       if (FLAG_profile_deserialization) PrintF("[Cached code failed check]\n");
       DCHECK(cached_data->rejected());
@@ -2432,8 +2438,12 @@ SerializedCodeData::SerializedCodeData(const List<byte>& payload,
 }
 
 
-bool SerializedCodeData::IsSane(String* source) {
+// The data holds code without the ER instrumentation, see
+// Compiler::CompileScript, so it is of no use while new code is
+// instrumented.
+bool SerializedCodeData::IsSane(String* source, bool instrumented) {
   return GetHeaderValue(kCheckSumOffset) == CheckSum(source) &&
+         !instrumented &&
          Payload().length() >= SharedFunctionInfo::kSize;
 }
 
@@ -895,10 +895,11 @@ class SerializedCodeData : public SerializedData {
  public:
   // Used when consuming.
   static SerializedCodeData* FromCachedData(ScriptData* cached_data,
-                                            String* source) {
+                                            String* source,
+                                            bool instrumented) {
     DisallowHeapAllocation no_gc;
     SerializedCodeData* scd = new SerializedCodeData(cached_data);
-    if (scd->IsSane(source)) return scd;
+    if (scd->IsSane(source, instrumented)) return scd;
     cached_data->Reject();
     delete scd;
     return NULL;
@@ -920,7 +921,7 @@ class SerializedCodeData : public SerializedData {
   explicit SerializedCodeData(ScriptData* data)
       : SerializedData(const_cast<byte*>(data->data()), data->length()) {}
 
-  bool IsSane(String* source);
+  bool IsSane(String* source, bool instrumented);
 
   int CheckSum(String* source);
 
@@ -119,6 +119,7 @@
         'test-diy-fp.cc',
         'test-double.cc',
         'test-dtoa.cc',
+        'test-event-racer-log.cc',
         'test-fast-dtoa.cc',
         'test-feedback-vector.cc',
         'test-fixed-dtoa.cc',
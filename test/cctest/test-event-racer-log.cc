@@ -0,0 +1,1220 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Tests of the ER event log.
+
+#include "src/v8.h"
+
+#include "src/api.h"
+#include "src/background-parsing-task.h"
+#include "src/compilation-cache.h"
+#include "src/event-racer-analyzer.h"
+#include "src/event-racer-detector.h"
+#include "src/event-racer-log.h"
+#include "src/event-racer-sampler.h"
+#include "src/event-racer-trace.h"
+#include "src/log-utils.h"
+#include "test/cctest/cctest.h"
+
+using namespace v8::internal;
+
+TEST(EventRacerLogDisabledByDefault) {
+  CcTest::InitializeVM();
+  EventRacerLog log(CcTest::i_isolate());
+  CHECK(!log.enabled());
+  CHECK_EQ(0, log.length());
+
+  log.Enable();
+  log.Enable();
+  CHECK(log.enabled());
+  CHECK_EQ(1, log.Disable());
+  CHECK(log.enabled());
+  CHECK_EQ(0, log.Disable());
+  CHECK(!log.enabled());
+}
+
+
+TEST(EventRacerLogInternsNames) {
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Factory* factory = isolate->factory();
+  v8::HandleScope scope(CcTest::isolate());
+
+  EventRacerLog log(isolate);
+  log.Enable();
+  Handle<Object> obj = factory->NewJSObject(isolate->object_function());
+  log.LogReadProp(obj, factory->InternalizeUtf8String("x"));
+  log.LogWriteProp(obj, factory->InternalizeUtf8String("x"));
+  log.LogWriteProp(obj, handle(Smi::FromInt(42), isolate));
+  log.LogRead(factory->InternalizeUtf8String("y"));
+
+  CHECK_EQ(4, log.length());
+  CHECK_EQ(EventRacerLog::kReadProp, log.at(0).op);
+  CHECK_EQ(EventRacerLog::kWriteProp, log.at(1).op);
+  CHECK_EQ(log.at(0).name, log.at(1).name);
+  CHECK_EQ(log.at(0).obj, log.at(1).obj);
+  CHECK_NE(0, log.at(0).obj);
+  CHECK_EQ(0, strcmp("x", log.name(log.at(0).name)));
+  CHECK_EQ(0, strcmp("42", log.name(log.at(2).name)));
+  CHECK_EQ(0, strcmp("y", log.name(log.at(3).name)));
+  CHECK_EQ(0, log.at(3).obj);
+  // The empty name, "x", "42" and "y".
+  CHECK_EQ(4, log.name_count());
+}
+
+
+TEST(EventRacerLogWrapsAround) {
+  FLAG_er_log_size = 4;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  v8::HandleScope scope(CcTest::isolate());
+
+  EventRacerLog log(isolate);
+  log.Enable();
+  Handle<Object> name = isolate->factory()->InternalizeUtf8String("f");
+  for (int i = 1; i <= 6; ++i)
+    log.LogWriteFunc(name, i);
+
+  CHECK_EQ(4, log.length());
+  CHECK_EQ(2, static_cast<int>(log.dropped()));
+  for (int i = 0; i < 4; ++i) {
+    CHECK_EQ(EventRacerLog::kWriteFunc, log.at(i).op);
+    CHECK_EQ(i + 3, log.at(i).fn);
+  }
+
+  // Re-enabling the collection discards the recorded events.
+  log.Disable();
+  log.Enable();
+  CHECK_EQ(0, log.length());
+}
+
+
+static int CountReadProp(EventRacerLog* log, const char* name) {
+  int count = 0;
+  for (int i = 0; i < log->length(); ++i) {
+    const EventRacerLog::Event& e = log->at(i);
+    if (e.op == EventRacerLog::kReadProp &&
+        strcmp(name, log->name(e.name)) == 0)
+      ++count;
+  }
+  return count;
+}
+
+
+static bool HasReadProp(EventRacerLog* log, const char* name) {
+  return CountReadProp(log, name) > 0;
+}
+
+
+static bool HasEvent(EventRacerLog* log, int op, const char* name) {
+  for (int i = 0; i < log->length(); ++i) {
+    const EventRacerLog::Event& e = log->at(i);
+    if (e.op == op && strcmp(name, log->name(e.name)) == 0) return true;
+  }
+  return false;
+}
+
+
+TEST(EventRacerLogOptimizedCode) {
+  FLAG_allow_natives_syntax = true;
+  FLAG_instrument_lazily = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "var o = { x: 1 };"
+      "function f() { return o.x; }"
+      "f(); f(); %OptimizeFunctionOnNextCall(f); f();");
+  CHECK(!log->enabled());
+
+  // The optimized code records events only while the log is enabled.
+  CompileRun("ER_enable(); f();");
+  CHECK(HasReadProp(log, "x"));
+  CompileRun("ER_disable();");
+  int length = log->length();
+  CompileRun("f();");
+  CHECK_EQ(length, log->length());
+}
+
+
+TEST(EventRacerLogLazyInstrumentation) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "var o = { x: 1 };"
+      "function f() { return o.x; }"
+      "f();");
+  Handle<JSFunction> f = v8::Utils::OpenHandle(*v8::Handle<v8::Function>::Cast(
+      CcTest::global()->Get(v8_str("f"))));
+  CHECK(!f->shared()->code()->is_instrumented());
+
+  // Enabling the log recompiles the function with the instrumentation.
+  CompileRun("ER_enable(); f();");
+  CHECK(f->shared()->code()->is_instrumented());
+  CHECK(HasReadProp(log, "x"));
+
+  // Disabling it brings back the uninstrumented code.
+  CompileRun("ER_disable(); f();");
+  CHECK(!f->shared()->code()->is_instrumented());
+}
+
+
+TEST(EventRacerLogSkipsLocalObjects) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  // |p| never escapes |f|, so the accesses to its properties cannot race.
+  CompileRun(
+      "var g = { shared: 1 };"
+      "function f() {"
+      "  var p = { local: 1 };"
+      "  p.local += g.shared;"
+      "  return p.local;"
+      "}"
+      "ER_enable(); f();");
+  CHECK(HasReadProp(log, "shared"));
+  CHECK(!HasReadProp(log, "local"));
+
+  // The object of a method call escapes as the receiver.
+  CompileRun(
+      "var leak;"
+      "function h() {"
+      "  var q = { escaped: 1, m: function() { leak = this; } };"
+      "  q.m();"
+      "  return q.escaped;"
+      "}"
+      "h();");
+  CHECK(HasReadProp(log, "escaped"));
+}
+
+
+static uint32_t ReadVarint(const byte** p) {
+  uint32_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    byte b = *(*p)++;
+    value |= static_cast<uint32_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) return value;
+  }
+}
+
+
+TEST(EventRacerLogWritesTrace) {
+  FLAG_er_trace = Log::kLogToTemporaryFile;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Factory* factory = isolate->factory();
+  v8::HandleScope scope(CcTest::isolate());
+
+  EventRacerLog log(isolate);
+  log.Enable();
+  Handle<Object> obj = factory->NewJSObject(isolate->object_function());
+  Handle<Object> x = factory->InternalizeUtf8String("x");
+  log.LogEnterFunction(7);
+  log.LogWriteProp(obj, x);
+  log.LogReadProp(obj, x);
+  log.LogExitFunction();
+  log.Disable();
+  FILE* f = log.CloseTrace();
+  FLAG_er_trace = NULL;
+  CHECK(f != NULL);
+
+  rewind(f);
+  byte data[256];
+  size_t size = fread(data, 1, sizeof(data), f);
+  fclose(f);
+  CHECK(size > sizeof(EventRacerTrace::kMagic) + 4);
+  CHECK_EQ(0, memcmp(data, EventRacerTrace::kMagic,
+                     sizeof(EventRacerTrace::kMagic)));
+  const byte* p = data + sizeof(EventRacerTrace::kMagic);
+  uint32_t chunk_size = p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+  p += 4;
+  const byte* end = p + chunk_size;
+  CHECK(end == data + size);
+
+  // Replay the trace and compare it with the ring buffer.
+  CHECK_EQ(EventRacerTrace::kReset, *p++);
+  int events = 0, names = 0, functions = 0;
+  uint64_t seq = 0;
+  while (p < end) {
+    byte tag = *p++;
+    if (tag == EventRacerTrace::kSeq) {
+      // Other logs in the process took the skipped sequence numbers.
+      seq += ReadVarint(&p);
+    } else if (tag == EventRacerTrace::kName) {
+      CHECK_EQ(names, static_cast<int>(ReadVarint(&p)));
+      uint32_t len = ReadVarint(&p);
+      CHECK_EQ(0, strncmp(log.name(names), reinterpret_cast<const char*>(p),
+                          len));
+      p += len;
+      ++names;
+    } else if (tag == EventRacerTrace::kFunc) {
+      // No JS frame, so the script and the lines are unknown.
+      CHECK_EQ(7, static_cast<int>(ReadVarint(&p)));
+      CHECK_EQ(1, static_cast<int>(ReadVarint(&p)));  // zig-zag -1
+      CHECK_EQ(1, static_cast<int>(ReadVarint(&p)));
+      CHECK_EQ(1, static_cast<int>(ReadVarint(&p)));
+      ++functions;
+    } else {
+      const EventRacerLog::Event& e = log.at(events++);
+      CHECK(e.seq == ++seq);
+      CHECK_EQ(e.op, tag);
+      CHECK_EQ(e.obj, static_cast<int32_t>(ReadVarint(&p)));
+      CHECK_EQ(e.name, static_cast<int32_t>(ReadVarint(&p)));
+      CHECK_EQ(e.fn, static_cast<int32_t>(ReadVarint(&p)));
+    }
+  }
+  CHECK_EQ(log.length(), events);
+  CHECK_EQ(log.name_count(), names);
+  CHECK_EQ(1, functions);
+}
+
+
+#if V8_OS_LINUX
+TEST(EventRacerLogTraceWriteFailure) {
+  CcTest::InitializeVM();
+
+  // Every write to /dev/full fails with ENOSPC.
+  EventRacerTrace trace;
+  CHECK(trace.Open("/dev/full", 0));
+  trace.WriteReset();
+  for (int i = 1; i <= 10000; ++i)
+    trace.WriteEvent(i, EventRacerLog::kReadProp, 1, 0, 0);
+  trace.Flush();
+  // The records after the failure are dropped.
+  trace.WriteEvent(10001, EventRacerLog::kReadProp, 1, 0, 0);
+  CHECK(trace.Close() == NULL);
+  CHECK(trace.failed());
+}
+#endif  // V8_OS_LINUX
+
+
+TEST(EventRacerLogAnalyzesTrace) {
+  CcTest::InitializeVM();
+  typedef EventRacerLog L;
+
+  // Three segments, split across three chunks:
+  //   #0 enter, #1 write 5.x, #2 write 7[0..2], #3 exit,
+  //   #4 enter, #5 read 5.x, #6 read 7[1], #7 read 6.x, #8 exit,
+  //   #9 enter, #10 write 6.x, #11 write 6.x, #12 exit.
+  EventRacerTrace trace;
+  CHECK(trace.Open(Log::kLogToTemporaryFile, 0));
+  trace.WriteReset();
+  trace.WriteName(1, "x", 1);
+  trace.WriteFunction(1, -1, -1, -1);
+  trace.WriteEvent(1, L::kEnterFunc, 0, 0, 1);
+  trace.WriteEvent(2, L::kWriteProp, 5, 1, 0);
+  trace.Flush();
+  trace.WriteRange(3, L::kWriteRange, 7, 0, 2, 1);
+  trace.WriteEvent(4, L::kExitFunc, 0, 0, 0);
+  trace.WriteEvent(5, L::kEnterFunc, 0, 0, 1);
+  trace.WriteEvent(6, L::kReadProp, 5, 1, 0);
+  trace.WriteName(2, "1", 1);
+  trace.WriteEvent(7, L::kReadProp, 7, 2, 0);
+  trace.WriteEvent(8, L::kReadProp, 6, 1, 0);
+  trace.WriteEvent(9, L::kExitFunc, 0, 0, 0);
+  trace.Flush();
+  trace.WriteEvent(10, L::kEnterFunc, 0, 0, 1);
+  trace.WriteEvent(11, L::kWriteProp, 6, 1, 0);
+  trace.WriteEvent(12, L::kWriteProp, 6, 1, 0);
+  trace.WriteEvent(13, L::kExitFunc, 0, 0, 0);
+  FILE* f = trace.Close();
+  CHECK(f != NULL);
+
+  rewind(f);
+  byte data[256];
+  size_t size = fread(data, 1, sizeof(data), f);
+  fclose(f);
+
+  EventRacerTraceSummary summary;
+  CHECK(AnalyzeEventRacerTrace(V8::GetCurrentPlatform(), 2, 3, 10, data, size,
+                               &summary));
+  CHECK_EQ(3, summary.chunks);
+  CHECK_EQ(0, summary.malformed_chunks);
+  CHECK_EQ(1, summary.resets);
+  CHECK_EQ(13, static_cast<int>(summary.events));
+  CHECK_EQ(3, static_cast<int>(summary.op_counts[L::kEnterFunc]));
+  CHECK_EQ(3, static_cast<int>(summary.op_counts[L::kExitFunc]));
+  CHECK_EQ(3, static_cast<int>(summary.op_counts[L::kReadProp]));
+  CHECK_EQ(3, static_cast<int>(summary.op_counts[L::kWriteProp]));
+  CHECK_EQ(1, static_cast<int>(summary.op_counts[L::kWriteRange]));
+  CHECK_EQ(3, static_cast<int>(summary.segments));
+  // The range record expands to three element writes.
+  CHECK_EQ(9, static_cast<int>(summary.accesses));
+  CHECK_EQ(5, static_cast<int>(summary.locations));
+  CHECK_EQ(3, static_cast<int>(summary.objects));
+  CHECK_EQ(3, static_cast<int>(summary.conflicts));
+  CHECK_EQ(3, static_cast<int>(summary.conflict_locations));
+
+  // One conflict each, so the locations are ordered by object.
+  CHECK_EQ(3, static_cast<int>(summary.top_locations.size()));
+  const EventRacerTraceSummary::Location& a = summary.top_locations[0];
+  CHECK_EQ(5, a.obj);
+  CHECK_EQ(0, strcmp(".x", a.name.c_str()));
+  CHECK(a.first_write && a.first_seq == 1);
+  CHECK(!a.second_write && a.second_seq == 5);
+  const EventRacerTraceSummary::Location& b = summary.top_locations[1];
+  CHECK_EQ(6, b.obj);
+  CHECK_EQ(0, strcmp(".x", b.name.c_str()));
+  CHECK_EQ(1, static_cast<int>(b.reads));
+  CHECK_EQ(2, static_cast<int>(b.writes));
+  CHECK(!b.first_write && b.first_seq == 7);
+  CHECK(b.second_write && b.second_seq == 10);
+  // The element read matches the element of the range write.
+  const EventRacerTraceSummary::Location& c = summary.top_locations[2];
+  CHECK_EQ(7, c.obj);
+  CHECK_EQ(0, strcmp("[1]", c.name.c_str()));
+  CHECK(c.first_write && c.first_seq == 2);
+  CHECK(!c.second_write && c.second_seq == 6);
+  CHECK_EQ(3, static_cast<int>(summary.top_objects.size()));
+
+  // Not a trace.
+  CHECK(!AnalyzeEventRacerTrace(V8::GetCurrentPlatform(), 2, 3, 10, data, 4,
+                                &summary));
+}
+
+
+TEST(EventRacerLogAnalyzesArrayAccesses) {
+  CcTest::InitializeVM();
+  typedef EventRacerLog L;
+
+  // The whole-array accesses touch the length of the array, too:
+  //   #0 enter, #1 read 7, #2 exit,
+  //   #3 enter, #4 write 7.length, #5 exit,
+  //   #6 enter, #7 write 7, #8 exit.
+  EventRacerTrace trace;
+  CHECK(trace.Open(Log::kLogToTemporaryFile, 0));
+  trace.WriteReset();
+  trace.WriteName(1, "length", 6);
+  trace.WriteEvent(1, L::kEnterFunc, 0, 0, 1);
+  trace.WriteEvent(2, L::kReadArray, 7, 0, 0);
+  trace.WriteEvent(3, L::kExitFunc, 0, 0, 0);
+  trace.WriteEvent(4, L::kEnterFunc, 0, 0, 1);
+  trace.WriteEvent(5, L::kWriteProp, 7, 1, 0);
+  trace.WriteEvent(6, L::kExitFunc, 0, 0, 0);
+  trace.WriteEvent(7, L::kEnterFunc, 0, 0, 1);
+  trace.WriteEvent(8, L::kWriteArray, 7, 0, 0);
+  trace.WriteEvent(9, L::kExitFunc, 0, 0, 0);
+  FILE* f = trace.Close();
+  CHECK(f != NULL);
+
+  rewind(f);
+  byte data[256];
+  size_t size = fread(data, 1, sizeof(data), f);
+  fclose(f);
+
+  EventRacerTraceSummary summary;
+  CHECK(AnalyzeEventRacerTrace(V8::GetCurrentPlatform(), 2, 3, 10, data, size,
+                               &summary));
+  CHECK_EQ(3, static_cast<int>(summary.accesses));
+  CHECK_EQ(2, static_cast<int>(summary.locations));
+  CHECK_EQ(1, static_cast<int>(summary.objects));
+  CHECK_EQ(3, static_cast<int>(summary.conflicts));
+  CHECK_EQ(2, static_cast<int>(summary.conflict_locations));
+
+  // The length conflicts with both whole-array accesses.
+  CHECK_EQ(2, static_cast<int>(summary.top_locations.size()));
+  const EventRacerTraceSummary::Location& a = summary.top_locations[0];
+  CHECK_EQ(0, strcmp(".length", a.name.c_str()));
+  CHECK_EQ(2, static_cast<int>(a.conflicts));
+  CHECK_EQ(0, static_cast<int>(a.reads));
+  CHECK_EQ(1, static_cast<int>(a.writes));
+  CHECK(!a.first_write && a.first_seq == 1);
+  CHECK(a.second_write && a.second_seq == 4);
+  const EventRacerTraceSummary::Location& b = summary.top_locations[1];
+  CHECK_EQ(0, strcmp("[*]", b.name.c_str()));
+  CHECK_EQ(1, static_cast<int>(b.conflicts));
+  CHECK(!b.first_write && b.first_seq == 1);
+  CHECK(b.second_write && b.second_seq == 7);
+}
+
+
+TEST(EventRacerLogSequenceIsProcessWide) {
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  v8::HandleScope scope(CcTest::isolate());
+  Handle<Object> x = isolate->factory()->InternalizeUtf8String("x");
+
+  EventRacerLog a(isolate);
+  EventRacerLog b(isolate);
+  a.Enable();
+  b.Enable();
+  a.LogRead(x);
+  b.LogWrite(x);
+  a.LogWrite(x);
+  CHECK(a.at(0).seq < b.at(0).seq);
+  CHECK(b.at(0).seq < a.at(1).seq);
+  CHECK(a.at(1).seq < EventRacerLog::NextSequence());
+}
+
+
+// Runs a script, which records events, in a new isolate, and collects the
+// sequence numbers of the events.
+class SequenceThread : public v8::base::Thread {
+ public:
+  SequenceThread() : Thread(Options("SequenceThread")), count_(0) {}
+
+  void Run() {
+    v8::Isolate* isolate = v8::Isolate::New();
+    {
+      v8::Isolate::Scope isolate_scope(isolate);
+      v8::HandleScope scope(isolate);
+      v8::Local<v8::Context> context = v8::Context::New(isolate);
+      v8::Context::Scope context_scope(context);
+      CompileRun("ER_enable();");
+      CompileRun(
+          "var o = { x: 0 };"
+          "for (var i = 0; i < 100; i++) o.x = o.x + i;");
+      CompileRun("ER_disable();");
+      EventRacerLog* log =
+          reinterpret_cast<Isolate*>(isolate)->event_racer_log();
+      count_ = Min(log->length(), kMaxEvents);
+      for (int i = 0; i < count_; ++i) seq_[i] = log->at(i).seq;
+    }
+    isolate->Dispose();
+  }
+
+  static const int kMaxEvents = 1000;
+  int count_;
+  uint64_t seq_[kMaxEvents];
+};
+
+
+TEST(EventRacerLogSequenceAcrossIsolates) {
+  SequenceThread threads[2];
+  for (int i = 0; i < 2; ++i) threads[i].Start();
+  for (int i = 0; i < 2; ++i) threads[i].Join();
+
+  // The isolates record without a common lock, still, the sequence numbers
+  // are increasing within each isolate and unique across them.
+  HashMap seen(HashMap::PointersMatch);
+  for (int i = 0; i < 2; ++i) {
+    CHECK_LT(0, threads[i].count_);
+    for (int j = 0; j < threads[i].count_; ++j) {
+      uint64_t seq = threads[i].seq_[j];
+      if (j > 0) CHECK(threads[i].seq_[j - 1] < seq);
+      void* key = reinterpret_cast<void*>(static_cast<uintptr_t>(seq));
+      HashMap::Entry* e =
+          seen.Lookup(key, static_cast<uint32_t>(seq), true);
+      CHECK(e->value == NULL);
+      e->value = key;
+    }
+  }
+}
+
+
+TEST(EventRacerLogObjectIdsAreStable) {
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Factory* factory = isolate->factory();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = isolate->event_racer_log();
+
+  log->Enable();
+  Handle<JSObject> a = factory->NewJSObject(isolate->object_function());
+  Handle<JSObject> b = factory->NewJSObject(isolate->object_function());
+  Handle<Object> x = factory->InternalizeUtf8String("x");
+  log->LogReadProp(a, x);
+  log->LogReadProp(b, x);
+  log->LogReadProp(factory->NewNumber(1.5), x);
+  CHECK_NE(0, log->at(0).obj);
+  CHECK_NE(log->at(0).obj, log->at(1).obj);
+  CHECK_EQ(0, log->at(2).obj);
+
+  // The identifiers survive the objects being moved by the GC.
+  Address old_address = a->address();
+  CcTest::heap()->CollectGarbage(NEW_SPACE);
+  CcTest::heap()->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK(old_address != a->address());
+  log->LogWriteProp(a, x);
+  log->LogWriteProp(b, x);
+  CHECK_EQ(log->at(0).obj, log->at(3).obj);
+  CHECK_EQ(log->at(1).obj, log->at(4).obj);
+
+  // The log does not change the objects, nor retain them.
+  CHECK(Handle<JSReceiver>::cast(a)->GetIdentityHash()->IsUndefined());
+  log->Disable();
+}
+
+
+TEST(EventRacerLogIdentifiesActivations) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  // Each call of |make| creates a separate context for |v|.
+  CompileRun(
+      "function make() { var v = 0; return function() { v = 1; }; }"
+      "var f = make(), g = make();"
+      "ER_enable(); f(); g(); f(); ER_disable();");
+  int ids[3];
+  int count = 0;
+  for (int i = 0; i < log->length(); ++i) {
+    const EventRacerLog::Event& e = log->at(i);
+    if (e.op == EventRacerLog::kWriteProp &&
+        strcmp("v", log->name(e.name)) == 0 && count < 3)
+      ids[count++] = e.obj;
+  }
+  CHECK_EQ(3, count);
+  CHECK_NE(0, ids[0]);
+  CHECK_NE(ids[0], ids[1]);
+  CHECK_EQ(ids[0], ids[2]);
+}
+
+
+TEST(EventRacerLogBalancesFunctionExits) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "function thrower() { throw 1; }\n"
+      "function middle() { thrower(); }\n"
+      "function catcher() {\n"
+      "  try { middle(); } catch (e) { return 2; }\n"
+      "}\n"
+      "ER_enable(); catcher(); ER_disable();");
+
+  // Each entry is matched by an exit, including the frames unwound by the
+  // exception, which are exited before the catch block runs.
+  int depth = 0;
+  int entries = 0;
+  for (int i = 0; i < log->length(); ++i) {
+    const EventRacerLog::Event& e = log->at(i);
+    if (e.op == EventRacerLog::kEnterFunc) {
+      ++depth;
+      ++entries;
+    } else if (e.op == EventRacerLog::kExitFunc) {
+      --depth;
+      CHECK(depth >= 0);
+    }
+  }
+  CHECK_EQ(0, depth);
+  CHECK(entries >= 3);
+
+  // The function metadata is looked up at the first entry.
+  for (int i = 0; i < log->length(); ++i) {
+    const EventRacerLog::Event& e = log->at(i);
+    if (e.op != EventRacerLog::kEnterFunc ||
+        strcmp("catcher", log->name(e.name)) != 0)
+      continue;
+    const EventRacerLog::FunctionInfo* info = log->function_info(e.fn);
+    CHECK(info != NULL);
+    CHECK_EQ(2, info->start_line);
+    CHECK_EQ(4, info->end_line);
+  }
+}
+
+
+static Handle<JSFunction> GetFunction(const char* name) {
+  return v8::Utils::OpenHandle(*v8::Handle<v8::Function>::Cast(
+      CcTest::global()->Get(v8_str(name))));
+}
+
+
+TEST(EventRacerLogFilters) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CcTest::isolate()->GetCurrentContext()->SetEventRacerFilter(
+      v8_str("*"), v8_str("traced*,-traced_not"));
+  CompileRun(
+      "var o = { x: 1, y: 2, z: 3 };"
+      "function traced() { return o.x; }"
+      "function traced_not() { return o.y; }"
+      "function other() { return o.z; }"
+      "ER_enable(); traced(); traced_not(); other();");
+  CHECK(GetFunction("traced")->shared()->code()->is_instrumented());
+  CHECK(!GetFunction("traced_not")->shared()->code()->is_instrumented());
+  CHECK(!GetFunction("other")->shared()->code()->is_instrumented());
+  CHECK(HasReadProp(log, "x"));
+  CHECK(!HasReadProp(log, "y"));
+  CHECK(!HasReadProp(log, "z"));
+  CompileRun("ER_disable();");
+}
+
+
+static int race_count = 0;
+static v8::EventRacerRace last_race;
+static char last_race_name[16];
+
+static void RecordRace(v8::Isolate* isolate, const v8::EventRacerRace* race) {
+  ++race_count;
+  last_race = *race;
+  SNPrintF(Vector<char>(last_race_name, arraysize(last_race_name)), "%s",
+           race->name);
+  last_race.name = last_race_name;
+}
+
+
+TEST(EventRacerLogDetectsRaces) {
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Factory* factory = isolate->factory();
+  v8::HandleScope scope(CcTest::isolate());
+
+  EventRacerLog log(isolate);
+  log.SetRaceCallback(RecordRace);
+  EventRacerDetector* detector = log.detector();
+  CHECK(detector != NULL);
+  log.Enable();
+  Handle<Object> obj = factory->NewJSObject(isolate->object_function());
+  Handle<Object> x = factory->InternalizeUtf8String("x");
+
+  // Accesses outside of event actions are not checked, nor are the range
+  // accesses expanded into the names of the elements.
+  log.LogWriteProp(obj, x);
+  int names = log.name_count();
+  log.LogReadRange(obj, handle(Smi::FromInt(0), isolate),
+                   handle(Smi::FromInt(1000), isolate), 1, false);
+  CHECK_EQ(names, log.name_count());
+
+  // Event 1 happens before the event 2, the event 3 is not ordered with
+  // either of them.
+  detector->AddArc(1, 2);
+  detector->BeginEvent(1);
+  log.LogWriteProp(obj, x);
+  detector->EndEvent();
+  detector->BeginEvent(2);
+  log.LogReadProp(obj, x);
+  log.LogWriteProp(obj, x);
+  detector->EndEvent();
+  CHECK_EQ(0, race_count);
+
+  detector->BeginEvent(3);
+  log.LogReadProp(obj, x);
+  // Reported once per location and event action.
+  log.LogWriteProp(obj, x);
+  detector->EndEvent();
+  CHECK_EQ(1, race_count);
+  CHECK_EQ(2, last_race.first_event);
+  CHECK_EQ(v8::EventRacerRace::kWrite, last_race.first_access);
+  CHECK_EQ(3, last_race.second_event);
+  CHECK_EQ(v8::EventRacerRace::kRead, last_race.second_access);
+  CHECK_EQ(log.at(0).obj, last_race.object_id);
+  CHECK_EQ(0, strcmp("x", last_race.name));
+
+  // The event 4 is ordered after both the events 2 and 3.
+  detector->AddArc(2, 4);
+  detector->AddArc(3, 4);
+  detector->BeginEvent(4);
+  log.LogWriteProp(obj, x);
+  detector->EndEvent();
+  CHECK_EQ(1, race_count);
+  CHECK_EQ(1, detector->race_count());
+  // Events 1, 2 and 4 share a chain.
+  CHECK_EQ(2, detector->chain_count());
+
+  // A whole-array access, e.g. |arr.push(x)|, touches the elements and the
+  // length. The event 7 is ordered after the event 6 only.
+  Handle<Object> arr = factory->NewJSObject(isolate->object_function());
+  Handle<Object> index = factory->InternalizeUtf8String("0");
+  Handle<Object> length = factory->InternalizeUtf8String("length");
+  detector->BeginEvent(5);
+  log.LogReadProp(arr, index);
+  detector->EndEvent();
+  detector->BeginEvent(6);
+  log.LogWriteArray(arr);
+  detector->EndEvent();
+  CHECK_EQ(2, race_count);
+  CHECK_EQ(5, last_race.first_event);
+  CHECK_EQ(v8::EventRacerRace::kRead, last_race.first_access);
+  CHECK_EQ(v8::EventRacerRace::kWrite, last_race.second_access);
+  CHECK_EQ(0, strcmp("", last_race.name));
+  detector->AddArc(6, 7);
+  detector->BeginEvent(7);
+  log.LogReadProp(arr, length);
+  detector->EndEvent();
+  CHECK_EQ(2, race_count);
+  detector->BeginEvent(8);
+  log.LogReadProp(arr, length);
+  detector->EndEvent();
+  CHECK_EQ(3, race_count);
+  CHECK_EQ(6, last_race.first_event);
+  CHECK_EQ(v8::EventRacerRace::kWrite, last_race.first_access);
+  CHECK_EQ(v8::EventRacerRace::kRead, last_race.second_access);
+  CHECK_EQ(0, strcmp("length", last_race.name));
+}
+
+
+static int CountRecorded(EventRacerSampler* sampler,
+                         EventRacerSampler::Kind kind, int site, int n) {
+  int count = 0;
+  for (int i = 0; i < n; ++i) {
+    if (sampler->ShouldRecord(kind, site)) ++count;
+  }
+  return count;
+}
+
+
+TEST(EventRacerLogSamples) {
+  EventRacerSampler sampler;
+  CHECK(!sampler.is_active());
+  CHECK_EQ(100, CountRecorded(&sampler, EventRacerSampler::kRead, 0, 100));
+
+  // One in ten reads, all writes.
+  sampler.Configure(10, 1, 1, 0, 0, 0);
+  CHECK(sampler.is_active());
+  CHECK_EQ(10, CountRecorded(&sampler, EventRacerSampler::kRead, 0, 100));
+  CHECK_EQ(100, CountRecorded(&sampler, EventRacerSampler::kWrite, 0, 100));
+
+  // Bursts of 5 in each 20 events, one in ten events outside of them.
+  sampler.Configure(10, 10, 10, 5, 20, 0);
+  CHECK_EQ(13, CountRecorded(&sampler, EventRacerSampler::kRead, 0, 40));
+
+  // The distance between the events of a site doubles up to 8: the 1st,
+  // 3rd, 7th, 15th, 23rd, ... events are recorded.
+  sampler.Configure(1, 1, 1, 0, 0, 8);
+  CHECK_EQ(14, CountRecorded(&sampler, EventRacerSampler::kRead, 1, 100));
+  CHECK_EQ(1, CountRecorded(&sampler, EventRacerSampler::kRead, 2, 1));
+  // The kinds of events of a site are throttled separately.
+  CHECK_EQ(1, CountRecorded(&sampler, EventRacerSampler::kCall, 1, 1));
+  // Events of an unknown site are not throttled.
+  CHECK_EQ(5, CountRecorded(&sampler, EventRacerSampler::kRead, 0, 5));
+
+  sampler.Reset();
+  CHECK_EQ(1, CountRecorded(&sampler, EventRacerSampler::kRead, 1, 2));
+
+  // The table of the sites is bounded, an evicted site starts over: the
+  // 1st and the 3rd of its next events are recorded, rather than the 1st
+  // only.
+  for (int site = 1; site <= 10000; ++site)
+    CHECK_EQ(1, CountRecorded(&sampler, EventRacerSampler::kWrite, site, 1));
+  CHECK_EQ(2, CountRecorded(&sampler, EventRacerSampler::kRead, 1, 3));
+}
+
+
+TEST(EventRacerLogSamplesHelperSitesSeparately) {
+  FLAG_er_sample_backoff_limit = 4;
+  FLAG_er_dedup_reads = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  // Both reads call the same helper, |ER_readPropIdx|, but have their own
+  // sites: the 1st, 3rd and 7th read of each one are recorded.
+  CompileRun(
+      "var o = { x: 1 };"
+      "function g(a, k) { return a[k]; }"
+      "function h(a, k) { return a[k]; }"
+      "ER_enable();"
+      "for (var i = 0; i < 8; ++i) { g(o, 'x'); h(o, 'x'); }"
+      "ER_disable();");
+  CHECK_EQ(6, CountReadProp(log, "x"));
+}
+
+
+TEST(EventRacerLogRecordsPropertyCounts) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun("var o = { x: 1, y: 1 }; ER_enable(); o.x++; ++o['y'];");
+  CHECK(HasEvent(log, EventRacerLog::kWriteProp, "x"));
+  CHECK(HasEvent(log, EventRacerLog::kWriteProp, "y"));
+  CompileRun("ER_disable();");
+}
+
+
+TEST(EventRacerLogSamplesFunctionEntries) {
+  FLAG_er_sample_calls = 2;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "function f() { return 1; }"
+      "ER_enable(); for (var i = 0; i < 10; ++i) f(); ER_disable();");
+  // Every other entry is recorded, along with its exit only.
+  int enters = 0, exits = 0;
+  for (int i = 0; i < log->length(); ++i) {
+    if (log->at(i).op == EventRacerLog::kEnterFunc) ++enters;
+    if (log->at(i).op == EventRacerLog::kExitFunc) ++exits;
+  }
+  CHECK_EQ(5, enters);
+  CHECK_EQ(5, exits);
+}
+
+
+TEST(EventRacerLogDeduplicatesReads) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "var o = { x: 1 };"
+      "var p = { x: 2 };"
+      "function f(a) {"
+      "  var s = 0;"
+      "  for (var i = 0; i < 10; ++i) s += a.x;"
+      "  return s;"
+      "}"
+      "ER_enable(); f(o); f(o); f(p);");
+  // The repeated reads of the same object are recorded once.
+  CHECK_EQ(2, CountReadProp(log, "x"));
+
+  // Each outermost invocation and each event action starts a new epoch.
+  CompileRun("f(o);");
+  CHECK_EQ(3, CountReadProp(log, "x"));
+  CcTest::isolate()->EventRacerBeginEvent(1);
+  CompileRun("f(o);");
+  CcTest::isolate()->EventRacerEndEvent();
+  CHECK_EQ(4, CountReadProp(log, "x"));
+  CompileRun("ER_disable();");
+}
+
+
+TEST(EventRacerLogDeduplicatesReadsBySite) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  // Both reads call the same helper, |ER_readPropIdx|, but have their own
+  // sites, so each one is recorded once, rather than the read of |h| being
+  // dropped as a duplicate of the one of |g|.
+  CompileRun(
+      "var o = { x: 1 };"
+      "function g(a, k) { return a[k]; }"
+      "function h(a, k) { return a[k]; }"
+      "function f() {"
+      "  for (var i = 0; i < 3; ++i) { g(o, 'x'); h(o, 'x'); }"
+      "}"
+      "ER_enable(); f(); ER_disable();");
+  CHECK_EQ(2, CountReadProp(log, "x"));
+}
+
+
+TEST(EventRacerLogSamplesDeduplicatedReads) {
+  FLAG_er_sample_reads = 2;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "var o = { x: 1 };"
+      "var p = { y: 2 };"
+      "function f(a, b) {"
+      "  var s = b.y;"
+      "  for (var i = 0; i < 10; ++i) s += a.x;"
+      "  return s;"
+      "}"
+      "ER_enable(); f(o, p); ER_disable();");
+  // The first read of |x| is dropped by the sampler, which must not
+  // suppress the repeated reads as duplicates.
+  CHECK(HasReadProp(log, "y"));
+  CHECK_EQ(1, CountReadProp(log, "x"));
+}
+
+
+static Handle<SharedFunctionInfo> CompileScript(const char* source) {
+  v8::Local<v8::Script> script = v8::Script::Compile(v8_str(source));
+  return handle(
+      Handle<JSFunction>::cast(v8::Utils::OpenHandle(*script))->shared());
+}
+
+
+TEST(EventRacerLogCachesInstrumentedCodeSeparately) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  const char* source = "var cached = { x: 1 }; cached.x;";
+
+  // A script is put in the cache the second time it is compiled.
+  CompileScript(source);
+  CompileScript(source);
+  Handle<SharedFunctionInfo> plain = CompileScript(source);
+  CHECK(!plain->code()->is_instrumented());
+  CHECK(plain.is_identical_to(CompileScript(source)));
+
+  CompileRun("ER_enable();");
+  CompileScript(source);
+  CompileScript(source);
+  Handle<SharedFunctionInfo> instrumented = CompileScript(source);
+  CHECK(instrumented->code()->is_instrumented());
+  CHECK(!instrumented.is_identical_to(plain));
+  CHECK(instrumented.is_identical_to(CompileScript(source)));
+
+  // Both variants stay in the cache.
+  CompileRun("ER_disable();");
+  CHECK(plain.is_identical_to(CompileScript(source)));
+}
+
+
+static Handle<SharedFunctionInfo> CompileWithCodeCache(
+    const char* source, ScriptData** cache,
+    v8::ScriptCompiler::CompileOptions options) {
+  Isolate* isolate = CcTest::i_isolate();
+  Handle<String> str = isolate->factory()
+                           ->NewStringFromUtf8(CStrVector(source))
+                           .ToHandleChecked();
+  return Compiler::CompileScript(
+      str, Handle<String>(), 0, 0, false,
+      Handle<Context>(isolate->native_context()), NULL, cache, options,
+      NOT_NATIVES_CODE);
+}
+
+
+static void RunScript(Handle<SharedFunctionInfo> shared) {
+  Isolate* isolate = CcTest::i_isolate();
+  Handle<JSFunction> fun =
+      isolate->factory()->NewFunctionFromSharedFunctionInfo(
+          shared, isolate->native_context());
+  Handle<JSObject> global(isolate->context()->global_object());
+  Execution::Call(isolate, fun, global, 0, NULL).ToHandleChecked();
+}
+
+
+TEST(EventRacerLogDoesNotServeInstrumentedCodeFromCodeCache) {
+  FLAG_serialize_toplevel = true;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  isolate->compilation_cache()->Disable();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = isolate->event_racer_log();
+  const char* source = "var served = { x: 1 }; served.x;";
+
+  // The instrumented code refers to the sites of this isolate, so no code
+  // cache data is produced for it.
+  CompileRun("ER_enable();");
+  ScriptData* cache = NULL;
+  Handle<SharedFunctionInfo> instrumented = CompileWithCodeCache(
+      source, &cache, v8::ScriptCompiler::kProduceCodeCache);
+  CHECK(instrumented->code()->is_instrumented());
+  CHECK(cache == NULL);
+
+  // The data of the plain code is rejected while the new code is
+  // instrumented, the script is compiled instead and records its accesses
+  // under their own names.
+  CompileRun("ER_disable();");
+  Handle<SharedFunctionInfo> plain = CompileWithCodeCache(
+      source, &cache, v8::ScriptCompiler::kProduceCodeCache);
+  CHECK(!plain->code()->is_instrumented());
+  CHECK(cache != NULL);
+  CompileRun("ER_enable();");
+  Handle<SharedFunctionInfo> loaded = CompileWithCodeCache(
+      source, &cache, v8::ScriptCompiler::kConsumeCodeCache);
+  CHECK(cache->rejected());
+  CHECK(loaded->code()->is_instrumented());
+  RunScript(loaded);
+  CHECK(HasEvent(log, EventRacerLog::kWrite, "served"));
+  CHECK(HasEvent(log, EventRacerLog::kRead, "served"));
+  CHECK(HasReadProp(log, "x"));
+  CompileRun("ER_disable();");
+  delete cache;
+}
+
+
+static const EventRacerLog::Event* FindEvent(EventRacerLog* log, int op) {
+  for (int i = 0; i < log->length(); ++i) {
+    if (log->at(i).op == op) return &log->at(i);
+  }
+  return NULL;
+}
+
+
+TEST(EventRacerLogRangeLoops) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun(
+      "var arr = [1, 2, 3, 4, 5, 6];"
+      "function sum(a) {"
+      "  var s = 0, n = a.length;"
+      "  for (var i = 0; i < n; i++) s += a[i];"
+      "  return s;"
+      "}"
+      "function clear(a) {"
+      "  for (var i = a.length - 1; i >= 0; i -= 2) a[i] = 0;"
+      "}"
+      "ER_enable(); sum(arr); clear(arr);");
+
+  // Each loop logs a single range access instead of an access per element.
+  CHECK(!HasReadProp(log, "0"));
+  CHECK(!HasReadProp(log, "5"));
+  const EventRacerLog::Event* e = FindEvent(log, EventRacerLog::kReadRange);
+  CHECK(e != NULL);
+  CHECK_EQ(0, e->name);
+  CHECK_EQ(5, e->fn);
+  CHECK_EQ(1, e->stride);
+  const EventRacerLog::Event* w = FindEvent(log, EventRacerLog::kWriteRange);
+  CHECK(w != NULL);
+  CHECK_EQ(e->obj, w->obj);
+  CHECK_EQ(5, w->name);
+  CHECK_EQ(1, w->fn);
+  CHECK_EQ(-2, w->stride);
+
+  // A loop, which may be left early, logs each access.
+  CompileRun(
+      "function find(a, x) {"
+      "  for (var i = 0; i < a.length; i++) if (a[i] === x) break;"
+      "}"
+      "find(arr, 3);");
+  CHECK(HasReadProp(log, "2"));
+  CHECK(!HasReadProp(log, "3"));
+
+  // A property bound may grow in the body, so such a loop logs each
+  // access, including the ones past the original bound.
+  CompileRun(
+      "function grow(a) {"
+      "  for (var i = 0; i < a.length; i++) if (a[i] < 3) a.push(9);"
+      "}"
+      "grow([1, 2]);");
+  CHECK(HasReadProp(log, "3"));
+
+  // A conditional access is logged only when it happens, the condition
+  // is still part of the range. The array is now [1, 0, 3, 0, 5, 0].
+  CompileRun(
+      "function replace(a, x, y) {"
+      "  var n = a.length;"
+      "  for (var i = 0; i < n; i++) if (a[i] === x) a[i] = y;"
+      "}"
+      "ER_disable(); ER_enable(); replace(arr, 5, 7);");
+  CHECK(FindEvent(log, EventRacerLog::kReadRange) != NULL);
+  CHECK(FindEvent(log, EventRacerLog::kWriteRange) == NULL);
+  CHECK(HasEvent(log, EventRacerLog::kWriteProp, "4"));
+  CHECK(!HasEvent(log, EventRacerLog::kWriteProp, "2"));
+}
+
+
+class OneChunkSourceStream : public v8::ScriptCompiler::ExternalSourceStream {
+ public:
+  explicit OneChunkSourceStream(const char* source) : source_(source) {}
+
+  virtual size_t GetMoreData(const uint8_t** src) {
+    if (source_ == NULL) return 0;
+    size_t length = strlen(source_);
+    uint8_t* copy = new uint8_t[length];
+    memcpy(copy, source_, length);
+    *src = copy;
+    source_ = NULL;
+    return length;
+  }
+
+ private:
+  const char* source_;
+};
+
+
+TEST(EventRacerLogInstrumentsStreamedScripts) {
+  FLAG_instrument_lazily = false;
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::HandleScope scope(isolate);
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  const char* source = "var o = { x: 1 }; var y = o.x; y";
+  v8::ScriptCompiler::StreamedSource streamed(
+      new OneChunkSourceStream(source),
+      v8::ScriptCompiler::StreamedSource::ONE_BYTE);
+  v8::ScriptCompiler::ScriptStreamingTask* task =
+      v8::ScriptCompiler::StartStreamingScript(isolate, &streamed);
+  // The stream does not block, so the task may run on the main thread.
+  task->Run();
+  delete task;
+
+  // The parsing task has instrumented the script and collected its sites,
+  // before the compilation on the main thread starts.
+  CompilationInfo* info = streamed.impl()->info.get();
+  CHECK(streamed.impl()->instrument);
+  CHECK(info->is_analyzed());
+  CHECK(info->is_instrumented());
+  CHECK(info->event_racer_sites() != NULL);
+  CHECK(info->event_racer_sites()->length() > 0);
+
+  v8::Handle<v8::Script> script = v8::ScriptCompiler::Compile(
+      isolate, &streamed, v8_str(source), v8::ScriptOrigin(v8_str("s.js")));
+  CHECK(!script.IsEmpty());
+  Handle<JSFunction> fun = v8::Utils::OpenHandle(*script);
+  CHECK(fun->shared()->code()->is_instrumented());
+
+  CompileRun("ER_enable();");
+  CHECK_EQ(1, script->Run()->Int32Value());
+  CHECK(HasReadProp(log, "x"));
+  // The sites of the background instrumentation are registered, too.
+  CHECK(HasEvent(log, EventRacerLog::kRead, "y"));
+  CompileRun("ER_disable();");
+}
+
+
+// Returns the id of the site of the global variable access |kind| of
+// |name|, or zero if there is none.
+static int FindSite(EventRacerLog* log, int kind, const char* name) {
+  for (int site = 1; site <= log->site_count(); ++site) {
+    const EventRacerLog::SiteInfo* info = log->site_info(site);
+    if (info != NULL && info->kind == kind && strcmp(name, info->name) == 0)
+      return site;
+  }
+  return 0;
+}
+
+
+TEST(EventRacerLogRecordsGlobalSites) {
+  FLAG_instrument_lazily = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  const char* source =
+      "var gx = 1;\n"
+      "function gf() { gx = gx + 1; delete gy; }\n"
+      "gf();";
+  CompileRun("ER_enable();");
+  CompileRun(source);
+
+  // The instrumented code passes the site ids and the events still carry
+  // the names.
+  CHECK(HasEvent(log, EventRacerLog::kRead, "gx"));
+  CHECK(HasEvent(log, EventRacerLog::kWrite, "gx"));
+  CHECK(HasEvent(log, EventRacerLog::kWriteFunc, "gf"));
+  CHECK(HasEvent(log, EventRacerLog::kDelete, "gy"));
+
+  int read = FindSite(log, EventRacerLog::kRead, "gx");
+  CHECK_NE(0, read);
+  CHECK_NE(0, FindSite(log, EventRacerLog::kWrite, "gx"));
+  CHECK_NE(0, FindSite(log, EventRacerLog::kDelete, "gy"));
+  const EventRacerLog::SiteInfo* info = log->site_info(read);
+  CHECK_EQ(static_cast<int>(strstr(source, "gx + 1") - source),
+           info->position);
+  CHECK_NE(0, info->fn);
+  CHECK(log->site_info(log->site_count() + 1) == NULL);
+
+  // The site names are interned again after a new collection starts.
+  CompileRun("ER_disable(); ER_enable(); gf();");
+  CHECK(HasEvent(log, EventRacerLog::kRead, "gx"));
+  CompileRun("ER_disable();");
+}
+
+
+TEST(EventRacerLogKeepsSitesOnRecompilation) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  EventRacerLog* log = CcTest::i_isolate()->event_racer_log();
+
+  CompileRun("var gx = 1; function gf() { return gx; }");
+  CompileRun("ER_enable(); gf();");
+  int read = FindSite(log, EventRacerLog::kRead, "gx");
+  CHECK_NE(0, read);
+  const EventRacerLog::SiteInfo* info = log->site_info(read);
+  CHECK_NE(-1, info->script_id);
+
+  // The log recompiles |gf| without the instrumentation when disabled and
+  // with it again when enabled, the site keeps its id.
+  Handle<JSFunction> gf = GetFunction("gf");
+  CompileRun("ER_disable();");
+  CompileRun("gf();");
+  CHECK(!gf->shared()->code()->is_instrumented());
+  CompileRun("ER_enable();");
+  CompileRun("gf();");
+  CHECK(gf->shared()->code()->is_instrumented());
+  for (int site = 1; site <= log->site_count(); ++site) {
+    info = log->site_info(site);
+    if (info != NULL && strcmp("gx", info->name) == 0)
+      CHECK_EQ(read, site);
+  }
+  CompileRun("ER_disable();");
+}
@@ -30,6 +30,7 @@
 
 #include "src/v8.h"
 
+#include "include/libplatform/libplatform.h"
 #include "src/compilation-cache.h"
 #include "src/execution.h"
 #include "src/factory.h"
@@ -5089,6 +5090,196 @@ TEST(Regress442710) {
 }
 
 
+TEST(ParallelStoreBufferScan) {
+  i::FLAG_parallel_store_buffer_scan = true;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+  Factory* factory = isolate->factory();
+  HandleScope sc(isolate);
+
+  // Large arrays, each on its own page, which point to new space objects.
+  const int kArrays = 4;
+  const int kLength = 128 * KB;
+  Handle<FixedArray> arrays[kArrays];
+  for (int i = 0; i < kArrays; i++) {
+    arrays[i] = factory->NewFixedArray(kLength, TENURED);
+    CHECK(heap->lo_space()->Contains(*arrays[i]));
+    Handle<HeapNumber> number = factory->NewHeapNumber(i, MUTABLE);
+    CHECK(heap->InNewSpace(*number));
+    arrays[i]->set(kLength - 1 - i, *number);
+    MemoryChunk::FromAddress(arrays[i]->address())->set_scan_on_scavenge(true);
+  }
+
+  heap->CollectGarbage(NEW_SPACE);
+  for (int i = 0; i < kArrays; i++) {
+    Object* value = arrays[i]->get(kLength - 1 - i);
+    CHECK(value->IsHeapNumber());
+    CHECK(!heap->InFromSpace(value));
+    CHECK_EQ(static_cast<double>(i), HeapNumber::cast(value)->value());
+  }
+}
+
+
+TEST(ParallelPointerUpdate) {
+  if (i::FLAG_never_compact) return;
+  i::FLAG_always_compact = true;
+  i::FLAG_parallel_pointer_update = true;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+  Factory* factory = isolate->factory();
+  HandleScope sc(isolate);
+
+  // Objects on several mostly empty old space pages, which become the
+  // evacuation candidates, referenced from an array on another page.
+  const int kPages = 4;
+  const int kObjects = 64;
+  Handle<FixedArray> holder =
+      factory->NewFixedArray(kPages * kObjects, TENURED);
+  for (int i = 0; i < kPages; i++) {
+    factory->NewFixedArray(900 * KB / kPointerSize, TENURED);
+    for (int j = 0; j < kObjects; j++) {
+      Handle<FixedArray> object = factory->NewFixedArray(1, TENURED);
+      object->set(0, Smi::FromInt(i * kObjects + j));
+      holder->set(i * kObjects + j, *object);
+    }
+  }
+
+  heap->CollectAllGarbage(Heap::kNoGCFlags);
+  for (int i = 0; i < kPages * kObjects; i++) {
+    Object* object = holder->get(i);
+    CHECK(object->IsFixedArray());
+    CHECK(!MarkCompactCollector::IsOnEvacuationCandidate(object));
+    CHECK_EQ(Smi::FromInt(i), FixedArray::cast(object)->get(0));
+  }
+}
+
+
+static int NewSpaceThroughput(GCTracer* tracer, double time_ms) {
+  return static_cast<int>(
+      tracer->NewSpaceAllocationThroughputInBytesPerMillisecond(time_ms));
+}
+
+
+static int OldGenerationThroughput(GCTracer* tracer, double time_ms) {
+  return static_cast<int>(
+      tracer->OldGenerationAllocationThroughputInBytesPerMillisecond(time_ms));
+}
+
+
+TEST(AllocationThroughput) {
+  CcTest::InitializeVM();
+  // A fresh tracer has seen no garbage collection, so only the recorded
+  // events count.
+  GCTracer tracer(CcTest::heap());
+  CHECK_EQ(0, NewSpaceThroughput(&tracer, 0));
+
+  tracer.AddAllocationTime(100, 1000, 100);
+  tracer.AddAllocationTime(100, 2000, 300);
+  tracer.AddAllocationTime(100, 6000, 600);
+
+  // All the events.
+  CHECK_EQ(30, NewSpaceThroughput(&tracer, 0));
+  CHECK_EQ(3, OldGenerationThroughput(&tracer, 0));
+  // The most recent events, which cover the time frame.
+  CHECK_EQ(60, NewSpaceThroughput(&tracer, 100));
+  CHECK_EQ(6, OldGenerationThroughput(&tracer, 100));
+  CHECK_EQ(40, NewSpaceThroughput(&tracer, 150));
+  CHECK_EQ(4, OldGenerationThroughput(&tracer, 150));
+  // A time frame longer than the events takes all of them.
+  CHECK_EQ(30, NewSpaceThroughput(&tracer, 1000));
+  CHECK_EQ(3, OldGenerationThroughput(&tracer, 1000));
+}
+
+
+TEST(IncrementalMarkingTask) {
+  i::FLAG_incremental_marking_task = true;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Heap* heap = CcTest::heap();
+  CompileRun("var a = []; for (var i = 0; i < 1000; i++) a.push({x: i});");
+
+  IncrementalMarking* marking = heap->incremental_marking();
+  marking->Abort();
+  // While sweeping, no task is posted.
+  MarkCompactCollector* collector = heap->mark_compact_collector();
+  if (collector->sweeping_in_progress()) {
+    collector->EnsureSweepingCompleted();
+  }
+  int ms_count = heap->ms_count();
+  marking->Start();
+  CHECK(marking->IsMarking());
+
+  // The tasks mark without any allocation and finalize the marking.
+  while (v8::platform::PumpMessageLoop(i::V8::GetCurrentPlatform(),
+                                       CcTest::isolate())) {
+  }
+  CHECK(marking->IsStopped());
+  CHECK_EQ(ms_count + 1, static_cast<int>(heap->ms_count()));
+}
+
+
+UNINITIALIZED_TEST(IncrementalMarkingTaskAfterDispose) {
+  i::FLAG_incremental_marking_task = true;
+  v8::Isolate* isolate = v8::Isolate::New();
+  i::Isolate* i_isolate = reinterpret_cast<i::Isolate*>(isolate);
+  {
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Context::New(isolate)->Enter();
+    Heap* heap = i_isolate->heap();
+    IncrementalMarking* marking = heap->incremental_marking();
+    marking->Abort();
+    MarkCompactCollector* collector = heap->mark_compact_collector();
+    if (collector->sweeping_in_progress()) {
+      collector->EnsureSweepingCompleted();
+    }
+    marking->Start();
+    CHECK(marking->IsMarking());
+  }
+  isolate->Dispose();
+
+  // The task, posted for the disposed isolate, does nothing.
+  while (v8::platform::PumpMessageLoop(i::V8::GetCurrentPlatform(),
+                                       isolate)) {
+  }
+}
+
+
+TEST(ParallelMarkbitClearing) {
+  i::FLAG_parallel_markbit_clearing = true;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+  Factory* factory = isolate->factory();
+  HandleScope sc(isolate);
+
+  MarkCompactCollector* collector = heap->mark_compact_collector();
+  if (collector->sweeping_in_progress()) {
+    collector->EnsureSweepingCompleted();
+  }
+
+  // Objects on pages of different spaces.
+  const int kObjects = 3;
+  Handle<HeapObject> objects[kObjects];
+  objects[0] = factory->NewFixedArray(16);
+  objects[1] = factory->NewFixedArray(16, TENURED);
+  objects[2] = factory->NewByteArray(16, TENURED);
+  for (int i = 0; i < kObjects; i++) {
+    Marking::MarkBlack(Marking::MarkBitFrom(*objects[i]));
+    MemoryChunk::IncrementLiveBytesFromGC(objects[i]->address(),
+                                          objects[i]->Size());
+  }
+
+  collector->ClearMarkbits();
+  for (int i = 0; i < kObjects; i++) {
+    CHECK(Marking::IsWhite(Marking::MarkBitFrom(*objects[i])));
+    CHECK_EQ(0, MemoryChunk::FromAddress(objects[i]->address())->LiveBytes());
+  }
+}
+
+
 #ifdef DEBUG
 TEST(PathTracer) {
   CcTest::InitializeVM();
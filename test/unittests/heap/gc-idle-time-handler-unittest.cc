@@ -34,6 +34,11 @@ class GCIdleTimeHandlerTest : public ::testing::Test {
     result.new_space_capacity = kNewSpaceCapacity;
     result.new_space_allocation_throughput_in_bytes_per_ms =
         kNewSpaceAllocationThroughput;
+    result.can_start_incremental_marking_early = false;
+    result.old_generation_space_available = kOldGenerationSpaceAvailable;
+    result.old_generation_allocation_throughput_in_bytes_per_ms =
+        kOldGenerationAllocationThroughput;
+    result.mutator_time_in_ms = 0;
     return result;
   }
 
@@ -43,6 +48,8 @@ class GCIdleTimeHandlerTest : public ::testing::Test {
   static const size_t kScavengeSpeed = 100 * KB;
   static const size_t kNewSpaceCapacity = 1 * MB;
   static const size_t kNewSpaceAllocationThroughput = 10 * KB;
+  static const size_t kOldGenerationSpaceAvailable = 100 * MB;
+  static const size_t kOldGenerationAllocationThroughput = 10 * KB;
 
  private:
   GCIdleTimeHandler handler_;
@@ -167,6 +174,88 @@ TEST_F(GCIdleTimeHandlerTest, DoScavengeHighScavengeSpeed) {
 }
 
 
+TEST_F(GCIdleTimeHandlerTest, DoPreemptiveScavenge) {
+  GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
+  heap_state.used_new_space_size = kNewSpaceCapacity / 2;
+  heap_state.mutator_time_in_ms = 100;
+  int idle_time_in_ms = 16;
+  EXPECT_TRUE(GCIdleTimeHandler::ShouldDoPreemptiveScavenge(
+      idle_time_in_ms, heap_state.new_space_capacity,
+      heap_state.used_new_space_size, heap_state.scavenge_speed_in_bytes_per_ms,
+      heap_state.new_space_allocation_throughput_in_bytes_per_ms,
+      heap_state.mutator_time_in_ms));
+}
+
+
+TEST_F(GCIdleTimeHandlerTest, DontDoPreemptiveScavengeShortMutatorTime) {
+  GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
+  heap_state.used_new_space_size = kNewSpaceCapacity / 2;
+  heap_state.mutator_time_in_ms = 10;
+  int idle_time_in_ms = 16;
+  EXPECT_FALSE(GCIdleTimeHandler::ShouldDoPreemptiveScavenge(
+      idle_time_in_ms, heap_state.new_space_capacity,
+      heap_state.used_new_space_size, heap_state.scavenge_speed_in_bytes_per_ms,
+      heap_state.new_space_allocation_throughput_in_bytes_per_ms,
+      heap_state.mutator_time_in_ms));
+}
+
+
+TEST_F(GCIdleTimeHandlerTest, DontDoPreemptiveScavengeUnknownThroughput) {
+  GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
+  heap_state.used_new_space_size = kNewSpaceCapacity / 2;
+  heap_state.new_space_allocation_throughput_in_bytes_per_ms = 0;
+  heap_state.mutator_time_in_ms = 100;
+  int idle_time_in_ms = 16;
+  EXPECT_FALSE(GCIdleTimeHandler::ShouldDoPreemptiveScavenge(
+      idle_time_in_ms, heap_state.new_space_capacity,
+      heap_state.used_new_space_size, heap_state.scavenge_speed_in_bytes_per_ms,
+      heap_state.new_space_allocation_throughput_in_bytes_per_ms,
+      heap_state.mutator_time_in_ms));
+}
+
+
+TEST_F(GCIdleTimeHandlerTest, DontDoPreemptiveScavengeSmallNewSpace) {
+  GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
+  heap_state.used_new_space_size = 1 * KB;
+  heap_state.mutator_time_in_ms = 1000;
+  int idle_time_in_ms = 16;
+  EXPECT_FALSE(GCIdleTimeHandler::ShouldDoPreemptiveScavenge(
+      idle_time_in_ms, heap_state.new_space_capacity,
+      heap_state.used_new_space_size, heap_state.scavenge_speed_in_bytes_per_ms,
+      heap_state.new_space_allocation_throughput_in_bytes_per_ms,
+      heap_state.mutator_time_in_ms));
+}
+
+
+TEST_F(GCIdleTimeHandlerTest, DoPreemptiveScavengeLongMutatorTime) {
+  GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
+  heap_state.used_new_space_size = kNewSpaceCapacity / 2;
+  heap_state.mutator_time_in_ms = std::numeric_limits<size_t>::max();
+  int idle_time_in_ms = 16;
+  EXPECT_TRUE(GCIdleTimeHandler::ShouldDoPreemptiveScavenge(
+      idle_time_in_ms, heap_state.new_space_capacity,
+      heap_state.used_new_space_size, heap_state.scavenge_speed_in_bytes_per_ms,
+      heap_state.new_space_allocation_throughput_in_bytes_per_ms,
+      heap_state.mutator_time_in_ms));
+}
+
+
+TEST_F(GCIdleTimeHandlerTest, ShouldStartIncrementalMarkingEarly) {
+  EXPECT_TRUE(GCIdleTimeHandler::ShouldStartIncrementalMarkingEarly(
+      kSizeOfObjects, kMarkingSpeed, 1 * MB,
+      kOldGenerationAllocationThroughput));
+}
+
+
+TEST_F(GCIdleTimeHandlerTest, DontStartIncrementalMarkingEarly) {
+  EXPECT_FALSE(GCIdleTimeHandler::ShouldStartIncrementalMarkingEarly(
+      kSizeOfObjects, kMarkingSpeed, kOldGenerationSpaceAvailable,
+      kOldGenerationAllocationThroughput));
+  EXPECT_FALSE(GCIdleTimeHandler::ShouldStartIncrementalMarkingEarly(
+      kSizeOfObjects, kMarkingSpeed, 1 * MB, 0));
+}
+
+
 TEST_F(GCIdleTimeHandlerTest, ShouldDoMarkCompact) {
   size_t idle_time_in_ms = 16;
   EXPECT_TRUE(GCIdleTimeHandler::ShouldDoMarkCompact(idle_time_in_ms, 0, 0));
@@ -291,6 +380,20 @@ TEST_F(GCIdleTimeHandlerTest, IncrementalMarking2) {
 }
 
 
+TEST_F(GCIdleTimeHandlerTest, IncrementalMarkingEarly) {
+  GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
+  heap_state.incremental_marking_stopped = true;
+  heap_state.can_start_incremental_marking = false;
+  heap_state.can_start_incremental_marking_early = true;
+  double idle_time_ms = 10;
+  GCIdleTimeAction action = handler()->Compute(idle_time_ms, heap_state);
+  EXPECT_EQ(DO_NOTHING, action.type);
+  heap_state.old_generation_space_available = 1 * MB;
+  action = handler()->Compute(idle_time_ms, heap_state);
+  EXPECT_EQ(DO_INCREMENTAL_MARKING, action.type);
+}
+
+
 TEST_F(GCIdleTimeHandlerTest, NotEnoughTime) {
   GCIdleTimeHandler::HeapState heap_state = DefaultHeapState();
   heap_state.incremental_marking_stopped = true;
@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+# Copyright 2015 the V8 project authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""
+Measures the cost of the ER instrumentation.
+
+Runs the benchmarks in the benchmarks/ directory with d8 in three modes:
+
+  uninstrumented  --no-instrument
+  disabled        instrumented code (--no-instrument-lazily), collection
+                  disabled
+  enabled         collection enabled for the whole run, events streamed to
+                  a binary trace (--er-trace)
+
+and reports, for each mode, the benchmark scores and the slowdown relative
+to the uninstrumented run, the parse and compile time, the time spent in
+the ER rewriter, the size of the compiled code and, for the enabled mode,
+the trace size and the trace bytes written per second.
+
+Call e.g. with
+  tools/er-overhead.py --shell out/x64.release/d8 --runs 3
+
+The same modes are described for tools/run_perf.py in
+benchmarks/er-overhead.json, for tracking on the perf dashboard.
+"""
+
+import optparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+MODES = [
+  ("uninstrumented", ["--no-instrument"], []),
+  ("disabled", ["--no-instrument-lazily"], []),
+  ("enabled", [], ["enabled"]),
+]
+
+BENCHMARKS_DIR = os.path.join(
+    os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "benchmarks")
+
+RESULT_RE = re.compile(r"^(\w+): ([0-9.]+)$")
+SCORE_RE = re.compile(r"^Score \(version \d+\): ([0-9.]+)$")
+ELAPSED_RE = re.compile(r"^Elapsed \(ms\): ([0-9.]+)$")
+COUNTER_RE = re.compile(r"^\|\s*(\S+)\s*\|\s*(-?\d+)\s*\|$")
+
+COMPILE_TIMERS = ["t:V8.Parse", "t:V8.ParseLazy", "t:V8.Compile",
+                  "t:V8.CompileEval"]
+
+
+def RunOnce(shell, flags, test_flags, trace):
+  cmd = [shell, "--dump-counters"] + flags
+  if trace:
+    cmd.append("--er-trace=%s" % trace)
+  cmd.append("run-er.js")
+  if test_flags:
+    cmd += ["--"] + test_flags
+  output = subprocess.check_output(cmd, cwd=BENCHMARKS_DIR)
+  if not isinstance(output, str):
+    output = output.decode("utf-8", "replace")
+
+  result = {"scores": {}, "counters": {}}
+  for line in output.splitlines():
+    line = line.strip()
+    m = SCORE_RE.match(line)
+    if m:
+      result["score"] = float(m.group(1))
+      continue
+    m = ELAPSED_RE.match(line)
+    if m:
+      result["elapsed"] = float(m.group(1))
+      continue
+    m = RESULT_RE.match(line)
+    if m:
+      result["scores"][m.group(1)] = float(m.group(2))
+      continue
+    m = COUNTER_RE.match(line)
+    if m:
+      result["counters"][m.group(1)] = int(m.group(2))
+  if "score" not in result:
+    raise Exception("No score in the output of %s:\n%s" %
+                    (" ".join(cmd), output))
+  if trace:
+    result["trace_bytes"] = os.path.getsize(trace)
+  return result
+
+
+def Mean(values):
+  return sum(values) / float(len(values)) if values else 0.0
+
+
+def Summarize(runs):
+  summary = {
+    "score": Mean([r["score"] for r in runs]),
+    "elapsed": Mean([r.get("elapsed", 0) for r in runs]),
+    "compile_ms": Mean([sum(r["counters"].get(t, 0) for t in COMPILE_TIMERS)
+                        for r in runs]),
+    "instrument_ms": Mean([r["counters"].get("t:V8.CompileInstrument", 0)
+                           for r in runs]),
+    "code_size": Mean([
+        r["counters"].get("c:V8.TotalCompiledCodeSize", 0) for r in runs]),
+    "scores": {},
+  }
+  for name in runs[0]["scores"]:
+    summary["scores"][name] = Mean([r["scores"].get(name, 0) for r in runs])
+  if "trace_bytes" in runs[0]:
+    summary["trace_bytes"] = Mean([r["trace_bytes"] for r in runs])
+  return summary
+
+
+def Slowdown(base, score):
+  return base / score if score else float("inf")
+
+
+def PrintReport(summaries):
+  base = summaries["uninstrumented"]
+  names = sorted(base["scores"].keys())
+
+  print("%-16s" % "Benchmark" +
+        "".join("%16s" % mode for mode, _, _ in MODES))
+  for name in names + ["Score"]:
+    row = "%-16s" % name
+    for mode, _, _ in MODES:
+      s = summaries[mode]
+      score = s["score"] if name == "Score" else s["scores"].get(name, 0)
+      base_score = base["score"] if name == "Score" else base["scores"][name]
+      row += "%9.0f %5.2fx" % (score, Slowdown(base_score, score))
+    print(row)
+  print("")
+
+  for mode, _, _ in MODES:
+    s = summaries[mode]
+    print("%s:" % mode)
+    print("  parse+compile time   %10.1f ms" % s["compile_ms"])
+    print("  ER rewriter time     %10.1f ms" % s["instrument_ms"])
+    print("  compiled code size   %10.0f bytes (%.2fx)" %
+          (s["code_size"], Slowdown(s["code_size"], base["code_size"])))
+    if "trace_bytes" in s:
+      seconds = s["elapsed"] / 1000.0
+      print("  trace size           %10.0f bytes" % s["trace_bytes"])
+      print("  trace rate           %10.0f bytes/s" %
+            (s["trace_bytes"] / seconds if seconds else 0))
+
+
+def Main():
+  parser = optparse.OptionParser()
+  parser.add_option("--shell", default=os.path.join("out", "x64.release", "d8"),
+                    help="The d8 binary to run [default: %default]")
+  parser.add_option("--runs", type="int", default=1,
+                    help="The number of runs per mode [default: %default]")
+  parser.add_option("--flags", default="",
+                    help="Additional d8 flags, separated by spaces")
+  (options, args) = parser.parse_args()
+  shell = os.path.abspath(options.shell)
+  extra_flags = options.flags.split()
+
+  summaries = {}
+  for mode, flags, test_flags in MODES:
+    runs = []
+    for i in range(options.runs):
+      trace = None
+      if mode == "enabled":
+        fd, trace = tempfile.mkstemp(suffix=".ertrace")
+        os.close(fd)
+      try:
+        # Traces are written per isolate by default, so name the file
+        # exactly.
+        trace_flags = ["--no-logfile-per-isolate"] if trace else []
+        runs.append(RunOnce(shell, extra_flags + flags + trace_flags,
+                            test_flags, trace))
+      finally:
+        if trace:
+          os.remove(trace)
+      sys.stderr.write("%s run %d: score %.0f\n" %
+                       (mode, i + 1, runs[-1]["score"]))
+    summaries[mode] = Summarize(runs)
+
+  PrintReport(summaries)
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(Main())
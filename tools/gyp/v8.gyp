@@ -568,8 +568,24 @@
         '../../src/elements-kind.h',
         '../../src/elements.cc',
         '../../src/elements.h',
+        '../../src/event-racer-analyzer.cc',
+        '../../src/event-racer-analyzer.h',
+        '../../src/event-racer-detector.cc',
+        '../../src/event-racer-detector.h',
+        '../../src/event-racer-escape-analysis.cc',
+        '../../src/event-racer-escape-analysis.h',
+        '../../src/event-racer-log.cc',
+        '../../src/event-racer-log.h',
+        '../../src/event-racer-object-ids.cc',
+        '../../src/event-racer-object-ids.h',
+        '../../src/event-racer-range-loop.cc',
+        '../../src/event-racer-range-loop.h',
         '../../src/event-racer-rewriter.cc',
         '../../src/event-racer-rewriter.h',
+        '../../src/event-racer-sampler.cc',
+        '../../src/event-racer-sampler.h',
+        '../../src/event-racer-trace.cc',
+        '../../src/event-racer-trace.h',
         '../../src/execution.cc',
         '../../src/execution.h',
         '../../src/extensions/externalize-string-extension.cc',
@@ -630,6 +646,8 @@
         '../../src/heap/objects-visiting-inl.h',
         '../../src/heap/objects-visiting.cc',
         '../../src/heap/objects-visiting.h',
+        '../../src/heap/parallel-page-job.cc',
+        '../../src/heap/parallel-page-job.h',
         '../../src/heap/spaces-inl.h',
         '../../src/heap/spaces.cc',
         '../../src/heap/spaces.h',
@@ -793,6 +811,7 @@
         '../../src/runtime/runtime-compiler.cc',
         '../../src/runtime/runtime-date.cc',
         '../../src/runtime/runtime-debug.cc',
+        '../../src/runtime/runtime-eventracer.cc',
         '../../src/runtime/runtime-function.cc',
         '../../src/runtime/runtime-generator.cc',
         '../../src/runtime/runtime-i18n.cc',